@@ -9,6 +9,9 @@
 #include <strsafe.h>
 #include "core\data\DynamicSettings.h"
 #include "..\stats\DrawCounter.h"
+#include "..\utils\font.h"
+#include "..\utils\JobSystem.h"
+#include "..\resources\MeshLoader.h"
 #include <thread>
 #include "..\audio\AudioManager.h"
 #include "..\plugins\PerfHUDPlugin.h"
@@ -97,10 +100,13 @@ namespace ds {
 		perf::shutdown();		
 		events::shutdown();
 		input::shutdown();
+		loader::shutdown();
 		res::shutdown();
 		timer::shutdown_timing();
 		delete _shortcuts;
 		delete gDrawCounter;
+		font::shutdownTextCache();
+		jobs::shutdown();
 		delete _stateMachine;
 		plugins::shutdown();
 		graphics::shutdown();
@@ -174,6 +180,8 @@ namespace ds {
 		_editor->addPlugin("F5", VK_F5, new PerfHUDPlugin());
 		events::init();
 		math::init_random(GetTickCount());
+		jobs::initialize();
+		loader::initialize();
 		audio::initialize(m_hWnd);		
 		// now set up the graphic subsystem
 		if (graphics::initialize(hInstance, m_hWnd, _settings)) {
@@ -320,6 +328,7 @@ namespace ds {
 	// http://gafferongames.com/game-physics/fix-your-timestep/
 	void BaseApp::tick(double elapsed) {
 		ZoneTracker all("tick");
+		loader::update();
 		{
 			ZoneTracker z("INPUT");
 			if (_running) {
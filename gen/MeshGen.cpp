@@ -3,9 +3,10 @@
 #include "core\log\Log.h"
 #include "core\io\json.h"
 #include "core\io\FileRepository.h"
-#include "core\io\BinaryFile.h"
 #include "core\string\StaticHash.h"
+#include "core\base\Assert.h"
 #include <stdarg.h>
+#include <vector>
 
 #define EPSILON 0.000001
 
@@ -238,44 +239,255 @@ namespace ds {
 
 	namespace gen {
 
-		MeshGen::MeshGen() : _selectionColor(Color(192, 192, 192, 255)), _selectedColor(Color::WHITE), _currentGroup(-1) , _groupCounter(0) {}
+		// ----------------------------------------------
+		// MeshGenIndex - vertices are hashed by cells of
+		// INDEX_CELL_SIZE. A query looks at every cell
+		// within EPSILON of the position so it finds the
+		// same vertices as equals. Edges are stored by
+		// the cells of their start and end vertex. Every
+		// edge owns its start vertex (vertex i starts
+		// edge i) since add_face creates both together.
+		// ----------------------------------------------
+		const double INDEX_CELL_SIZE = 0.001;
+
+		const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+		// ----------------------------------------------
+		// IndexTable - open addressing table of cell keys.
+		// Every slot holds the head of a chain that is
+		// linked through next by vertex or edge index.
+		// ----------------------------------------------
+		struct IndexTable {
+
+			std::vector<uint64_t> keys;
+			std::vector<uint32_t> heads;
+			std::vector<uint32_t> next;
+			uint32_t used;
+
+			IndexTable() : used(0) {}
+
+			static uint32_t slot_hash(uint64_t key) {
+				key ^= key >> 33;
+				key *= 0xFF51AFD7ED558CCDULL;
+				key ^= key >> 33;
+				return static_cast<uint32_t>(key);
+			}
+
+			// returns the slot of the key or NO_INDEX
+			uint32_t find(uint64_t key) const {
+				if (keys.empty()) {
+					return NO_INDEX;
+				}
+				uint32_t mask = keys.size() - 1;
+				uint32_t slot = slot_hash(key) & mask;
+				while (heads[slot] != NO_INDEX || keys[slot] != 0) {
+					if (keys[slot] == key && heads[slot] != NO_INDEX) {
+						return slot;
+					}
+					slot = (slot + 1) & mask;
+				}
+				return NO_INDEX;
+			}
 
-		MeshGen::~MeshGen() {}
+			uint32_t first(uint64_t key) const {
+				uint32_t slot = find(key);
+				return slot != NO_INDEX ? heads[slot] : NO_INDEX;
+			}
+
+			void add(uint64_t key, uint32_t idx) {
+				if ((used + 1) * 2 > keys.size()) {
+					grow();
+				}
+				if (idx >= next.size()) {
+					next.resize(idx + 1, NO_INDEX);
+				}
+				uint32_t slot = find(key);
+				if (slot == NO_INDEX) {
+					// the first empty chain is reused by the key
+					uint32_t mask = keys.size() - 1;
+					slot = slot_hash(key) & mask;
+					while (heads[slot] != NO_INDEX) {
+						slot = (slot + 1) & mask;
+					}
+					if (keys[slot] == 0) {
+						++used;
+					}
+					keys[slot] = key;
+				}
+				next[idx] = heads[slot];
+				heads[slot] = idx;
+			}
 
-		int MeshGen::find_vertices(const v3& pos, uint16_t* ret, int max) {
+			void remove(uint64_t key, uint32_t idx) {
+				uint32_t slot = find(key);
+				if (slot == NO_INDEX) {
+					return;
+				}
+				uint32_t* current = &heads[slot];
+				while (*current != NO_INDEX) {
+					if (*current == idx) {
+						*current = next[idx];
+						next[idx] = NO_INDEX;
+						return;
+					}
+					current = &next[*current];
+				}
+			}
+
+			// ----------------------------------------------
+			// doubles the table and drops empty chains. A
+			// key of 0 marks a slot that was never used.
+			// ----------------------------------------------
+			void grow() {
+				std::vector<uint64_t> oldKeys;
+				std::vector<uint32_t> oldHeads;
+				oldKeys.swap(keys);
+				oldHeads.swap(heads);
+				uint32_t size = oldKeys.size() < 64 ? 64 : oldKeys.size() * 2;
+				keys.assign(size, 0);
+				heads.assign(size, NO_INDEX);
+				used = 0;
+				uint32_t mask = size - 1;
+				for (size_t i = 0; i < oldKeys.size(); ++i) {
+					if (oldHeads[i] != NO_INDEX) {
+						uint32_t slot = slot_hash(oldKeys[i]) & mask;
+						while (keys[slot] != 0) {
+							slot = (slot + 1) & mask;
+						}
+						keys[slot] = oldKeys[i];
+						heads[slot] = oldHeads[i];
+						++used;
+					}
+				}
+			}
+
+			void clear() {
+				keys.clear();
+				heads.clear();
+				next.clear();
+				used = 0;
+			}
+		};
+
+		struct MeshGenIndex {
+			IndexTable vertices;
+			IndexTable edges;
+		};
+
+		// never 0 since 0 marks an unused slot
+		static uint64_t cell_key(int64_t x, int64_t y, int64_t z) {
+			return (((uint64_t)x * 73856093) ^ ((uint64_t)y * 19349663) ^ ((uint64_t)z * 83492791)) | 1;
+		}
+
+		static uint64_t cell_key(const v3& p) {
+			return cell_key((int64_t)floor(p.x / INDEX_CELL_SIZE), (int64_t)floor(p.y / INDEX_CELL_SIZE), (int64_t)floor(p.z / INDEX_CELL_SIZE));
+		}
+
+		static uint64_t edge_key(uint64_t start, uint64_t end) {
+			return (start ^ (end + 0x9E3779B97F4A7C15ULL + (start << 6) + (start >> 2))) | 1;
+		}
+
+		// ----------------------------------------------
+		// keys of all cells within EPSILON of p - at most
+		// two cells per axis
+		// ----------------------------------------------
+		static int cell_keys(const v3& p, uint64_t* ret) {
+			int64_t lo[3];
+			int64_t hi[3];
+			for (int i = 0; i < 3; ++i) {
+				lo[i] = (int64_t)floor((p.data[i] - EPSILON) / INDEX_CELL_SIZE);
+				hi[i] = (int64_t)floor((p.data[i] + EPSILON) / INDEX_CELL_SIZE);
+			}
 			int cnt = 0;
-			for (uint32_t i = 0; i < _vertices.size(); ++i) {
-				v3 p = _vertices[i];
-				if (equals(p, pos) && cnt < max) {
-					ret[cnt++] = i;
+			for (int64_t z = lo[2]; z <= hi[2]; ++z) {
+				for (int64_t y = lo[1]; y <= hi[1]; ++y) {
+					for (int64_t x = lo[0]; x <= hi[0]; ++x) {
+						uint64_t key = cell_key(x, y, z);
+						bool found = false;
+						for (int j = 0; j < cnt; ++j) {
+							if (ret[j] == key) {
+								found = true;
+							}
+						}
+						if (!found) {
+							ret[cnt++] = key;
+						}
+					}
 				}
 			}
 			return cnt;
 		}
 
-		int MeshGen::find_edges(const v3& pos, uint16_t* ret, int max) {
+		// ----------------------------------------------
+		// keeps the max lowest indices in ret sorted so
+		// the lookups return the same vertices as the
+		// old linear scans
+		// ----------------------------------------------
+		static int insert_sorted(GenIndex idx, GenIndex* ret, int cnt, int max) {
+			if (cnt == max) {
+				if (max == 0 || ret[cnt - 1] < idx) {
+					return cnt;
+				}
+				--cnt;
+			}
+			int j = cnt - 1;
+			while (j >= 0 && ret[j] > idx) {
+				ret[j + 1] = ret[j];
+				--j;
+			}
+			ret[j + 1] = idx;
+			return cnt + 1;
+		}
+
+		MeshGen::MeshGen() : _selectionColor(Color(192, 192, 192, 255)), _selectedColor(Color::WHITE), _currentGroup(-1) , _groupCounter(0) {
+			_index = new MeshGenIndex;
+		}
+
+		MeshGen::~MeshGen() {
+			delete _index;
+		}
+
+		int MeshGen::find_vertices(const v3& pos, GenIndex* ret, int max) {
+			uint64_t keys[8];
+			int num = cell_keys(pos, keys);
 			int cnt = 0;
-			for (uint32_t i = 0; i < _edges.size(); ++i) {
-				const Edge& e = _edges[i];
-				v3 p = _vertices[e.vert_index];
-				if (equals(p, pos) && cnt < max) {
-					ret[cnt++] = i;
+			for (int i = 0; i < num; ++i) {
+				const IndexTable& table = _index->vertices;
+				for (uint32_t idx = table.first(keys[i]); idx != NO_INDEX; idx = table.next[idx]) {
+					if (equals(_vertices[idx], pos)) {
+						cnt = insert_sorted(idx, ret, cnt, max);
+					}
 				}
 			}
 			return cnt;
 		}
 
+		int MeshGen::find_edges(const v3& pos, GenIndex* ret, int max) {
+			// every vertex starts the edge with the same index
+			return find_vertices(pos, ret, max);
+		}
+
 		int MeshGen::find_edge(const v3& start, const v3& end) {
 			//LOG << "find_edge: " << DBG_V3(start) << " " << DBG_V3(end);
-			for (uint32_t i = 0; i < _edges.size(); ++i) {
-				const Edge& e = _edges[i];
-				v3 es = _vertices[e.vert_index];
-				v3 ee = _vertices[_edges[e.next].vert_index];
-				if (start == es && end == ee) {
-					return i;
+			uint64_t startKeys[8];
+			uint64_t endKeys[8];
+			int numStart = cell_keys(start, startKeys);
+			int numEnd = cell_keys(end, endKeys);
+			int ret = -1;
+			for (int i = 0; i < numStart; ++i) {
+				for (int j = 0; j < numEnd; ++j) {
+					const IndexTable& table = _index->edges;
+					for (uint32_t idx = table.first(edge_key(startKeys[i], endKeys[j])); idx != NO_INDEX; idx = table.next[idx]) {
+						const Edge& e = _edges[idx];
+						v3 es = _vertices[e.vert_index];
+						v3 ee = _vertices[_edges[e.next].vert_index];
+						if (start == es && end == ee && (ret == -1 || idx < (uint32_t)ret)) {
+							ret = idx;
+						}
+					}
 				}
 			}
-			return -1;
+			return ret;
 		}
 
 		// ----------------------------------------------
@@ -284,9 +496,57 @@ namespace ds {
 		int MeshGen::add_vertex(const v3& pos) {
 			int ret = _vertices.size();
 			_vertices.push_back(pos);
+			_index->vertices.add(cell_key(pos), ret);
 			return ret;
 		}
 
+		// ----------------------------------------------
+		// set vertex - moves the vertex and the two edges
+		// it belongs to into their new cells
+		// ----------------------------------------------
+		void MeshGen::set_vertex(GenIndex vert_index, const v3& pos) {
+			uint64_t oldKey = cell_key(_vertices[vert_index]);
+			uint64_t newKey = cell_key(pos);
+			if (oldKey == newKey) {
+				_vertices[vert_index] = pos;
+				return;
+			}
+			GenIndex prev = _edges[vert_index].prev;
+			unindex_edge(vert_index);
+			unindex_edge(prev);
+			_index->vertices.remove(oldKey, vert_index);
+			_vertices[vert_index] = pos;
+			_index->vertices.add(newKey, vert_index);
+			index_edge(vert_index);
+			index_edge(prev);
+		}
+
+		void MeshGen::index_edge(GenIndex edge_index) {
+			const Edge& e = _edges[edge_index];
+			uint64_t key = edge_key(cell_key(_vertices[e.vert_index]), cell_key(_vertices[_edges[e.next].vert_index]));
+			_index->edges.add(key, edge_index);
+		}
+
+		void MeshGen::unindex_edge(GenIndex edge_index) {
+			const Edge& e = _edges[edge_index];
+			uint64_t key = edge_key(cell_key(_vertices[e.vert_index]), cell_key(_vertices[_edges[e.next].vert_index]));
+			_index->edges.remove(key, edge_index);
+		}
+
+		// ----------------------------------------------
+		// rebuild index - after all vertices have moved
+		// ----------------------------------------------
+		void MeshGen::rebuild_index() {
+			_index->vertices.clear();
+			_index->edges.clear();
+			for (uint32_t i = 0; i < _vertices.size(); ++i) {
+				_index->vertices.add(cell_key(_vertices[i]), i);
+			}
+			for (uint32_t i = 0; i < _edges.size(); ++i) {
+				index_edge(i);
+			}
+		}
+
 		int intersect_triangle(const ds::Ray& ray, const v3& p0, const v3& p1, const v3& p2, float *t, float *u, float *v) {
 			/* find vectors for two edges sharing vert0 */
 			v3 edge1 = p1 - p0;
@@ -360,7 +620,7 @@ namespace ds {
 		// ----------------------------------------------
 		// get color
 		// ----------------------------------------------
-		const Color& MeshGen::get_color(uint16_t face_index) const {
+		const Color& MeshGen::get_color(GenIndex face_index) const {
 			return _faces[face_index].color;
 		}
 
@@ -382,7 +642,7 @@ namespace ds {
 			}
 		}
 
-		void MeshGen::debug_face(uint16_t face_index) {
+		void MeshGen::debug_face(GenIndex face_index) {
 			if (face_index < _faces.size()) {
 				const Face& f = _faces[face_index];
 				LOG << "=> Face: " << face_index << " edge: " << f.edge << " normal: " << f.n << " color: " << f.color << " group: " << f.group;
@@ -399,11 +659,55 @@ namespace ds {
 			}
 		}
 
-		void MeshGen::debug_edge(uint16_t edgeIndex) {
+		void MeshGen::debug_edge(GenIndex edgeIndex) {
 			Edge& e = _edges[edgeIndex];
 			LOG << "edge: " << edgeIndex << " v: " << e.vert_index << " next: " << e.next << " prev: " << e.prev << " vertex (" << e.vert_index << ") : " << _vertices[e.vert_index];
 		}
 
+		// ----------------------------------------------
+		// verify index - compares find_vertices and
+		// find_edge for samples vertices spread over the
+		// mesh with a scan of all vertices and edges.
+		// Returns the number of lookups that differ.
+		// ----------------------------------------------
+		int MeshGen::verify_index(int samples) {
+			const int MAX_FOUND = 8;
+			int wrong = 0;
+			uint32_t step = samples > 0 && _edges.size() > (uint32_t)samples ? _edges.size() / samples : 1;
+			for (uint32_t i = 0; i < _edges.size(); i += step) {
+				const Edge& e = _edges[i];
+				v3 start = _vertices[e.vert_index];
+				v3 end = _vertices[_edges[e.next].vert_index];
+				GenIndex found[MAX_FOUND];
+				int num = find_vertices(start, found, MAX_FOUND);
+				int cnt = 0;
+				bool same = true;
+				for (uint32_t j = 0; j < _vertices.size() && cnt < MAX_FOUND; ++j) {
+					if (equals(_vertices[j], start)) {
+						same = same && cnt < num && found[cnt] == j;
+						++cnt;
+					}
+				}
+				if (!same || cnt != num) {
+					LOG << "find_vertices of vertex " << e.vert_index << " found " << num << " - expected " << cnt;
+					++wrong;
+				}
+				int expected = -1;
+				for (uint32_t j = 0; j < _edges.size() && expected == -1; ++j) {
+					const Edge& o = _edges[j];
+					if (_vertices[o.vert_index] == start && _vertices[_edges[o.next].vert_index] == end) {
+						expected = j;
+					}
+				}
+				int edge = find_edge(start, end);
+				if (edge != expected) {
+					LOG << "find_edge of edge " << i << " found " << edge << " - expected " << expected;
+					++wrong;
+				}
+			}
+			return wrong;
+		}
+
 		// ----------------------------------------------
 		// calculate normal
 		// ----------------------------------------------
@@ -432,7 +736,7 @@ namespace ds {
 		// ----------------------------------------------
 		// extrude edge
 		// ----------------------------------------------
-		uint16_t MeshGen::extrude_edge(uint16_t edgeIndex, const v3& pos) {
+		GenIndex MeshGen::extrude_edge(GenIndex edgeIndex, const v3& pos) {
 			const Edge& e0 = _edges[edgeIndex];
 			const Edge& e1 = _edges[e0.next];
 			v3 p[4];
@@ -446,7 +750,7 @@ namespace ds {
 		// ----------------------------------------------
 		// extrude edge along normal by factor
 		// ----------------------------------------------
-		uint16_t MeshGen::extrude_edge(uint16_t edgeIndex, float factor) {
+		GenIndex MeshGen::extrude_edge(GenIndex edgeIndex, float factor) {
 			const Edge& e0 = _edges[edgeIndex];
 			const Edge& e1 = _edges[e0.next];
 			v3 c = get_center(e0.face_index);
@@ -463,7 +767,7 @@ namespace ds {
 		// ----------------------------------------------
 		// extrude face
 		// ----------------------------------------------
-		uint16_t MeshGen::extrude_face(uint16_t face_index, float factor, uint16_t* faces) {
+		GenIndex MeshGen::extrude_face(GenIndex face_index, float factor, GenIndex* faces) {
 			int cnt = 0;
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
@@ -475,7 +779,7 @@ namespace ds {
 				p[i] += n;
 				ei = e.next;
 			}
-			uint16_t newFace = add_face(p);
+			GenIndex newFace = add_face(p);
 			if (faces != 0) {
 				faces[cnt++] = newFace;
 			}
@@ -486,7 +790,7 @@ namespace ds {
 			for (int i = 0; i < 4; ++i) {
 				Edge& e = _edges[ei];
 				Edge& ne = _edges[nei];
-				uint16_t nnf = combine_edges(ei,nei);
+				GenIndex nnf = combine_edges(ei,nei);
 				if (faces != 0) {
 					faces[cnt++] = nnf;
 				}
@@ -503,7 +807,7 @@ namespace ds {
 		// ----------------------------------------------
 		// add face
 		// ----------------------------------------------
-		uint16_t MeshGen::add_face(const v3& p0, const v3& p1, const v3& p2, const v3& p3) {
+		GenIndex MeshGen::add_face(const v3& p0, const v3& p1, const v3& p2, const v3& p3) {
 			v3 p[] = { p0, p1, p2, p3 };
 			MeshGenOpcode op;
 			int offset = _store.add_data(p0);
@@ -517,10 +821,11 @@ namespace ds {
 		// ----------------------------------------------
 		// add face
 		// ----------------------------------------------
-		uint16_t MeshGen::add_face(v3* positions) {
+		GenIndex MeshGen::add_face(v3* positions) {
 			Face f;
 			int idx = _edges.size();
-			uint16_t fidx = _faces.size();
+			XASSERT(_edges.size() + 3 <= MAX_GEN_INDEX, "Too many edges for GenIndex - use MESHGEN_32BIT_INDICES");
+			GenIndex fidx = _faces.size();
 			for (int i = 0; i < 4; ++i) {
 				v3 start = positions[i];
 				v3 end = positions[(i + 1) % 4];
@@ -534,6 +839,9 @@ namespace ds {
 				e.face_index = fidx;
 				_edges.push_back(e);
 			}
+			for (int i = 0; i < 4; ++i) {
+				index_edge(idx + i);
+			}
 			f.selected = false;
 			f.edge = idx;
 			f.color = _selectedColor;
@@ -546,7 +854,7 @@ namespace ds {
 		// ----------------------------------------------
 		// get edge index
 		// ----------------------------------------------
-		uint16_t MeshGen::get_edge_index(uint16_t face_index, int nr) {
+		GenIndex MeshGen::get_edge_index(GenIndex face_index, int nr) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
 			for (int i = 0; i < nr; ++i) {
@@ -559,7 +867,7 @@ namespace ds {
 		// ----------------------------------------------
 		// select or unselect face
 		// ----------------------------------------------
-		bool MeshGen::select_face(uint16_t face_index) {
+		bool MeshGen::select_face(GenIndex face_index) {
 			bool ret = false;
 			if (face_index < _faces.size()) {
 				_faces[face_index].selected = !_faces[face_index].selected;
@@ -580,7 +888,7 @@ namespace ds {
 		// ----------------------------------------------
 		// texture face
 		// ----------------------------------------------
-		void MeshGen::texture_face(uint16_t face_index, const Texture& t) {
+		void MeshGen::texture_face(GenIndex face_index, const Texture& t) {
 			if (face_index < _faces.size()) {
 				const Face& f = _faces[face_index];
 				int idx = f.edge;
@@ -595,7 +903,7 @@ namespace ds {
 		// ----------------------------------------------
 		// combine
 		// ----------------------------------------------
-		uint16_t MeshGen::make_face(uint16_t* edges) {
+		GenIndex MeshGen::make_face(GenIndex* edges) {
 			v3 p[4];
 			for (int i = 0; i < 4; ++i) {
 				p[i] = _vertices[_edges[edges[i]].vert_index];
@@ -611,7 +919,7 @@ namespace ds {
 		// ----------------------------------------------
 		// combine edges
 		// ----------------------------------------------
-		uint16_t MeshGen::combine_edges(uint16_t edge0, uint16_t edge1) {
+		GenIndex MeshGen::combine_edges(GenIndex edge0, GenIndex edge1) {
 			v3 p[4];
 			const Edge& e0 = _edges[edge0];
 			v3 n = _faces[e0.face_index].n;
@@ -630,7 +938,7 @@ namespace ds {
 			int offset = _store.add_data(edge0);
 			_store.add_data(edge1);
 			record("combine_edges",offset);
-			uint16_t fi = add_face(p);
+			GenIndex fi = add_face(p);
 			set_color(fi, _selectedColor);
 			return fi;
 		}
@@ -638,10 +946,10 @@ namespace ds {
 		// ----------------------------------------------
 		// subdivide
 		// ----------------------------------------------
-		void MeshGen::subdivide(uint16_t face_index) {
+		void MeshGen::subdivide(GenIndex face_index) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
-			uint16_t nf = hsplit_edge(ei);
+			GenIndex nf = hsplit_edge(ei);
 			vsplit_edge(_edges[ei].prev);
 			const Face& next = _faces[nf];
 			const Edge& ne = _edges[next.edge];
@@ -651,7 +959,7 @@ namespace ds {
 		// ----------------------------------------------
 		// split edge horizontally
 		// ----------------------------------------------
-		uint16_t MeshGen::hsplit_edge(uint16_t edgeIndex, float factor) {
+		GenIndex MeshGen::hsplit_edge(GenIndex edgeIndex, float factor) {
 			const Edge& e = _edges[edgeIndex];
 			const Edge& n = _edges[e.next];
 			const Edge& nn = _edges[n.next];
@@ -660,15 +968,15 @@ namespace ds {
 			v3 o2 = _vertices[nn.vert_index];
 			v3 delta = (_vertices[n.vert_index] - _vertices[e.vert_index]) * (1.0f - factor);
 			v3 d2 = (_vertices[nn.vert_index] - _vertices[nnn.vert_index]) * (1.0f - factor);
-			_vertices[n.vert_index] -= delta;
-			_vertices[nn.vert_index] -= d2;
+			set_vertex(n.vert_index, _vertices[n.vert_index] - delta);
+			set_vertex(nn.vert_index, _vertices[nn.vert_index] - d2);
 			v3 p[] = { _vertices[n.vert_index] , o1, o2, _vertices[nn.vert_index] };
 			MeshGenOpcode op;
 			int offset = _store.add_data(edgeIndex);
 			_store.add_data(factor);
 			record("h_split",offset);
 			const Face& face = _faces[e.face_index];
-			uint16_t f = add_face(p);
+			GenIndex f = add_face(p);
 			set_color(f, face.color);
 			return f;
 		}
@@ -676,7 +984,7 @@ namespace ds {
 		// ----------------------------------------------
 		// split edge vertically
 		// ----------------------------------------------
-		uint16_t MeshGen::vsplit_edge(uint16_t edgeIndex, float factor) {
+		GenIndex MeshGen::vsplit_edge(GenIndex edgeIndex, float factor) {
 			const Edge& e = _edges[edgeIndex];
 			const Edge& n = _edges[e.next];
 			const Edge& nn = _edges[n.next];
@@ -685,14 +993,14 @@ namespace ds {
 			v3 o2 = _vertices[nn.vert_index];
 			v3 delta = (_vertices[n.vert_index] - _vertices[e.vert_index]) * (1.0f - factor);
 			v3 d2 = (_vertices[nn.vert_index] - _vertices[nnn.vert_index]) * (1.0f - factor);
-			_vertices[n.vert_index] -= delta;
-			_vertices[nn.vert_index] -= d2;
+			set_vertex(n.vert_index, _vertices[n.vert_index] - delta);
+			set_vertex(nn.vert_index, _vertices[nn.vert_index] - d2);
 			v3 p[] = { o1, o2, _vertices[nn.vert_index] , _vertices[n.vert_index] };
 			int offset = _store.add_data(edgeIndex);
 			_store.add_data(factor);
 			record("v_split",offset);
 			const Face& face = _faces[e.face_index];
-			uint16_t f = add_face(p);
+			GenIndex f = add_face(p);
 			set_color(f, face.color);
 			return f;
 		}
@@ -707,11 +1015,11 @@ namespace ds {
 		// ----------------------------------------------
 		// move vertex
 		// ----------------------------------------------
-		void MeshGen::move_vertex(uint16_t vert_index, const v3& position) {
-			uint16_t connections[16];
+		void MeshGen::move_vertex(GenIndex vert_index, const v3& position) {
+			GenIndex connections[16];
 			int num = find_vertices(_vertices[vert_index], connections, 16);
 			for (int j = 0; j < num; ++j) {
-				_vertices[connections[j]] += position;
+				set_vertex(connections[j], _vertices[connections[j]] + position);
 			}
 			int offset = _store.add_data(vert_index);
 			_store.add_data(position);
@@ -721,15 +1029,15 @@ namespace ds {
 		// ----------------------------------------------
 		// move edge
 		// ----------------------------------------------
-		void MeshGen::move_edge(uint16_t edgeIndex, const v3& position) {
+		void MeshGen::move_edge(GenIndex edgeIndex, const v3& position) {
 			const Edge& e0 = _edges[edgeIndex];
 			const Edge& e1 = _edges[e0.next];
-			uint16_t connections[16];
+			GenIndex connections[16];
 			v3 p[] = { _vertices[e0.vert_index], _vertices[e1.vert_index] };
 			for (int i = 0; i < 2; ++i) {
 				int num = find_vertices(p[i], connections, 16);
 				for (int j = 0; j < num; ++j) {
-					_vertices[connections[j]] += position;
+					set_vertex(connections[j], _vertices[connections[j]] + position);
 				}
 			}
 			int offset = _store.add_data(edgeIndex);
@@ -740,16 +1048,16 @@ namespace ds {
 		// ----------------------------------------------
 		// move face
 		// ----------------------------------------------
-		void MeshGen::move_face(uint16_t face_index, const v3& position) {
+		void MeshGen::move_face(GenIndex face_index, const v3& position) {
 			Face& f = _faces[face_index];
 			int ei = f.edge;
-			uint16_t connections[16];
+			GenIndex connections[16];
 			for (int i = 0; i < 4; ++i) {
 				const Edge& e = _edges[ei];
 				//move_edge(ei, position);
 				int num = find_vertices(_vertices[e.vert_index], connections, 16);
 				for (int j = 0; j < num; ++j) {
-					_vertices[connections[j]] += position;
+					set_vertex(connections[j], _vertices[connections[j]] + position);
 				}
 				ei = e.next;
 			}
@@ -759,7 +1067,7 @@ namespace ds {
 		// ----------------------------------------------
 		// expand face
 		// ----------------------------------------------
-		void MeshGen::expand_face(uint16_t center_face, uint16_t* adjacents, float w, float h) {
+		void MeshGen::expand_face(GenIndex center_face, GenIndex* adjacents, float w, float h) {
 			v3 center = get_center(center_face);
 			const Face& f = _faces[center_face];
 			int indices[] = { 0, 1, 1, 2, 2, 3, 3, 0 };
@@ -788,7 +1096,7 @@ namespace ds {
 		// ----------------------------------------------
 		// scale face
 		// ----------------------------------------------
-		void MeshGen::scale_face(uint16_t face_index, float scale) {
+		void MeshGen::scale_face(GenIndex face_index, float scale) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
 			v3 center = get_center(face_index);
@@ -807,7 +1115,7 @@ namespace ds {
 				ei = e0.next;
 			}
 			ei = f.edge;
-			uint16_t connections[16];
+			GenIndex connections[16];
 			for (int i = 0; i < 4; ++i) {
 				Edge& e0 = _edges[ei];
 				move_edge(ei, c[i]);
@@ -818,7 +1126,7 @@ namespace ds {
 		// ----------------------------------------------
 		// get center of face
 		// ----------------------------------------------
-		v3 MeshGen::get_center(uint16_t face_index) {
+		v3 MeshGen::get_center(GenIndex face_index) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
 			v3 ret;
@@ -844,7 +1152,7 @@ namespace ds {
 		// ----------------------------------------------
 		// set color
 		// ----------------------------------------------
-		void MeshGen::set_color(uint16_t face_index, const Color& color) {
+		void MeshGen::set_color(GenIndex face_index, const Color& color) {
 			if (face_index < _faces.size()) {
 				_faces[face_index].color = color;
 				int offset = _store.add_data(face_index);
@@ -885,9 +1193,9 @@ namespace ds {
 		// ----------------------------------------------
 		// add cube
 		// ----------------------------------------------
-		uint16_t MeshGen::add_cube(const v3 & position, const v3 & size, uint16_t* faces) {
+		GenIndex MeshGen::add_cube(const v3 & position, const v3 & size, GenIndex* faces) {
 			v3 half_size = size * 0.5f;
-			uint16_t my_faces[6];
+			GenIndex my_faces[6];
 			v3 p0[4];
 			v3 p[] = {
 				v3(-half_size.x, half_size.y, half_size.z),
@@ -934,9 +1242,9 @@ namespace ds {
 		// ----------------------------------------------
 		// add cube
 		// ----------------------------------------------
-		uint16_t MeshGen::add_cube(const v3 & position, const v3 & size, const Color& c, uint16_t* faces) {
+		GenIndex MeshGen::add_cube(const v3 & position, const v3 & size, const Color& c, GenIndex* faces) {
 			v3 half_size = size * 0.5f;
-			uint16_t my_faces[6];
+			GenIndex my_faces[6];
 			v3 p0[4];
 			v3 p[] = {
 				v3(-half_size.x, half_size.y, half_size.z),
@@ -986,11 +1294,11 @@ namespace ds {
 		// ----------------------------------------------
 		// get connected edges
 		// ----------------------------------------------
-		int MeshGen::get_connected_edges(uint16_t edge_index, uint16_t* ret, int max) {
+		int MeshGen::get_connected_edges(GenIndex edge_index, GenIndex* ret, int max) {
 			int cnt = 0;
 			const Edge& e0 = _edges[edge_index];
 			const Edge& e1 = _edges[e0.next];
-			uint16_t c[16];
+			GenIndex c[16];
 			int num = find_edges(_vertices[e0.vert_index], c, 16);
 			for (int i = 0; i < num; ++i) {
 				const Edge& ne0 = _edges[c[i]];
@@ -1034,7 +1342,7 @@ namespace ds {
 				nv.y = v.y * sqrt(1.0f - z2 * 0.5f - x2 * 0.5f + z2 * x2 / 3.0f);
 				nv.z = v.z * sqrt(1.0f - x2 * 0.5f - y2 * 0.5f + x2 * y2 / 3.0f);
 				//_vertices[verts.indices[i]] = normalize(_vertices[verts.indices[i]]) * radius;
-				_vertices[verts.indices[i]] = nv;
+				set_vertex(verts.indices[i], nv);
 			}
 			recalculate_normals();
 		}
@@ -1050,7 +1358,7 @@ namespace ds {
 			return length(p - *ret);
 		}
 
-		int MeshGen::is_edge_below(uint16_t edge_index,const Plane& pl) {
+		int MeshGen::is_edge_below(GenIndex edge_index,const Plane& pl) {
 			int ret = 0;
 			const Edge& e0 = _edges[edge_index];
 			const Edge& e1 = _edges[e0.next];
@@ -1077,12 +1385,12 @@ namespace ds {
 					//LOG << "P: " << DBG_V3(_vertices[e.vert_index]) << " R: " << r;
 					if (r == 1) {
 						float dst = dist(_vertices[e.vert_index], pl, &pp);
-						_vertices[e.vert_index] = pp;
+						set_vertex(e.vert_index, pp);
 					}
 					else if (r == 2) {
 						const Edge& next = _edges[e.next];
 						float dst = dist(_vertices[next.vert_index], pl, &pp);
-						_vertices[next.vert_index] = pp;
+						set_vertex(next.vert_index, pp);
 					}
 					else if (r == 3) {
 						++cnt;
@@ -1118,11 +1426,11 @@ namespace ds {
 		// ----------------------------------------------
 		// find adjacent faces
 		// ----------------------------------------------
-		void MeshGen::find_adjacent_faces(uint16_t face_index, IndexList& list) {
+		void MeshGen::find_adjacent_faces(GenIndex face_index, IndexList& list) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
 			list.add_unique(face_index);
-			uint16_t connections[16];
+			GenIndex connections[16];
 			for (int i = 0; i < 4; ++i) {
 				Edge& e0 = _edges[ei];
 				int num = get_connected_edges(ei, connections, 16);
@@ -1150,7 +1458,7 @@ namespace ds {
 				if (f.group == group) {
 					for (int j = 0; j < 4; ++j) {
 						const Edge& e = _edges[ei];
-						_vertices[e.vert_index] = _vertices[e.vert_index] * world;
+						set_vertex(e.vert_index, _vertices[e.vert_index] * world);
 						ei = e.next;
 					}
 				}
@@ -1168,7 +1476,7 @@ namespace ds {
 				if (f.group == group) {
 					for (int j = 0; j < 4; ++j) {
 						const Edge& e = _edges[ei];
-						_vertices[e.vert_index] = _vertices[e.vert_index] * s;
+						set_vertex(e.vert_index, _vertices[e.vert_index] * s);
 						ei = e.next;
 					}
 				}
@@ -1189,7 +1497,7 @@ namespace ds {
 						p[j] = _vertices[e.vert_index] + pos;
 						ei = e.next;
 					}
-					uint16_t fi = add_face(p);
+					GenIndex fi = add_face(p);
 					set_color(fi, f.color);
 				}
 			}
@@ -1205,7 +1513,7 @@ namespace ds {
 				if (f.group == group) {
 					for (int j = 0; j < 4; ++j) {
 						const Edge& e = _edges[ei];
-						_vertices[e.vert_index] += pos;
+						set_vertex(e.vert_index, _vertices[e.vert_index] + pos);
 						ei = e.next;
 					}
 				}
@@ -1215,7 +1523,7 @@ namespace ds {
 		// ----------------------------------------------
 		// add cube
 		// ----------------------------------------------
-		uint16_t MeshGen::add_cube(const v3 & position, const v3 & size, const v3 & rotation) {
+		GenIndex MeshGen::add_cube(const v3 & position, const v3 & size, const v3 & rotation) {
 			mat4 rotY = matrix::mat4RotationY(rotation.y);
 			mat4 rotX = matrix::mat4RotationX(rotation.x);
 			mat4 rotZ = matrix::mat4RotationZ(rotation.z);
@@ -1238,7 +1546,7 @@ namespace ds {
 				e[i] = world * e[i];
 			}
 			int indices[] = { 1,5,9,0,10 };
-			uint16_t faces[6];
+			GenIndex faces[6];
 			faces[0] = add_face(p0);
 			const Face& f = _faces[faces[0]];
 			for (int i = 0; i < 5; ++i) {
@@ -1254,14 +1562,14 @@ namespace ds {
 		// ----------------------------------------------
 		// get face
 		// ----------------------------------------------
-		const Face& MeshGen::get_face(uint16_t face_index) const {
+		const Face& MeshGen::get_face(GenIndex face_index) const {
 			return _faces[face_index];
 		}
 
 		// ----------------------------------------------
 		// get edge from specific face
 		// ----------------------------------------------
-		uint16_t MeshGen::get_edge(uint16_t face_index, uint16_t edge_offset) {
+		GenIndex MeshGen::get_edge(GenIndex face_index, GenIndex edge_offset) {
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
 			for (int i = 0; i < edge_offset; ++i) {
@@ -1283,7 +1591,7 @@ namespace ds {
 			}
 		}
 
-		bool MeshGen::find_connection(uint16_t first_face, uint16_t second_face, uint16_t* edges) {
+		bool MeshGen::find_connection(GenIndex first_face, GenIndex second_face, GenIndex* edges) {
 			const Face& f = _faces[first_face];
 			int ei = f.edge;
 			for (int i = 0; i < 4; ++i) {
@@ -1304,8 +1612,8 @@ namespace ds {
 			return false;
 		}
 
-		int MeshGen::join_faces(uint16_t first_face, uint16_t second_face) {
-			uint16_t connection[2];
+		int MeshGen::join_faces(GenIndex first_face, GenIndex second_face) {
+			GenIndex connection[2];
 			v3 p[4];
 			if (find_connection(first_face, second_face, connection)) {
 				const Edge& e1 = _edges[connection[0]];
@@ -1316,7 +1624,7 @@ namespace ds {
 				p[1] = _vertices[_edges[e1p].vert_index];
 				p[2] = _vertices[_edges[_edges[e2n].next].vert_index];
 				p[3] = _vertices[_edges[e2.prev].vert_index];
-				uint16_t nfi = add_face(p);
+				GenIndex nfi = add_face(p);
 				remove_face(first_face);
 				remove_face(second_face);
 				return nfi;
@@ -1324,7 +1632,7 @@ namespace ds {
 			return -1;
 		}
 
-		int MeshGen::slice(uint16_t face_index, int segments, uint16_t* faces, int max) {
+		int MeshGen::slice(GenIndex face_index, int segments, GenIndex* faces, int max) {
 			const Face& f = _faces[face_index];
 			const Edge& e0 = _edges[f.edge];
 			const Edge& e1 = _edges[e0.next];
@@ -1341,9 +1649,9 @@ namespace ds {
 			float sx = length(_vertices[e1.vert_index] - _vertices[e0.vert_index]) / static_cast<float>(segments);
 			float sy = length(_vertices[e2.vert_index] - _vertices[e1.vert_index]) / static_cast<float>(segments);
 
-			_vertices[e1.vert_index] = _vertices[e0.vert_index] + n1 * sx;
-			_vertices[e2.vert_index] = _vertices[e1.vert_index] + n2 * sy;
-			_vertices[e3.vert_index] = _vertices[e0.vert_index] + n3 * sy;			
+			set_vertex(e1.vert_index, _vertices[e0.vert_index] + n1 * sx);
+			set_vertex(e2.vert_index, _vertices[e1.vert_index] + n2 * sy);
+			set_vertex(e3.vert_index, _vertices[e0.vert_index] + n3 * sy);			
 			v3 s1 = n1 * sx;
 			v3 s2 = n3 * sy;
 			v3 p[4];
@@ -1357,7 +1665,7 @@ namespace ds {
 						p[1] = sp + s1;
 						p[2] = sp + s1 + s2;
 						p[3] = sp + s2;
-						uint16_t fi = add_face(p);
+						GenIndex fi = add_face(p);
 						set_color(fi, f.color);
 						if (faces != 0 && cnt < max) {
 							faces[cnt++] = fi;
@@ -1368,7 +1676,7 @@ namespace ds {
 			return cnt;
 		}
 
-		int MeshGen::slice(uint16_t face_index, int stepsX, int stepsY, uint16_t* faces, int max) {
+		int MeshGen::slice(GenIndex face_index, int stepsX, int stepsY, GenIndex* faces, int max) {
 			const Face& f = _faces[face_index];			
 			Color clr = f.color;
 			const Edge& e0 = _edges[f.edge];
@@ -1386,9 +1694,9 @@ namespace ds {
 			float sx = length(_vertices[e1.vert_index] - _vertices[e0.vert_index]) / static_cast<float>(stepsX);
 			float sy = length(_vertices[e2.vert_index] - _vertices[e1.vert_index]) / static_cast<float>(stepsY);
 
-			_vertices[e1.vert_index] = _vertices[e0.vert_index] + n1 * sx;
-			_vertices[e2.vert_index] = _vertices[e1.vert_index] + n2 * sy;
-			_vertices[e3.vert_index] = _vertices[e0.vert_index] + n3 * sy;
+			set_vertex(e1.vert_index, _vertices[e0.vert_index] + n1 * sx);
+			set_vertex(e2.vert_index, _vertices[e1.vert_index] + n2 * sy);
+			set_vertex(e3.vert_index, _vertices[e0.vert_index] + n3 * sy);
 			v3 s1 = n1 * sx;
 			v3 s2 = n3 * sy;
 			v3 p[4];
@@ -1402,7 +1710,7 @@ namespace ds {
 						p[1] = sp + s1;
 						p[2] = sp + s1 + s2;
 						p[3] = sp + s2;
-						uint16_t fi = add_face(p);
+						GenIndex fi = add_face(p);
 						set_color(fi, clr);
 						if (faces != 0 && cnt < max) {
 							faces[cnt++] = fi;
@@ -1434,7 +1742,7 @@ namespace ds {
 				for (int j = 0; j < 4; ++j) {
 					p[j] = world * p[j];
 				}
-				uint16_t ni = add_face(p);
+				GenIndex ni = add_face(p);
 				Face& nf = _faces[ni];
 				nf.color = f.color;
 			}
@@ -1457,6 +1765,8 @@ namespace ds {
 		void MeshGen::clear() {
 			_vertices.clear();
 			_edges.clear();
+			_index->vertices.clear();
+			_index->edges.clear();
 			_faces.clear();
 			_store.data.clear();
 			_opcodes.clear();
@@ -1532,7 +1842,7 @@ namespace ds {
 			fclose(f);
 		}
 
-		void MeshGen::remove_face(uint16_t face_index) {
+		void MeshGen::remove_face(GenIndex face_index) {
 			assert(face_index < _faces.size());
 			_faces[face_index].deleted = true;
 		}
@@ -1552,24 +1862,17 @@ namespace ds {
 		// ----------------------------------------------
 		void MeshGen::save_mesh(const char* fileName) {
 			recalculate_normals();
-			char buffer[256];
-			sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
-			BinaryFile b;
-			if (b.open(buffer,ds::FileMode::WRITE)) {
-				b.write(_faces.size() * 4);
-				for (uint32_t i = 0; i < _faces.size(); ++i) {
-					const Face& face = _faces[i];
-					int idx = face.edge;
-					for (int j = 0; j < 4; ++j) {
-						Edge& e = _edges[idx];
-						b.write(smooth_position(_vertices[e.vert_index]));
-						b.write(smooth_position(face.n));
-						b.write(e.uv);
-						b.write(face.color);												
-						idx = e.next;
-					}
+			Mesh mesh;
+			for (uint32_t i = 0; i < _faces.size(); ++i) {
+				const Face& face = _faces[i];
+				int idx = face.edge;
+				for (int j = 0; j < 4; ++j) {
+					Edge& e = _edges[idx];
+					mesh.add(smooth_position(_vertices[e.vert_index]), smooth_position(face.n), e.uv, face.color);
+					idx = e.next;
 				}
 			}
+			mesh.save(fileName);
 		}
 
 		// ----------------------------------------------
@@ -1640,7 +1943,7 @@ namespace ds {
 		// ----------------------------------------------
 		// get connected faces
 		// ----------------------------------------------
-		int MeshGen::get_connected_faces(uint16_t face_index, uint16_t* ret, int max) {
+		int MeshGen::get_connected_faces(GenIndex face_index, GenIndex* ret, int max) {
 			const Face& f = _faces[face_index];
 			return 0;
 		}
@@ -1649,7 +1952,7 @@ namespace ds {
 		// create sphere
 		// ----------------------------------------------
 		void MeshGen::create_sphere(const v3& pos,float radius, int segments, int stacks) {
-			uint16_t faces[6];
+			GenIndex faces[6];
 			int group = startGroup();
 			add_cube(v3(0,0,0), v3(2, 2, 2),faces);
 			for (int i = 0; i < 6; ++i) {
@@ -1666,11 +1969,11 @@ namespace ds {
 		// ----------------------------------------------
 		// create torus
 		// ----------------------------------------------
-		uint16_t MeshGen::create_torus(const v3& position, float radius, float width, float depth, uint16_t segments) {
+		GenIndex MeshGen::create_torus(const v3& position, float radius, float width, float depth, GenIndex segments) {
 			float angleStep = TWO_PI / static_cast<float>(segments);
 			v3 p[4];
 			v3 pe[4];
-			uint16_t ret = 0;
+			GenIndex ret = 0;
 			float angle = 0.0f;
 			float next_angle = angleStep;
 			float outer_radius = radius + width;
@@ -1680,13 +1983,13 @@ namespace ds {
 				p[1] = position + v3(outer_radius * cos(next_angle), outer_radius * sin(next_angle), -half_size);
 				p[2] = position + v3(outer_radius * cos(angle), outer_radius * sin(angle), -half_size);
 				p[3] = position + v3(radius * cos(angle), radius * sin(angle), -half_size);
-				uint16_t f1 = add_face(p);
+				GenIndex f1 = add_face(p);
 				if (i == 0) {
 					ret = f1;
 				}
 				const Face& fc1 = _faces[f1];
 				const Edge& e1 = _edges[fc1.edge];
-				uint16_t f2 = extrude_edge(e1.next, v3(0, 0, depth));
+				GenIndex f2 = extrude_edge(e1.next, v3(0, 0, depth));
 				pe[0] = p[1];
 				pe[1] = p[0];
 				pe[2] = p[3];
@@ -1694,10 +1997,10 @@ namespace ds {
 				for (int j = 0; j < 4; ++j) {
 					pe[j].z += depth;
 				}
-				uint16_t f3 = add_face(pe);
+				GenIndex f3 = add_face(pe);
 				const Face& fc3 = _faces[f3];
 				const Edge& e2 = _edges[fc3.edge];
-				uint16_t f4 = extrude_edge(e2.next, v3(0, 0, -depth));
+				GenIndex f4 = extrude_edge(e2.next, v3(0, 0, -depth));
 
 				angle += angleStep;
 				next_angle += angleStep;
@@ -1739,6 +2042,7 @@ namespace ds {
 			for (uint32_t i = 0; i < _vertices.size(); ++i) {
 				_vertices[i] = world * _vertices[i];
 			}
+			rebuild_index();
 		}
 
 		void MeshGen::create_hexagon(float radius) {
@@ -1762,7 +2066,7 @@ namespace ds {
 		// ----------------------------------------------
 		// create ring
 		// ----------------------------------------------
-		void MeshGen::create_cylinder(const v3& pos, float bottomRadius, float topRadius, float height, uint16_t segments, float startAngle) {
+		void MeshGen::create_cylinder(const v3& pos, float bottomRadius, float topRadius, float height, GenIndex segments, float startAngle) {
 			float angleStep = TWO_PI / static_cast<float>(segments);
 			v3 p[4];
 			float angle = startAngle;
@@ -1775,7 +2079,7 @@ namespace ds {
 				p[1] = pos + v3(topRadius * cos(next_angle), hh, topRadius * sin(next_angle));
 				p[2] = pos + v3(bottomRadius * cos(next_angle), -hh, bottomRadius * sin(next_angle));
 				p[3] = pos + v3(bottomRadius * cos(angle), -hh, bottomRadius * sin(angle));
-				uint16_t fi = add_face(p);
+				GenIndex fi = add_face(p);
 				set_color(fi, _selectedColor);
 				topPoints[i] = p[0];
 				bottomPoints[i] = p[3];
@@ -1800,7 +2104,7 @@ namespace ds {
 				p[1] = topCenter;
 				p[2] = topPoints[(cnt + 2) % segments];
 				p[3] = topPoints[(cnt + 1) % segments];
-				uint16_t fi = add_face(p);
+				GenIndex fi = add_face(p);
 				set_color(fi, _selectedColor);
 				cnt += 2;
 			}
@@ -1810,7 +2114,7 @@ namespace ds {
 				p[1] = bottomPoints[(cnt + 1) % segments];
 				p[2] = bottomPoints[(cnt + 2) % segments];				
 				p[3] = bottomCenter;
-				uint16_t fi = add_face(p);
+				GenIndex fi = add_face(p);
 				set_color(fi, _selectedColor);
 				cnt += 2;
 			}
@@ -1823,7 +2127,7 @@ namespace ds {
 			record("add_cylinder",offset);
 		}
 
-		void MeshGen::create_tube(const v3& pos, float bottomRadius, float topRadius, float height, float width, uint16_t segments) {
+		void MeshGen::create_tube(const v3& pos, float bottomRadius, float topRadius, float height, float width, GenIndex segments) {
 			float angleStep = TWO_PI / static_cast<float>(segments);
 			v3 p[4];
 			float angle = 0.0f;
@@ -1837,7 +2141,7 @@ namespace ds {
 				p[1] = pos + v3(topRadius * cos(next_angle), hh, topRadius * sin(next_angle));
 				p[2] = pos + v3(bottomRadius * cos(next_angle), -hh, bottomRadius * sin(next_angle));
 				p[3] = pos + v3(bottomRadius * cos(angle), -hh, bottomRadius * sin(angle));
-				uint16_t fi = add_face(p);
+				GenIndex fi = add_face(p);
 				set_color(fi, _selectedColor);
 				// top
 				p[0] = pos + v3(top_inner * cos(next_angle), hh, top_inner * sin(next_angle));
@@ -1873,7 +2177,7 @@ namespace ds {
 		// ----------------------------------------------
 		// create ring
 		// ----------------------------------------------
-		void MeshGen::create_ring(float radius, float width, uint16_t segments) {
+		void MeshGen::create_ring(float radius, float width, GenIndex segments) {
 			float angleStep = TWO_PI / static_cast<float>(segments);
 			v3 p[4];
 			float angle = 0.0f;
@@ -1884,7 +2188,7 @@ namespace ds {
 				p[1] = v3(outer_radius * cos(next_angle), 0.0f, outer_radius * sin(next_angle));
 				p[2] = v3(outer_radius * cos(angle), 0.0f, outer_radius * sin(angle));
 				p[3] = v3(radius * cos(angle), 0.0f, radius * sin(angle));
-				uint16_t fi = add_face(p);
+				GenIndex fi = add_face(p);
 				set_color(fi, _selectedColor);
 				angle += angleStep;
 				next_angle += angleStep;
@@ -1915,7 +2219,7 @@ namespace ds {
 			}
 		}
 
-		void MeshGen::show_edges(uint16_t face_index) {
+		void MeshGen::show_edges(GenIndex face_index) {
 			Color clr[] = { Color(255, 0, 0, 255), Color(0, 255, 0, 255), Color(0, 0, 255, 255), Color(255, 255, 0, 255) };
 			const Face& f = _faces[face_index];
 			int ei = f.edge;
@@ -1933,7 +2237,7 @@ namespace ds {
 				p[1] = v3(p1 + cr * 0.1f);
 				p[2] = p1;
 				p[3] = p0;
-				uint16_t f = add_face(p);
+				GenIndex f = add_face(p);
 				set_color(f,clr[i]);				
 			}
 		}
@@ -1964,7 +2268,7 @@ namespace ds {
 		}
 
 		void slice_uniform(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t face_index = 0;
+			GenIndex face_index = 0;
 			int segments = 0;
 			store.get_data(op, 0, &face_index);
 			store.get_data(op, 1, &segments);
@@ -1972,9 +2276,9 @@ namespace ds {
 		}
 
 		void slice(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t face_index = 0;
-			uint16_t stepsX = 0;
-			uint16_t stepsY = 0;
+			GenIndex face_index = 0;
+			GenIndex stepsX = 0;
+			GenIndex stepsY = 0;
 			store.get_data(op, 0, &face_index);
 			store.get_data(op, 1, &stepsX);
 			store.get_data(op, 2, &stepsY);
@@ -1982,7 +2286,7 @@ namespace ds {
 		}
 
 		void set_color(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t face_index = 0;
+			GenIndex face_index = 0;
 			Color color;
 			store.get_data(op, 0, &face_index);
 			store.get_data(op, 1, &color);
@@ -1990,7 +2294,7 @@ namespace ds {
 		}
 
 		void move_edge(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edge_index = 0;
+			GenIndex edge_index = 0;
 			v3 p;
 			store.get_data(op, 0, &edge_index);
 			store.get_data(op, 1, &p);
@@ -1998,7 +2302,7 @@ namespace ds {
 		}
 
 		void v_split(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edge_index = 0;
+			GenIndex edge_index = 0;
 			float factor = 0.5f;
 			store.get_data(op, 0, &edge_index);
 			store.get_data(op, 1, &factor);
@@ -2006,7 +2310,7 @@ namespace ds {
 		}
 
 		void h_split(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edge_index = 0;
+			GenIndex edge_index = 0;
 			float factor = 0.5f;
 			store.get_data(op, 0, &edge_index);
 			store.get_data(op, 1, &factor);
@@ -2014,7 +2318,7 @@ namespace ds {
 		}
 
 		void make_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edges[4];
+			GenIndex edges[4];
 			for (int i = 0; i < 4; ++i) {
 				store.get_data(op, i, &edges[i]);
 			}
@@ -2030,15 +2334,15 @@ namespace ds {
 		}
 
 		void combine_edges(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t e0;
-			uint16_t e1;
+			GenIndex e0;
+			GenIndex e1;
 			store.get_data(op, 0, &e0);
 			store.get_data(op, 1, &e1);
 			gen->combine_edges(e0, e1);
 		}
 
 		void extrude_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t face;
+			GenIndex face;
 			float factor;
 			store.get_data(op, 0, &face);
 			store.get_data(op, 1, &factor);
@@ -2046,7 +2350,7 @@ namespace ds {
 		}
 
 		void scale_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t face;
+			GenIndex face;
 			float factor;
 			store.get_data(op, 0, &face);
 			store.get_data(op, 1, &factor);
@@ -2058,7 +2362,7 @@ namespace ds {
 			float bottom;
 			float top;
 			float height;
-			uint16_t segments;
+			GenIndex segments;
 			store.get_data(op, 0, &p);
 			store.get_data(op, 3, &bottom);
 			store.get_data(op, 4, &top);
@@ -2072,7 +2376,7 @@ namespace ds {
 			float bottom;
 			float top;
 			float height;
-			uint16_t segments;
+			GenIndex segments;
 			Color clr;
 			store.get_data(op, 0, &p);
 			store.get_data(op, 3, &bottom);
@@ -2088,7 +2392,7 @@ namespace ds {
 		}
 
 		void move_vertex(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t vert_index;
+			GenIndex vert_index;
 			v3 p;
 			store.get_data(op, 0, &vert_index);
 			store.get_data(op, 1, &p);
@@ -2096,7 +2400,7 @@ namespace ds {
 		}
 
 		void extrude_edge_normal(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edge_index;
+			GenIndex edge_index;
 			float factor = 0.0f;
 			store.get_data(op, 0, &edge_index);
 			store.get_data(op, 1, &factor);
@@ -2104,7 +2408,7 @@ namespace ds {
 		}
 
 		void extrude_edge(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t edge_index;
+			GenIndex edge_index;
 			v3 p;
 			store.get_data(op, 0, &edge_index);
 			store.get_data(op, 1, &p);
@@ -2112,7 +2416,7 @@ namespace ds {
 		}
 
 		void move_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t vert_index;
+			GenIndex vert_index;
 			v3 p;
 			store.get_data(op, 0, &vert_index);
 			store.get_data(op, 1, &p);
@@ -2120,7 +2424,7 @@ namespace ds {
 		}
 
 		void remove_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t vert_index;
+			GenIndex vert_index;
 			store.get_data(op, 0, &vert_index);
 			gen->remove_face(vert_index);
 		}
@@ -2140,7 +2444,7 @@ namespace ds {
 		void add_ring(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
 			float radius;
 			float width;
-			uint16_t segments;
+			GenIndex segments;
 			store.get_data(op, 0, &radius);
 			store.get_data(op, 1, &width);
 			store.get_data(op, 2, &segments);
@@ -2196,7 +2500,7 @@ namespace ds {
 			float topRadius;
 			float height;
 			float width;
-			uint16_t segments;
+			GenIndex segments;
 			store.get_data(op, 0, &p);
 			store.get_data(op, 3, &bottomRadius);
 			store.get_data(op, 4, &topRadius);
@@ -2207,8 +2511,8 @@ namespace ds {
 		}
 
 		void expand_face(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
-			uint16_t center;
-			uint16_t adjacents[4];
+			GenIndex center;
+			GenIndex adjacents[4];
 			float w;
 			float h;
 			store.get_data(op, 0, &center);
@@ -2224,8 +2528,8 @@ namespace ds {
 		void add_sphere(MeshGen* gen, const MeshGenOpcode& op, const DataStore& store) {
 			v3 p;
 			float radius;
-			uint16_t segments;
-			uint16_t stacks;
+			GenIndex segments;
+			GenIndex stacks;
 			store.get_data(op, 0, &p);
 			store.get_data(op, 3, &radius);
 			store.get_data(op, 4, &segments);
@@ -5,14 +5,36 @@ namespace ds {
 
 	namespace gen {
 
+	// ---------------------------------------
+	// Index of vertices, edges and faces. Meshes
+	// with more than 65535 edges need the build
+	// option MESHGEN_32BIT_INDICES which is set
+	// by MeshGen.props. Opcode data keeps indices
+	// as float which is exact up to 2^24. Objects
+	// built with a different width do not link.
+	// ---------------------------------------
+#ifdef MESHGEN_32BIT_INDICES
+	typedef uint32_t GenIndex;
+	const uint32_t MAX_GEN_INDEX = 0xFFFFFFFF;
+#ifdef _MSC_VER
+#pragma detect_mismatch("MeshGenIndexBits", "32")
+#endif
+#else
+	typedef uint16_t GenIndex;
+	const uint32_t MAX_GEN_INDEX = 0xFFFF;
+#ifdef _MSC_VER
+#pragma detect_mismatch("MeshGenIndexBits", "16")
+#endif
+#endif
+
 	// ---------------------------------------
 	// UnqiueIndexList
 	// ---------------------------------------
 	struct IndexList {
 
-		Array<uint16_t> indices;
+		Array<GenIndex> indices;
 
-		bool add_unique(uint16_t idx) {
+		bool add_unique(GenIndex idx) {
 			if (!contains(idx)) {
 				indices.push_back(idx);
 				return true;
@@ -20,7 +42,7 @@ namespace ds {
 			return false;
 		}
 
-		bool contains(uint16_t idx) const {
+		bool contains(GenIndex idx) const {
 			for (uint32_t i = 0; i < indices.size(); ++i) {
 				if (indices[i] == idx) {
 					return true;
@@ -39,11 +61,11 @@ namespace ds {
 	// ---------------------------------------
 	struct Edge {
 
-		uint16_t next;
-		uint16_t prev;
-		uint16_t vert_index;
-		uint16_t face_index;
-		uint16_t opposite;
+		GenIndex next;
+		GenIndex prev;
+		GenIndex vert_index;
+		GenIndex face_index;
+		GenIndex opposite;
 		v2 uv;
 
 	};
@@ -53,7 +75,7 @@ namespace ds {
 	// ---------------------------------------
 	struct Face {
 
-		uint16_t edge;
+		GenIndex edge;
 		v3 n;
 		Color color;
 		bool selected;
@@ -64,6 +86,12 @@ namespace ds {
 
 	};
 
+	// ---------------------------------------
+	// spatial hash of the vertices and the
+	// (start, end) -> edge map of MeshGen
+	// ---------------------------------------
+	struct MeshGenIndex;
+
 	struct Bone {
 		int parent;
 		mat4 mat;
@@ -108,7 +136,7 @@ namespace ds {
 			return cnt;
 		}
 
-		uint32_t add_data(uint16_t v) {
+		uint32_t add_data(GenIndex v) {
 			int cnt = data.size();
 			data.push_back(static_cast<float>(v));
 			return cnt;
@@ -130,9 +158,9 @@ namespace ds {
 			}
 		}
 
-		void get_data(const MeshGenOpcode& op, int index, uint16_t* ret) const {
+		void get_data(const MeshGenOpcode& op, int index, GenIndex* ret) const {
 			int offset = op.offset + index;
-			*ret = static_cast<uint16_t>(data[offset]);
+			*ret = static_cast<GenIndex>(data[offset]);
 		}
 
 		void get_data(const MeshGenOpcode& op, int index, int* ret) const {
@@ -169,69 +197,70 @@ namespace ds {
 		~MeshGen();
 		void build(Mesh* mesh);
 		int num_faces() const;
-		const Face& get_face(uint16_t face_index) const;
-		uint16_t get_edge(uint16_t face_index, uint16_t edge_offset);
+		const Face& get_face(GenIndex face_index) const;
+		GenIndex get_edge(GenIndex face_index, GenIndex edge_offset);
 		void get_vertices(const Face& face,v3* ret) const;
-		uint16_t add_cube(const v3& position, const v3& size, uint16_t* faces = 0);
-		uint16_t add_cube(const v3& position, const v3& size, const Color& c, uint16_t* faces = 0);
-		uint16_t add_cube(const v3& position, const v3& size, const v3& rotation);
-		void set_color(uint16_t faceIndex, const Color& color);
+		GenIndex add_cube(const v3& position, const v3& size, GenIndex* faces = 0);
+		GenIndex add_cube(const v3& position, const v3& size, const Color& c, GenIndex* faces = 0);
+		GenIndex add_cube(const v3& position, const v3& size, const v3& rotation);
+		void set_color(GenIndex faceIndex, const Color& color);
 		void set_color(const Color& color);
-		uint16_t add_face(v3* positions);
-		uint16_t add_face(const v3& p0, const v3& p1, const v3& p2, const v3& p3);
+		GenIndex add_face(v3* positions);
+		GenIndex add_face(const v3& p0, const v3& p1, const v3& p2, const v3& p3);
 		void add_face(const v3& position, const v2& size, const v3& normal);
-		int join_faces(uint16_t first_face, uint16_t second_face);
-		void subdivide(uint16_t face_index);
-		void move_vertex(uint16_t vert_index, const v3& position);
-		void move_edge(uint16_t edgeIndex, const v3& position);
-		void move_face(uint16_t faceIndex, const v3& position);
-		void texture_face(uint16_t faceIndex, const Texture& t);
-		void scale_face(uint16_t faceIndex, float scale);
-		void expand_face(uint16_t center_face, uint16_t* adjacents, float w,float h);
-		v3 get_center(uint16_t faceIndex);
-		int slice(uint16_t face_index, int segments, uint16_t* faces = 0, int max = 0);
-		int slice(uint16_t face_index, int stepsX, int stepsY, uint16_t* faces = 0, int max = 0);
-		uint16_t hsplit_edge(uint16_t edgeIndex, float factor = 0.5f);
-		uint16_t vsplit_edge(uint16_t edgeIndex, float factor = 0.5f);
-		uint16_t get_edge_index(uint16_t faceIndex, int nr);
-		uint16_t make_face(uint16_t* edges);
-		uint16_t combine_edges(uint16_t edge0, uint16_t edge1);
-		uint16_t extrude_edge(uint16_t edgeIndex, const v3& pos);
-		uint16_t extrude_edge(uint16_t edgeIndex, float factor);
-		uint16_t extrude_face(uint16_t faceIndex,float factor, uint16_t* faces = 0);
-		void remove_face(uint16_t face_index);
+		int join_faces(GenIndex first_face, GenIndex second_face);
+		void subdivide(GenIndex face_index);
+		void move_vertex(GenIndex vert_index, const v3& position);
+		void move_edge(GenIndex edgeIndex, const v3& position);
+		void move_face(GenIndex faceIndex, const v3& position);
+		void texture_face(GenIndex faceIndex, const Texture& t);
+		void scale_face(GenIndex faceIndex, float scale);
+		void expand_face(GenIndex center_face, GenIndex* adjacents, float w,float h);
+		v3 get_center(GenIndex faceIndex);
+		int slice(GenIndex face_index, int segments, GenIndex* faces = 0, int max = 0);
+		int slice(GenIndex face_index, int stepsX, int stepsY, GenIndex* faces = 0, int max = 0);
+		GenIndex hsplit_edge(GenIndex edgeIndex, float factor = 0.5f);
+		GenIndex vsplit_edge(GenIndex edgeIndex, float factor = 0.5f);
+		GenIndex get_edge_index(GenIndex faceIndex, int nr);
+		GenIndex make_face(GenIndex* edges);
+		GenIndex combine_edges(GenIndex edge0, GenIndex edge1);
+		GenIndex extrude_edge(GenIndex edgeIndex, const v3& pos);
+		GenIndex extrude_edge(GenIndex edgeIndex, float factor);
+		GenIndex extrude_face(GenIndex faceIndex,float factor, GenIndex* faces = 0);
+		void remove_face(GenIndex face_index);
 		void cut(const v3& p, const v3& n, bool fill = true);
-		const Color& get_color(uint16_t face_index) const;
+		const Color& get_color(GenIndex face_index) const;
 		void debug();
 		void recalculate_normals();
 		// objects
-		void create_ring(float radius, float width, uint16_t segments);
+		void create_ring(float radius, float width, GenIndex segments);
 		void create_hexagon(float radius);
-		void create_cylinder(const v3& pos, float bottomRadius, float topRadius, float height, uint16_t segments,float startAngle = 0.0f);
-		void create_tube(const v3& pos, float bottomRadius, float topRadius, float height, float width, uint16_t segments);
-		uint16_t create_torus(const v3& position,float radius, float width, float depth, uint16_t segments);
+		void create_cylinder(const v3& pos, float bottomRadius, float topRadius, float height, GenIndex segments,float startAngle = 0.0f);
+		void create_tube(const v3& pos, float bottomRadius, float topRadius, float height, float width, GenIndex segments);
+		GenIndex create_torus(const v3& position,float radius, float width, float depth, GenIndex segments);
 		void create_grid(const v2& size, int stepsX, int stepsY);
 		void create_sphere(const v3& pos, float radius, int segments, int stacks);
 		
-		void debug_edge(uint16_t edgeIndex);
-		void debug_face(uint16_t faceIndex);
+		void debug_edge(GenIndex edgeIndex);
+		void debug_face(GenIndex faceIndex);
+		int verify_index(int samples);
 		int intersects(const ds::Ray& ray);
 		void clear();		
-		int get_connected_faces(uint16_t face_index, uint16_t* ret, int max);
-		int get_connected_edges(uint16_t edge_index, uint16_t* ret, int max);
+		int get_connected_faces(GenIndex face_index, GenIndex* ret, int max);
+		int get_connected_edges(GenIndex edge_index, GenIndex* ret, int max);
 		void translate(const v3& position);
 		void scale(const v3& scale);
 		void rotate(const v3& rotation);
 		void transform(const v3& position, const v3& scale, const v3& rotation);
 		void add(const MeshGen& other, const v3& position,const v3& scale = v3(1,1,1),const v3& rotation = v3(0,0,0));
-		void find_adjacent_faces(uint16_t face_index, IndexList& list);
+		void find_adjacent_faces(GenIndex face_index, IndexList& list);
 		void smooth(const IndexList& list, float radius);
 		void debug_colors();
 		// selection
-		bool select_face(uint16_t face_index);
-		bool select_ring(uint16_t face_index, int direction);
+		bool select_face(GenIndex face_index);
+		bool select_ring(GenIndex face_index, int direction);
 		void clear_selection();
-		void show_edges(uint16_t face_index);
+		void show_edges(GenIndex face_index);
 		void set_color_selection(const Color& color);
 
 		int startGroup();
@@ -245,7 +274,7 @@ namespace ds {
 		void save_mesh(const char* fileName);
 		void load_text(const char* fileName);
 	private:
-		int is_edge_below(uint16_t edge_index, const Plane& pl);
+		int is_edge_below(GenIndex edge_index, const Plane& pl);
 		void executeOpcodes(const Array<MeshGenOpcode>& opcodes, const DataStore& store);
 		// recording
 		void record(const MeshGenOpcode& opcode);
@@ -253,10 +282,14 @@ namespace ds {
 		MeshGen(const MeshGen& other) {}
 		void calculate_normal(Face* f);
 		int add_vertex(const v3& pos);
-		int find_edges(const v3& pos, uint16_t* ret, int max);
-		int find_vertices(const v3& pos, uint16_t* ret, int max);
+		void set_vertex(GenIndex vert_index, const v3& pos);
+		void index_edge(GenIndex edge_index);
+		void unindex_edge(GenIndex edge_index);
+		void rebuild_index();
+		int find_edges(const v3& pos, GenIndex* ret, int max);
+		int find_vertices(const v3& pos, GenIndex* ret, int max);
 		int find_edge(const v3& start, const v3& end);
-		bool find_connection(uint16_t first_face, uint16_t second_face, uint16_t* edges);
+		bool find_connection(GenIndex first_face, GenIndex second_face, GenIndex* edges);
 		Array<v3> _vertices;
 		Array<Edge> _edges;
 		Array<Face> _faces;
@@ -266,6 +299,7 @@ namespace ds {
 		Color _selectedColor;
 		int _currentGroup;
 		int _groupCounter;
+		MeshGenIndex* _index;
 	};
 
 	typedef void(*MeshGenFunc)(MeshGen*, const MeshGenOpcode&, const DataStore&);
@@ -18,7 +18,7 @@ namespace ds {
 			ds::gen::MeshGen* gen;
 			ds::Mesh* mesh;
 			GenSelectionType selectionType;
-			ds::Array<uint16_t> selections;
+			ds::Array<GenIndex> selections;
 			ds::Array<float> data;
 		};
 
@@ -11,8 +11,10 @@ namespace ds {
 		Bitmapfont();
 		~Bitmapfont();
 		void add(int ascii, const Rect& r, float xOffset = 0.0f, float yOffset = 0.0f, float textureSize = 1024.0f);
+		// direct table lookup - chars above 127 must not index
+		// outside of the table when passed as signed char
 		const Texture& get(int ascii) const {
-			return _textures[ascii];
+			return _textures[ascii & 0xFF];
 		}
 	private:
 		Texture _textures[256];
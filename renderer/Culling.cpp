@@ -0,0 +1,267 @@
+#include "Culling.h"
+#include "graphics.h"
+#include <xmmintrin.h>
+#include <math.h>
+
+namespace ds {
+
+	namespace culling {
+
+		// number of entries gathered before running the SIMD test
+		const uint32_t CULL_BATCH_SIZE = 64;
+
+		// ------------------------------------------------------------------
+		// SoA batch of sprite bounds
+		// ------------------------------------------------------------------
+		struct CullBatch {
+			__declspec(align(16)) float px[CULL_BATCH_SIZE];
+			__declspec(align(16)) float py[CULL_BATCH_SIZE];
+			__declspec(align(16)) float hx[CULL_BATCH_SIZE];
+			__declspec(align(16)) float hy[CULL_BATCH_SIZE];
+			uint32_t indices[CULL_BATCH_SIZE];
+			uint32_t num;
+
+			CullBatch() : num(0) {}
+
+			void add(uint32_t index, float x, float y, const v2& h) {
+				px[num] = x;
+				py[num] = y;
+				hx[num] = h.x;
+				hy[num] = h.y;
+				indices[num] = index;
+				++num;
+			}
+		};
+
+		// ------------------------------------------------------------------
+		// test 4 sprites per step and append the visible ones
+		// ------------------------------------------------------------------
+		static uint32_t testBatch(const VisibleArea& area, CullBatch& batch, uint32_t* visible) {
+			uint32_t cnt = 0;
+			// pad the batch so that we can always process 4 entries
+			while (batch.num % 4 != 0) {
+				batch.add(UINT32_MAX, area.min.x - 1.0f, area.min.y - 1.0f, v2(0.0f, 0.0f));
+			}
+			__m128 minX = _mm_set1_ps(area.min.x);
+			__m128 minY = _mm_set1_ps(area.min.y);
+			__m128 maxX = _mm_set1_ps(area.max.x);
+			__m128 maxY = _mm_set1_ps(area.max.y);
+			for (uint32_t i = 0; i < batch.num; i += 4) {
+				__m128 px = _mm_load_ps(batch.px + i);
+				__m128 py = _mm_load_ps(batch.py + i);
+				__m128 hx = _mm_load_ps(batch.hx + i);
+				__m128 hy = _mm_load_ps(batch.hy + i);
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(px, hx), minX), _mm_cmple_ps(_mm_sub_ps(px, hx), maxX));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(py, hy), minY));
+				inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(py, hy), maxY));
+				int mask = _mm_movemask_ps(inside);
+				for (int j = 0; j < 4; ++j) {
+					if (mask & (1 << j)) {
+						visible[cnt++] = batch.indices[i + j];
+					}
+				}
+			}
+			batch.num = 0;
+			return cnt;
+		}
+
+		// ------------------------------------------------------------------
+		// get visible area of the selected viewport
+		// ------------------------------------------------------------------
+		VisibleArea getVisibleArea() {
+			const Viewport& vp = graphics::getSelectedViewport();
+			return VisibleArea(vp.getPosition(), vp.getScreenSize());
+		}
+
+		// ------------------------------------------------------------------
+		// get half extent
+		// ------------------------------------------------------------------
+		v2 getHalfExtent(const Texture& texture, const v2& scale, float rotation) {
+			float hx = fabs(texture.dim.x * scale.x) * 0.5f;
+			float hy = fabs(texture.dim.y * scale.y) * 0.5f;
+			if (rotation != 0.0f) {
+				float c = fabs(cos(rotation));
+				float s = fabs(sin(rotation));
+				return v2(c * hx + s * hy, s * hx + c * hy);
+			}
+			return v2(hx, hy);
+		}
+
+		// ------------------------------------------------------------------
+		// is visible
+		// ------------------------------------------------------------------
+		bool isVisible(const VisibleArea& area, const v2& position, const Texture& texture, const v2& scale, float rotation) {
+			v2 h = getHalfExtent(texture, scale, rotation);
+			if (position.x + h.x < area.min.x || position.x - h.x > area.max.x) {
+				return false;
+			}
+			if (position.y + h.y < area.min.y || position.y - h.y > area.max.y) {
+				return false;
+			}
+			return true;
+		}
+
+		// ------------------------------------------------------------------
+		// cull EntityArray columns
+		// ------------------------------------------------------------------
+		uint32_t cullSprites(const VisibleArea& area, const v3* positions, const v3* scales, const v3* rotations, const Texture* textures, const bool* active, uint32_t num, uint32_t* visible, uint32_t* tested) {
+			CullBatch batch;
+			uint32_t cnt = 0;
+			uint32_t total = 0;
+			for (uint32_t i = 0; i < num; ++i) {
+				if (active == 0 || active[i]) {
+					batch.add(i, positions[i].x, positions[i].y, getHalfExtent(textures[i], scales[i].xy(), rotations[i].z));
+					++total;
+					if (batch.num == CULL_BATCH_SIZE) {
+						cnt += testBatch(area, batch, visible + cnt);
+					}
+				}
+			}
+			if (batch.num > 0) {
+				cnt += testBatch(area, batch, visible + cnt);
+			}
+			if (tested != 0) {
+				*tested = total;
+			}
+			return cnt;
+		}
+
+		// ------------------------------------------------------------------
+		// cull SpriteArray columns
+		// ------------------------------------------------------------------
+		uint32_t cullSprites(const VisibleArea& area, const v2* positions, const v2* scales, const float* rotations, const Texture* textures, uint32_t num, uint32_t* visible) {
+			CullBatch batch;
+			uint32_t cnt = 0;
+			for (uint32_t i = 0; i < num; ++i) {
+				batch.add(i, positions[i].x, positions[i].y, getHalfExtent(textures[i], scales[i], rotations[i]));
+				if (batch.num == CULL_BATCH_SIZE) {
+					cnt += testBatch(area, batch, visible + cnt);
+				}
+			}
+			if (batch.num > 0) {
+				cnt += testBatch(area, batch, visible + cnt);
+			}
+			return cnt;
+		}
+
+		// ------------------------------------------------------------------
+		// SoA batch of box bounds
+		// ------------------------------------------------------------------
+		struct BoxBatch {
+			__declspec(align(16)) float cx[CULL_BATCH_SIZE];
+			__declspec(align(16)) float cy[CULL_BATCH_SIZE];
+			__declspec(align(16)) float cz[CULL_BATCH_SIZE];
+			__declspec(align(16)) float ex[CULL_BATCH_SIZE];
+			__declspec(align(16)) float ey[CULL_BATCH_SIZE];
+			__declspec(align(16)) float ez[CULL_BATCH_SIZE];
+			uint32_t indices[CULL_BATCH_SIZE];
+			uint32_t num;
+
+			BoxBatch() : num(0) {}
+
+			void add(uint32_t index, const v3& c, const v3& e) {
+				cx[num] = c.x;
+				cy[num] = c.y;
+				cz[num] = c.z;
+				ex[num] = e.x;
+				ey[num] = e.y;
+				ez[num] = e.z;
+				indices[num] = index;
+				++num;
+			}
+		};
+
+		// ------------------------------------------------------------------
+		// test 4 boxes per step against all planes. A box is outside if
+		// the corner nearest to the plane normal is behind any plane.
+		// ------------------------------------------------------------------
+		static uint32_t testBoxBatch(const Frustum& frustum, BoxBatch& batch, uint32_t* visible) {
+			uint32_t cnt = 0;
+			uint32_t num = batch.num;
+			// padding is ignored below
+			while (batch.num % 4 != 0) {
+				batch.add(UINT32_MAX, v3(0.0f, 0.0f, 0.0f), v3(0.0f, 0.0f, 0.0f));
+			}
+			for (uint32_t i = 0; i < batch.num; i += 4) {
+				__m128 cx = _mm_load_ps(batch.cx + i);
+				__m128 cy = _mm_load_ps(batch.cy + i);
+				__m128 cz = _mm_load_ps(batch.cz + i);
+				__m128 ex = _mm_load_ps(batch.ex + i);
+				__m128 ey = _mm_load_ps(batch.ey + i);
+				__m128 ez = _mm_load_ps(batch.ez + i);
+				__m128 inside = _mm_cmpeq_ps(cx, cx);
+				for (int p = 0; p < 6; ++p) {
+					__m128 a = _mm_set1_ps(frustum.a[p]);
+					__m128 b = _mm_set1_ps(frustum.b[p]);
+					__m128 c = _mm_set1_ps(frustum.c[p]);
+					__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, cx), _mm_mul_ps(b, cy)), _mm_add_ps(_mm_mul_ps(c, cz), _mm_set1_ps(frustum.d[p])));
+					__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabs(frustum.a[p])), ex), _mm_mul_ps(_mm_set1_ps(fabs(frustum.b[p])), ey)), _mm_mul_ps(_mm_set1_ps(fabs(frustum.c[p])), ez));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+				}
+				int mask = _mm_movemask_ps(inside);
+				for (int j = 0; j < 4; ++j) {
+					if ((mask & (1 << j)) && i + j < num) {
+						visible[cnt++] = batch.indices[i + j];
+					}
+				}
+			}
+			batch.num = 0;
+			return cnt;
+		}
+
+		// ------------------------------------------------------------------
+		// extract frustum planes - row vectors so clip = v * M and the
+		// planes are built from the columns of the matrix
+		// ------------------------------------------------------------------
+		static void setPlane(Frustum* frustum, int index, float a, float b, float c, float d) {
+			frustum->a[index] = a;
+			frustum->b[index] = b;
+			frustum->c[index] = c;
+			frustum->d[index] = d;
+		}
+
+		void extractFrustum(const mat4& m, Frustum* frustum) {
+			setPlane(frustum, 0, m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41);
+			setPlane(frustum, 1, m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41);
+			setPlane(frustum, 2, m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42);
+			setPlane(frustum, 3, m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42);
+			// D3D clip space has 0 <= z <= w
+			setPlane(frustum, 4, m._13, m._23, m._33, m._43);
+			setPlane(frustum, 5, m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43);
+		}
+
+		// ------------------------------------------------------------------
+		// is visible
+		// ------------------------------------------------------------------
+		bool isVisible(const Frustum& frustum, const v3& center, const v3& extent) {
+			for (int p = 0; p < 6; ++p) {
+				float dist = frustum.a[p] * center.x + frustum.b[p] * center.y + frustum.c[p] * center.z + frustum.d[p];
+				float radius = fabs(frustum.a[p]) * extent.x + fabs(frustum.b[p]) * extent.y + fabs(frustum.c[p]) * extent.z;
+				if (dist + radius < 0.0f) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// ------------------------------------------------------------------
+		// cull boxes
+		// ------------------------------------------------------------------
+		uint32_t cullBoxes(const Frustum& frustum, const v3* centers, const v3* extents, uint32_t num, uint32_t* visible) {
+			BoxBatch batch;
+			uint32_t cnt = 0;
+			for (uint32_t i = 0; i < num; ++i) {
+				batch.add(i, centers[i], extents[i]);
+				if (batch.num == CULL_BATCH_SIZE) {
+					cnt += testBoxBatch(frustum, batch, visible + cnt);
+				}
+			}
+			if (batch.num > 0) {
+				cnt += testBoxBatch(frustum, batch, visible + cnt);
+			}
+			return cnt;
+		}
+
+	}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <stdint.h>
+#include <Vector.h>
+#include "core\graphics\Texture.h"
+#include "core\math\matrix.h"
+
+namespace ds {
+
+	namespace culling {
+
+		// ------------------------------------------------------------------
+		// world space area covered by the sprite camera
+		// ------------------------------------------------------------------
+		struct VisibleArea {
+			v2 min;
+			v2 max;
+
+			VisibleArea() : min(0, 0), max(0, 0) {}
+			VisibleArea(const v2& center, const v2& size) : min(center - size * 0.5f), max(center + size * 0.5f) {}
+		};
+
+		// ------------------------------------------------------------------
+		// returns the area of the currently selected viewport
+		// ------------------------------------------------------------------
+		VisibleArea getVisibleArea();
+
+		// ------------------------------------------------------------------
+		// half size of a sprite - rotated sprites use the AABB of the
+		// rotated rectangle
+		// ------------------------------------------------------------------
+		v2 getHalfExtent(const Texture& texture, const v2& scale, float rotation);
+
+		bool isVisible(const VisibleArea& area, const v2& position, const Texture& texture, const v2& scale, float rotation);
+
+		// ------------------------------------------------------------------
+		// tests a column range of sprites against the visible area and
+		// writes the indices of all visible entries into visible.
+		// Entries with active[i] == false are skipped (active may be 0).
+		// Returns the number of visible entries and stores the number of
+		// tested entries in tested if given.
+		// ------------------------------------------------------------------
+		uint32_t cullSprites(const VisibleArea& area, const v3* positions, const v3* scales, const v3* rotations, const Texture* textures, const bool* active, uint32_t num, uint32_t* visible, uint32_t* tested = 0);
+
+		uint32_t cullSprites(const VisibleArea& area, const v2* positions, const v2* scales, const float* rotations, const Texture* textures, uint32_t num, uint32_t* visible);
+
+		// ------------------------------------------------------------------
+		// the six planes (left, right, bottom, top, near, far) of a view
+		// projection matrix stored as SoA. Planes point inwards and are
+		// not normalized.
+		// ------------------------------------------------------------------
+		struct Frustum {
+			float a[6];
+			float b[6];
+			float c[6];
+			float d[6];
+		};
+
+		void extractFrustum(const mat4& viewProjection, Frustum* frustum);
+
+		bool isVisible(const Frustum& frustum, const v3& center, const v3& extent);
+
+		// ------------------------------------------------------------------
+		// tests num AABBs given as center and half extent against the
+		// frustum and writes the indices of the visible ones into visible.
+		// Returns the number of visible boxes.
+		// ------------------------------------------------------------------
+		uint32_t cullBoxes(const Frustum& frustum, const v3* centers, const v3* extents, uint32_t num, uint32_t* visible);
+
+	}
+
+}
@@ -0,0 +1,48 @@
+#include "IndexedMesh.h"
+#include "MeshBuffer.h"
+#include "VertexCache.h"
+#include "core\log\Log.h"
+#include "core\profiler\Profiler.h"
+
+namespace ds {
+
+	void buildIndexedMesh(const Mesh* mesh, IndexedMesh* out) {
+		ZoneTracker z("buildIndexedMesh");
+		out->clear();
+		out->boundingBox = mesh->boundingBox;
+		uint32_t num = mesh->vertices.size();
+		if (num < 4) {
+			return;
+		}
+		uint32_t* remap = (uint32_t*)ALLOC(num * 2 * sizeof(uint32_t));
+		uint32_t* unique = remap + num;
+		uint32_t numUnique = vcache::weldVertices(&mesh->vertices[0], num, sizeof(PNTCVertex), remap, unique);
+		// same triangles as the quad index buffer
+		for (uint32_t i = 0; i + 3 < num; i += 4) {
+			out->indices.push_back(remap[i]);
+			out->indices.push_back(remap[i + 1]);
+			out->indices.push_back(remap[i + 3]);
+			out->indices.push_back(remap[i + 1]);
+			out->indices.push_back(remap[i + 2]);
+			out->indices.push_back(remap[i + 3]);
+		}
+		uint32_t numIndices = out->indices.size();
+		vcache::optimizeVertexCache(out->indices.data(), numIndices, numUnique);
+		// order holds the new position of every welded vertex
+		uint32_t* order = remap;
+		uint32_t used = vcache::optimizeVertexFetch(out->indices.data(), numIndices, numUnique, order);
+		uint32_t* source = (uint32_t*)ALLOC(used * sizeof(uint32_t));
+		for (uint32_t i = 0; i < numUnique; ++i) {
+			if (order[i] != UINT32_MAX) {
+				source[order[i]] = unique[i];
+			}
+		}
+		for (uint32_t i = 0; i < used; ++i) {
+			out->vertices.push_back(mesh->vertices[source[i]]);
+		}
+		DEALLOC(source);
+		DEALLOC(remap);
+		LOG << "indexed mesh - vertices: " << num << " -> " << used << " ACMR: " << vcache::computeACMR(out->indices.data(), numIndices, vcache::CACHE_SIZE);
+	}
+
+}
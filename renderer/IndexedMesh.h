@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include "core\lib\collection_types.h"
+#include "core\math\AABBox.h"
+#include "VertexTypes.h"
+
+namespace ds {
+
+	struct Mesh;
+
+	// ------------------------------------------------------
+	// indexed triangle list built from the quads of a Mesh
+	// ------------------------------------------------------
+	struct IndexedMesh {
+
+		AABBox boundingBox;
+		Array<PNTCVertex> vertices;
+		Array<uint32_t> indices;
+
+		void clear() {
+			vertices.clear();
+			indices.clear();
+		}
+	};
+
+	// ------------------------------------------------------
+	// welds identical vertices, orders the triangles for the
+	// post transform cache and the vertices by first use
+	// ------------------------------------------------------
+	void buildIndexedMesh(const Mesh* mesh, IndexedMesh* out);
+
+}
@@ -0,0 +1,62 @@
+#include "InstanceBatch.h"
+#include "core\profiler\Profiler.h"
+#include <algorithm>
+
+namespace ds {
+
+	// material first since switching it is more expensive
+	static bool sortInstances(const InstanceSortEntry& a, const InstanceSortEntry& b) {
+		if (a.material != b.material) {
+			return a.material < b.material;
+		}
+		if (a.mesh != b.mesh) {
+			return a.mesh < b.mesh;
+		}
+		return a.index < b.index;
+	}
+
+	void InstanceBatch::clear() {
+		_entries.clear();
+		_instances.clear();
+		_groups.clear();
+	}
+
+	void InstanceBatch::add(Mesh* mesh, RID material, uint32_t index) {
+		InstanceSortEntry e;
+		e.mesh = mesh;
+		e.material = material;
+		e.index = index;
+		_entries.push_back(e);
+	}
+
+	// ------------------------------------------------------
+	// sort the entries and pack the instance data so that
+	// every group is a contiguous range
+	// ------------------------------------------------------
+	void InstanceBatch::build(const mat4* worlds, const Color* colors) {
+		ZoneTracker z("InstanceBatch::build");
+		_instances.clear();
+		_groups.clear();
+		if (_entries.empty()) {
+			return;
+		}
+		std::sort(_entries.data(), _entries.data() + _entries.size(), sortInstances);
+		for (uint32_t i = 0; i < _entries.size(); ++i) {
+			const InstanceSortEntry& e = _entries[i];
+			if (_groups.empty() || _groups.back().mesh != e.mesh || _groups.back().material != e.material) {
+				InstanceGroup group;
+				group.mesh = e.mesh;
+				group.material = e.material;
+				group.first = _instances.size();
+				group.num = 0;
+				_groups.push_back(group);
+			}
+			InstanceData data;
+			data.world = worlds[e.index];
+			data.color = colors[e.index];
+			_instances.push_back(data);
+			++_groups.back().num;
+		}
+	}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include "core\Common.h"
+#include "core\math\matrix.h"
+#include "core\graphics\Color.h"
+#include "core\lib\collection_types.h"
+
+namespace ds {
+
+	struct Mesh;
+
+	// -------------------------------------------------------
+	// per instance data - matches the WORLD (4 rows) and
+	// INSTANCECOLOR elements of the instance input layout
+	// -------------------------------------------------------
+	struct InstanceData {
+		mat4 world;
+		Color color;
+	};
+
+	// -------------------------------------------------------
+	// consecutive instances sharing mesh and material
+	// -------------------------------------------------------
+	struct InstanceGroup {
+		Mesh* mesh;
+		RID material;
+		uint32_t first;
+		uint32_t num;
+	};
+
+	struct InstanceSortEntry {
+		Mesh* mesh;
+		RID material;
+		uint32_t index;
+	};
+
+	// -------------------------------------------------------
+	// Collects entities, sorts them by material and mesh and
+	// packs the instance data group by group. Does not depend
+	// on the device so it can be used without a window.
+	// -------------------------------------------------------
+	class InstanceBatch {
+
+	public:
+		InstanceBatch() {}
+		~InstanceBatch() {}
+		void clear();
+		// index is the position in the worlds/colors columns passed to build
+		void add(Mesh* mesh, RID material, uint32_t index);
+		void build(const mat4* worlds, const Color* colors);
+		uint32_t numGroups() const {
+			return _groups.size();
+		}
+		const InstanceGroup& getGroup(uint32_t idx) const {
+			return _groups[idx];
+		}
+		uint32_t numInstances() const {
+			return _instances.size();
+		}
+		const InstanceData* getInstances() const {
+			return _instances.data();
+		}
+	private:
+		Array<InstanceSortEntry> _entries;
+		Array<InstanceData> _instances;
+		Array<InstanceGroup> _groups;
+	};
+
+}
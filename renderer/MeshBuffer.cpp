@@ -5,47 +5,114 @@
 #include "..\resources\ResourceDescriptors.h"
 #include "..\resources\ResourceContainer.h"
 #include "core\log\Log.h"
+#include "core\base\Assert.h"
 #include "core\profiler\Profiler.h"
-#include "core\io\BinaryFile.h"
 #include "..\stats\DrawCounter.h"
+#include "Transform.h"
+#include "VertexTransform.h"
+#include "VertexPacking.h"
+#include "MeshLOD.h"
+#include "..\utils\JobSystem.h"
+#include <algorithm>
 
 namespace ds {
 
+	// mesh files store the vertices as they are in memory
+	static_assert(sizeof(PNTCVertex) == 12 * sizeof(float), "PNTCVertex must be 12 floats");
+
+	Mesh::~Mesh() {
+		lod::release(this);
+	}
+
+	// ------------------------------------------------------
+	// read mesh file - the vertices are read with one fread
+	// ------------------------------------------------------
+	void readMeshFile(const char* path, MeshFile* file) {
+		file->found = false;
+		file->hasHeader = false;
+		file->expected = 0;
+		file->vertices.clear();
+		FILE* f = fopen(path, "rb");
+		if (f == 0) {
+			return;
+		}
+		file->found = true;
+		fseek(f, 0, SEEK_END);
+		long length = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		long start = sizeof(MeshFileHeader);
+		uint32_t size = 0;
+		if (fread(&file->header, sizeof(MeshFileHeader), 1, f) == 1 && file->header.magic == MESH_FILE_MAGIC) {
+			size = file->header.numVertices;
+			file->hasHeader = true;
+		}
+		else {
+			// old format
+			fseek(f, 0, SEEK_SET);
+			start = sizeof(uint32_t);
+			if (fread(&size, sizeof(uint32_t), 1, f) != 1) {
+				size = 0;
+			}
+		}
+		file->expected = size;
+		if (size > 0 && file->supported()) {
+			// a broken count must not allocate more than the file holds
+			uint32_t available = length > start ? (uint32_t)((length - start) / sizeof(PNTCVertex)) : 0;
+			if (size > available) {
+				size = available;
+			}
+			if (size > 0) {
+				file->vertices.resize(size);
+				uint32_t read = fread(&file->vertices[0], sizeof(PNTCVertex), size, f);
+				file->vertices.resize(read);
+			}
+		}
+		fclose(f);
+	}
+
+	// ------------------------------------------------------
+	// assign mesh file
+	// ------------------------------------------------------
+	bool assignMeshFile(Mesh* mesh, const MeshFile& file, const char* name, const v3& offset) {
+		if (!file.found) {
+			return false;
+		}
+		if (!file.supported()) {
+			LOGE << "mesh '" << name << "' has unsupported version " << file.header.version;
+			return false;
+		}
+		uint32_t read = file.vertices.size();
+		if (read != file.expected) {
+			LOGE << "mesh '" << name << "' is truncated - expected: " << file.expected << " found: " << read;
+		}
+		PNTCVertex* dest = mesh->append(read);
+		for (uint32_t i = 0; i < read; ++i) {
+			dest[i] = file.vertices[i];
+			dest[i].position += offset;
+		}
+		if (read > 0) {
+			if (file.hasHeader && read == file.expected) {
+				mesh->boundingBox.position = (file.header.min + file.header.max) * 0.5f + offset;
+				mesh->boundingBox.extent = (file.header.max - file.header.min) * 0.5f;
+			}
+			else {
+				mesh->buildBoundingBox();
+			}
+		}
+		LOG << "mesh '" << name << "' loaded - entries: " << read;
+		return true;
+	}
+
 	// ------------------------------------------------------
 	// Mesh - load
 	// ------------------------------------------------------
 	void Mesh::load(const char* fileName, const v3& offset) {
+		ZoneTracker z("Mesh::load");
 		char buffer[256];
 		sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
-		FILE* f = fopen(buffer, "rb");
-		if (f) {
-			int size = -1;
-			fread(&size, sizeof(uint32_t), 1, f);
-			for (int i = 0; i < size; ++i) {
-				v3 p;
-				for (int k = 0; k < 3; ++k) {
-					fread(&p.data[k], sizeof(float), 1, f);
-				}
-				p += offset;
-				v3 n;
-				for (int k = 0; k < 3; ++k) {
-					fread(&n.data[k], sizeof(float), 1, f);
-				}
-				v2 uv;
-				for (int k = 0; k < 2; ++k) {
-					fread(&uv.data[k], sizeof(float), 1, f);
-				}
-				Color color;
-				fread(&color.r, sizeof(float), 1, f);
-				fread(&color.g, sizeof(float), 1, f);
-				fread(&color.b, sizeof(float), 1, f);
-				fread(&color.a, sizeof(float), 1, f);
-				add(p, n, uv, color);
-			}
-			fclose(f);
-			LOG << "mesh '" << fileName << "' loaded - entries: " << vertices.size();
-			buildBoundingBox();			
-		}
+		MeshFile file;
+		readMeshFile(buffer, &file);
+		assignMeshFile(this, file, fileName, offset);
 	}
 
 	// ------------------------------------------------------
@@ -54,16 +121,21 @@ namespace ds {
 	void Mesh::save(const char* fileName) {
 		char buffer[256];
 		sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
-		BinaryFile bf;
-		if (bf.open(buffer, FileMode::WRITE)) {
-			bf.write(vertices.size());
-			for (uint32_t i = 0; i < vertices.size(); ++i) {
-				const PNTCVertex& v = vertices[i];
-				bf.write(v.position);
-				bf.write(v.normal);
-				bf.write(v.texture);
-				bf.write(v.color);
+		FILE* f = fopen(buffer, "wb");
+		if (f) {
+			MeshFileHeader header;
+			header.magic = MESH_FILE_MAGIC;
+			header.version = MESH_FILE_VERSION;
+			header.numVertices = vertices.size();
+			header.flags = 0;
+			header.min = v3(0, 0, 0);
+			header.max = v3(0, 0, 0);
+			if (vertices.size() > 0) {
+				vertex::bounds(vertices.data(), vertices.size(), &header.min, &header.max);
 			}
+			fwrite(&header, sizeof(MeshFileHeader), 1, f);
+			fwrite(vertices.data(), sizeof(PNTCVertex), vertices.size(), f);
+			fclose(f);
 		}
 	}
 	
@@ -72,13 +144,9 @@ namespace ds {
 	// ------------------------------------------------------
 	void Mesh::buildBoundingBox() {
 		if (vertices.size() > 0) {
-			v3 min_p = v3(10000.0f);
-			v3 max_p = v3(0.0f);
-			v3 e = v3(0, 0, 0);
-			for (uint32_t i = 0; i < vertices.size(); ++i) {
-				min_p = math::min_val(min_p, vertices[i].position);
-				max_p = math::max_val(max_p, vertices[i].position);
-			}
+			v3 min_p;
+			v3 max_p;
+			vertex::bounds(vertices.data(), vertices.size(), &min_p, &max_p);
 			boundingBox.position = (min_p + max_p) * 0.5f;
 			boundingBox.extent = (max_p - min_p) * 0.5f;
 		}
@@ -97,10 +165,41 @@ namespace ds {
 		_buffer.diffuseColor = _diffuseColor;
 		_buffer.lightPos = _lightPos;
 		_vertices = new PNTCVertex[_size];
+		_packed = 0;
+		if (_descriptor.format == VF_PACKED) {
+			_packed = new PackedVertex[_size];
+		}
+		_stride = vertex::vertexSize(_descriptor.format);
+		_reserved = 0;
+		VertexBufferResource* vb = static_cast<VertexBufferResource*>(res::getResource(_descriptor.vertexBuffer, ResourceType::VERTEXBUFFER));
+		_inputLayout = vb->getInputLayout();
+		_maxInstances = 0;
+		if (_descriptor.instanceBuffer != INVALID_RID && _descriptor.instanceShader != INVALID_RID) {
+			VertexBufferResource* res = static_cast<VertexBufferResource*>(res::getResource(_descriptor.instanceBuffer, ResourceType::VERTEXBUFFER));
+			_maxInstances = res->size() / sizeof(InstanceData);
+		}
 	}
 
 	MeshBuffer::~MeshBuffer() {
 		delete[] _vertices;
+		if (_packed != 0) {
+			delete[] _packed;
+		}
+	}
+
+	// ------------------------------------------------------
+	// upload - the vertices are packed first if the buffer
+	// uses VF_PACKED
+	// ------------------------------------------------------
+	void MeshBuffer::upload(const PNTCVertex* vertices, uint32_t num) {
+		if (_descriptor.format == VF_PACKED) {
+			XASSERT(num <= _size, "Cannot pack %d vertices - MeshBuffer only supports %d", num, _size);
+			vertex::pack(vertices, _packed, num);
+			graphics::mapData(_descriptor.vertexBuffer, _packed, num * sizeof(PackedVertex));
+		}
+		else {
+			graphics::mapData(_descriptor.vertexBuffer, (void*)vertices, num * sizeof(PNTCVertex));
+		}
 	}
 
 	// ------------------------------------------------------
@@ -136,27 +235,7 @@ namespace ds {
 
 	void MeshBuffer::add(Mesh* mesh, const mat4& world, const Color& color) {
 		ZoneTracker z("MeshBuffer::addMesh4");
-		int cnt = mesh->vertices.size() / 4;
-		v3 p[4];
-		v2 t[4];
-		Color c[4];
-		for (int i = 0; i < cnt; ++i) {
-			for (int j = 0; j < 4; ++j) {
-				const PNTCVertex& v = mesh->vertices[i * 4 + j];
-				p[j] = world * v.position;
-				t[j] = v.texture;
-				c[j] = v.color;
-			}
-			v3 s = p[0];
-			v3 end1 = p[1];
-			v3 end2 = p[2];
-			v3 a = end1 - s;
-			v3 b = end2 - s;
-			v3 n = normalize(cross(a, b));
-			for (int j = 0; j < 4; ++j) {
-				add(p[j], n, t[j], c[j] * color);
-			}
-		}
+		addTransformed(mesh, world, color, true);
 	}
 
 	// ------------------------------------------------------
@@ -164,18 +243,37 @@ namespace ds {
 	// ------------------------------------------------------
 	void MeshBuffer::add(Mesh* mesh, const mat4& world, const v3& scale, const v3& rotation, const Color& color) {
 		ZoneTracker z("MeshBuffer::addMesh2");
-		mat4 rotY = matrix::mat4RotationY(rotation.y);
-		mat4 rotX = matrix::mat4RotationX(rotation.x);
-		mat4 rotZ = matrix::mat4RotationZ(rotation.z);
-		mat4 s = matrix::mat4Scale(scale);
-		mat4 w = rotZ * rotY * rotX * s * world;
-		for (uint32_t i = 0; i < mesh->vertices.size(); ++i) {
-			const PNTCVertex& v = mesh->vertices[i];
-			v3 p = w * v.position;
-			//v3 n = world * v.normal;
-			// FIXME: we need to rotate normal!!!
-			v3 n = v.normal;
-			add(p, n, v.texture, v.color * color);
+		mat4 w = transform::buildWorld(v3(0, 0, 0), scale, rotation) * world;
+		addTransformed(mesh, w, color, true);
+	}
+
+	// ------------------------------------------------------
+	// transform the mesh directly into the vertex buffer in
+	// batches of whole quads and flush whenever it is full
+	// ------------------------------------------------------
+	void MeshBuffer::addTransformed(Mesh* mesh, const mat4& world, const Color& color, bool modulate) {
+		const PNTCVertex* src = mesh->vertices.data();
+		uint32_t total = mesh->vertices.size();
+		uint32_t done = 0;
+		while (done < total) {
+			uint32_t free = (_size - _index) & ~3u;
+			if (free == 0) {
+				flush();
+				free = _size & ~3u;
+			}
+			uint32_t num = total - done;
+			if (num > free) {
+				num = free;
+			}
+			PNTCVertex* dest = _vertices + _index;
+			vertex::transform(world, src + done, dest, num, modulate ? &color : 0);
+			if (!modulate) {
+				for (uint32_t i = 0; i < num; ++i) {
+					dest[i].color = color;
+				}
+			}
+			_index += num;
+			done += num;
 		}
 	}
 
@@ -209,19 +307,77 @@ namespace ds {
 	// ------------------------------------------------------
 	void MeshBuffer::add(Mesh* mesh, const v3& position, const Color& color, const v3& scale, const v3& rotation) {
 		ZoneTracker z("MeshBuffer::addMesh1");
-		mat4 rotY = matrix::mat4RotationY(rotation.y);
-		mat4 rotX = matrix::mat4RotationX(rotation.x);
-		mat4 rotZ = matrix::mat4RotationZ(rotation.z);
-		mat4 t = matrix::mat4Transform(position);
-		mat4 s = matrix::mat4Scale(scale);
-		mat4 world = rotZ * rotY * rotX * s * t;
-		for (uint32_t i = 0; i < mesh->vertices.size(); ++i) {
-			const PNTCVertex& v = mesh->vertices[i];
-			v3 p = world * v.position;
-			//v3 n = world * v.normal;
-			v3 n = v.normal;
-			add(p, n, v.texture, color);
+		mat4 world = transform::buildWorld(position, scale, rotation);
+		addTransformed(mesh, world, color, false);
+	}
+
+	// ------------------------------------------------------
+	// reserve - phase one of the two phase submission
+	// ------------------------------------------------------
+	uint32_t MeshBuffer::reserve(Mesh* mesh, const mat4& world, const Color& color) {
+		uint32_t offset = _reserved;
+		uint32_t num = mesh->vertices.size();
+		if (num > 0) {
+			MeshSubmission submission;
+			submission.mesh = mesh;
+			submission.world = world;
+			submission.color = color;
+			submission.offset = offset;
+			_submissions.push_back(submission);
+			_reserved += num;
 		}
+		return offset;
+	}
+
+	// ------------------------------------------------------
+	// submit - the reserved ranges are cut into batches of
+	// the buffer size up front. Every batch is split into
+	// chunks of SUBMIT_CHUNK_SIZE vertices that are
+	// transformed in parallel directly into the buffer so
+	// the jobs have the same amount of work no matter how
+	// large the meshes are.
+	// ------------------------------------------------------
+	void MeshBuffer::submit() {
+		if (_reserved == 0) {
+			return;
+		}
+		ZoneTracker z("MeshBuffer::submit");
+		flush();
+		const MeshSubmission* first = _submissions.data();
+		const MeshSubmission* last = first + _submissions.size();
+		PNTCVertex* dest = _vertices;
+		uint32_t batchSize = _size & ~3u;
+		for (uint32_t batch = 0; batch < _reserved; batch += batchSize) {
+			uint32_t batchEnd = batch + batchSize;
+			if (batchEnd > _reserved) {
+				batchEnd = _reserved;
+			}
+			auto fill = [first, last, dest, batch, batchEnd](uint32_t start, uint32_t end) {
+				for (uint32_t c = start; c < end; ++c) {
+					uint32_t current = batch + c * SUBMIT_CHUNK_SIZE;
+					uint32_t chunkEnd = current + SUBMIT_CHUNK_SIZE;
+					if (chunkEnd > batchEnd) {
+						chunkEnd = batchEnd;
+					}
+					// last submission starting at or before the chunk
+					const MeshSubmission* s = std::upper_bound(first, last, current, [](uint32_t v, const MeshSubmission& sub) { return v < sub.offset; }) - 1;
+					while (current < chunkEnd) {
+						uint32_t next = s->offset + s->mesh->vertices.size();
+						if (next > chunkEnd) {
+							next = chunkEnd;
+						}
+						vertex::transform(s->world, s->mesh->vertices.data() + (current - s->offset), dest + (current - batch), next - current, &s->color);
+						current = next;
+						++s;
+					}
+				}
+			};
+			uint32_t num = batchEnd - batch;
+			jobs::parallelFor((num + SUBMIT_CHUNK_SIZE - 1) / SUBMIT_CHUNK_SIZE, 1, fill);
+			drawBatch(dest, num);
+		}
+		_submissions.clear();
+		_reserved = 0;
 	}
 
 	// ------------------------------------------------------
@@ -262,7 +418,7 @@ namespace ds {
 		mat4 rotZ = matrix::mat4RotationZ(rotation.z);
 		mat4 s = matrix::mat4Scale(scale);
 		w = rotZ * rotY * rotX * s * world;
-		unsigned int stride = sizeof(PNTCVertex);
+		unsigned int stride = _stride;
 		unsigned int offset = 0;
 
 		graphics::setVertexBuffer(_descriptor.vertexBuffer, &stride, &offset);
@@ -275,7 +431,7 @@ namespace ds {
 		_buffer.cameraPos = camera->getPosition();
 		_buffer.lightPos = _lightPos;
 		_buffer.diffuseColor = color;// Color(192, 0, 0, 255);
-		graphics::mapData(_descriptor.vertexBuffer, mesh->vertices.data(), mesh->vertices.size() * sizeof(PNTCVertex));
+		upload(mesh->vertices.data(), mesh->vertices.size());
 		graphics::updateConstantBuffer(_descriptor.constantBuffer, &_buffer, sizeof(PNTCConstantBuffer));
 		graphics::setVertexShaderConstantBuffer(_descriptor.constantBuffer);
 		//graphics::setPixelShaderConstantBuffer(_descriptor.constantBuffer);
@@ -284,39 +440,134 @@ namespace ds {
 		gDrawCounter->vertices += mesh->vertices.size();
 	}
 
+	// ------------------------------------------------------
+	// draw static - the index buffer only covers _size
+	// vertices so larger buffers are drawn in pieces
+	// ------------------------------------------------------
+	void MeshBuffer::drawStatic(ID3D11Buffer* buffer, uint32_t numVertices) {
+		if (buffer == 0 || numVertices == 0) {
+			return;
+		}
+		flush();
+		ZoneTracker z("MeshBuffer::drawStatic");
+		Camera* camera = graphics::getCamera();
+		_buffer.viewProjectionMatrix = ds::matrix::mat4Transpose(camera->getViewProjectionMatrix());
+		_buffer.worldMatrix = ds::matrix::mat4Transpose(matrix::m4identity());
+		_buffer.cameraPos = camera->getPosition();
+		_buffer.lightPos = _lightPos;
+		_buffer.diffuseColor = _diffuseColor;
+		unsigned int stride = _stride;
+		unsigned int offset = 0;
+		graphics::setVertexBuffer(buffer, _inputLayout, &stride, &offset);
+		graphics::setIndexBuffer(_descriptor.indexBuffer);
+		graphics::setMaterial(_descriptor.material);
+		graphics::updateConstantBuffer(_descriptor.constantBuffer, &_buffer, sizeof(PNTCConstantBuffer));
+		graphics::setVertexShaderConstantBuffer(_descriptor.constantBuffer);
+		uint32_t maxVertices = _size & ~3u;
+		uint32_t done = 0;
+		while (done < numVertices) {
+			uint32_t num = numVertices - done;
+			if (num > maxVertices) {
+				num = maxVertices;
+			}
+			graphics::drawIndexed(num / 4 * 6, done);
+			++gDrawCounter->flushes;
+			gDrawCounter->vertices += num;
+			done += num;
+		}
+	}
+
+	// ------------------------------------------------------
+	// draw instanced - the mesh vertices are uploaded once
+	// per group and transformed on the GPU by the instance
+	// world matrices
+	// ------------------------------------------------------
+	void MeshBuffer::drawInstanced(const InstanceBatch& batch) {
+		if (batch.numGroups() == 0) {
+			return;
+		}
+		XASSERT(supportsInstancing(), "MeshBuffer has no instance buffer and shader");
+		flush();
+		ZoneTracker z("MeshBuffer::drawInstanced");
+		Camera* camera = graphics::getCamera();
+		// the world matrix is part of the instance data
+		_buffer.viewProjectionMatrix = ds::matrix::mat4Transpose(camera->getViewProjectionMatrix());
+		_buffer.worldMatrix = ds::matrix::mat4Transpose(matrix::m4identity());
+		_buffer.cameraPos = camera->getPosition();
+		_buffer.lightPos = _lightPos;
+		_buffer.diffuseColor = _diffuseColor;
+		graphics::updateConstantBuffer(_descriptor.constantBuffer, &_buffer, sizeof(PNTCConstantBuffer));
+		graphics::setVertexShaderConstantBuffer(_descriptor.constantBuffer);
+		graphics::setIndexBuffer(_descriptor.indexBuffer);
+		unsigned int stride = _stride;
+		unsigned int instanceStride = sizeof(InstanceData);
+		unsigned int offset = 0;
+		const InstanceData* instances = batch.getInstances();
+		for (uint32_t i = 0; i < batch.numGroups(); ++i) {
+			const InstanceGroup& group = batch.getGroup(i);
+			Mesh* mesh = group.mesh;
+			uint32_t numVertices = mesh->vertices.size();
+			XASSERT(numVertices <= _size, "Mesh has %d vertices but MeshBuffer only supports %d", numVertices, _size);
+			graphics::setMaterial(group.material);
+			graphics::setShader(_descriptor.instanceShader);
+			upload(mesh->vertices.data(), numVertices);
+			graphics::setVertexBuffer(_descriptor.vertexBuffer, &stride, &offset);
+			uint32_t done = 0;
+			while (done < group.num) {
+				uint32_t num = group.num - done;
+				if (num > _maxInstances) {
+					num = _maxInstances;
+				}
+				graphics::mapData(_descriptor.instanceBuffer, (void*)(instances + group.first + done), num * sizeof(InstanceData));
+				graphics::setInstanceBuffer(_descriptor.instanceBuffer, &instanceStride, &offset);
+				graphics::drawIndexedInstanced(numVertices / 4 * 6, num);
+				++gDrawCounter->flushes;
+				gDrawCounter->vertices += numVertices * num;
+				done += num;
+			}
+		}
+	}
+
 	// ------------------------------------------------------
 	// flush
 	// ------------------------------------------------------
 	void MeshBuffer::flush() {
 		if (_index > 0) {
-			ZoneTracker("Mesh::flush");
+			drawBatch(_vertices, _index);
+			_index = 0;
+		}
+	}
 
-			mat4 world = matrix::m4identity();
-			unsigned int stride = sizeof(PNTCVertex);
-			unsigned int offset = 0;
+	// ------------------------------------------------------
+	// draw batch - vertices are already in world space
+	// ------------------------------------------------------
+	void MeshBuffer::drawBatch(const PNTCVertex* vertices, uint32_t num) {
+		ZoneTracker("Mesh::flush");
 
-			graphics::setVertexBuffer(_descriptor.vertexBuffer, &stride, &offset);
-			graphics::setIndexBuffer(_descriptor.indexBuffer);
-			graphics::setMaterial(_descriptor.material);
-
-			Camera* camera = graphics::getCamera();
-			ds::mat4 mvp = world * camera->getViewProjectionMatrix();
-			_buffer.viewProjectionMatrix = ds::matrix::mat4Transpose(mvp);
-			_buffer.worldMatrix = ds::matrix::mat4Transpose(world);
-			_buffer.cameraPos = camera->getPosition();
-			_buffer.lightPos = _lightPos;
-			_buffer.diffuseColor = _diffuseColor;
-			
-			graphics::mapData(_descriptor.vertexBuffer, _vertices, _index * sizeof(PNTCVertex));
-			
-			graphics::updateConstantBuffer(_descriptor.constantBuffer, &_buffer, sizeof(PNTCConstantBuffer));
-			graphics::setVertexShaderConstantBuffer(_descriptor.constantBuffer);
-			graphics::drawIndexed(_index / 4 * 6);
+		mat4 world = matrix::m4identity();
+		unsigned int stride = _stride;
+		unsigned int offset = 0;
 
-			++gDrawCounter->flushes;
-			gDrawCounter->vertices += _index;
-			_index = 0;			
-		}
+		graphics::setVertexBuffer(_descriptor.vertexBuffer, &stride, &offset);
+		graphics::setIndexBuffer(_descriptor.indexBuffer);
+		graphics::setMaterial(_descriptor.material);
+
+		Camera* camera = graphics::getCamera();
+		ds::mat4 mvp = world * camera->getViewProjectionMatrix();
+		_buffer.viewProjectionMatrix = ds::matrix::mat4Transpose(mvp);
+		_buffer.worldMatrix = ds::matrix::mat4Transpose(world);
+		_buffer.cameraPos = camera->getPosition();
+		_buffer.lightPos = _lightPos;
+		_buffer.diffuseColor = _diffuseColor;
+
+		upload(vertices, num);
+
+		graphics::updateConstantBuffer(_descriptor.constantBuffer, &_buffer, sizeof(PNTCConstantBuffer));
+		graphics::setVertexShaderConstantBuffer(_descriptor.constantBuffer);
+		graphics::drawIndexed(num / 4 * 6);
+
+		++gDrawCounter->flushes;
+		gDrawCounter->vertices += num;
 	}
 
 }
\ No newline at end of file
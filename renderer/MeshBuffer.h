@@ -9,16 +9,49 @@
 #include "VertexTypes.h"
 #include "QuadBuffer.h"
 #include "core\math\AABBox.h"
+#include "InstanceBatch.h"
+#include <vector>
 
 namespace ds {
 
 	// ------------------------------------------------------
-	// Mesh
+	// Mesh file format
+	//   MeshFileHeader
+	//   PNTCVertex[numVertices]
+	// Files without the magic are the old format which only
+	// stores the number of vertices in front of them.
+	// ------------------------------------------------------
+	const uint32_t MESH_FILE_MAGIC = 0x484D5344; // DSMH
+	const uint32_t MESH_FILE_VERSION = 1;
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numVertices;
+		// reserved for later versions - always 0
+		uint32_t flags;
+		v3 min;
+		v3 max;
+	};
+
+	struct MeshLODs;
+
+	// ------------------------------------------------------
+	// Mesh - lods is only set if LOD levels were built
+	// (see MeshLOD.h) and owns the levels. loading is set
+	// while the file is read in the background and the
+	// vertices are a placeholder (see MeshLoader.h).
 	// ------------------------------------------------------
 	struct Mesh {
 
 		AABBox boundingBox;
 		Array<PNTCVertex> vertices;
+		MeshLODs* lods;
+		bool loading;
+
+		Mesh() : lods(0), loading(false) {}
+
+		~Mesh();
 
 		void add(const v3& position, const v3& normal, const v2& uv) {
 			vertices.push_back(PNTCVertex(position, normal, uv, Color::WHITE));
@@ -28,6 +61,13 @@ namespace ds {
 			vertices.push_back(PNTCVertex(position, normal, uv, color));
 		}
 
+		// grows the vertices once and returns the first of num new ones
+		PNTCVertex* append(uint32_t num) {
+			uint32_t first = vertices.size();
+			vertices.resize(first + num);
+			return vertices.data() + first;
+		}
+
 		void clear() {
 			vertices.clear();
 		}
@@ -40,6 +80,57 @@ namespace ds {
 
 	};
 
+	// ------------------------------------------------------
+	// contents of a mesh file - see readMeshFile. Uses
+	// std::vector since the engine allocator must only be
+	// used on the main thread.
+	// ------------------------------------------------------
+	struct MeshFile {
+		bool found;
+		bool hasHeader;
+		MeshFileHeader header;
+		// number of vertices the file should contain
+		uint32_t expected;
+		std::vector<PNTCVertex> vertices;
+
+		MeshFile() : found(false), hasHeader(false), expected(0) {}
+
+		bool supported() const {
+			return !hasHeader || header.version == MESH_FILE_VERSION;
+		}
+	};
+
+	// ------------------------------------------------------
+	// Reads the header and the vertices of a mesh file. No
+	// more vertices are read than the file holds and an
+	// unsupported version reads none. Does not log so it
+	// can run on the loader thread.
+	// ------------------------------------------------------
+	void readMeshFile(const char* path, MeshFile* file);
+
+	// ------------------------------------------------------
+	// Adds the vertices read by readMeshFile to the mesh and
+	// sets the bounding box. Reports truncated files. Returns
+	// false and leaves the mesh unchanged if the file was not
+	// found or has an unsupported version.
+	// ------------------------------------------------------
+	bool assignMeshFile(Mesh* mesh, const MeshFile& file, const char* name, const v3& offset = v3(0, 0, 0));
+
+	// ------------------------------------------------------
+	// mesh queued by MeshBuffer::reserve - offset is the
+	// first vertex of its output range. The range lies in
+	// batch offset / size of the buffer.
+	// ------------------------------------------------------
+	struct MeshSubmission {
+		Mesh* mesh;
+		mat4 world;
+		Color color;
+		uint32_t offset;
+	};
+
+	// vertices transformed by one job in MeshBuffer::submit
+	const uint32_t SUBMIT_CHUNK_SIZE = 1024;
+
 	// ------------------------------------------------------
 	// MeshBuffer
 	// ------------------------------------------------------
@@ -58,10 +149,25 @@ namespace ds {
 		void add(Mesh* mesh, const mat4& world, const v3& scale = v3(1, 1, 1), const v3& rotation = v3(0, 0, 0), const Color& color = Color(255, 255, 255, 255));
 		void add(Mesh* mesh, const mat4& world, const Color& color = Color(255, 255, 255, 255));
 		void add(Mesh* mesh, const v3& position, const Color& color, const v3& scale = v3(1, 1, 1), const v3& rotation = v3(0, 0, 0));
+		// ------------------------------------------------------
+		// two phase submission - reserve only records the mesh
+		// and returns the start of its output range. submit
+		// transforms all meshes in parallel and draws them in
+		// batches of the buffer size.
+		// ------------------------------------------------------
+		uint32_t reserve(Mesh* mesh, const mat4& world, const Color& color = Color(255, 255, 255, 255));
+		void submit();
 		void begin();
 		void end();
 		void flush();
 		void draw();
+		// draws pre-transformed quads from a caller owned vertex buffer
+		void drawStatic(ID3D11Buffer* buffer, uint32_t numVertices);
+		// draws every group of the batch with one instanced draw call per chunk
+		void drawInstanced(const InstanceBatch& batch);
+		bool supportsInstancing() const {
+			return _maxInstances > 0;
+		}
 		void rotateX(float angle);
 		void rotateY(float angle);
 		void rotateZ(float angle);
@@ -70,15 +176,30 @@ namespace ds {
 		v3* getLightPos() {
 			return &_lightPos;
 		}
+		VertexFormat getVertexFormat() const {
+			return _descriptor.format;
+		}
 	private:
+		void addTransformed(Mesh* mesh, const mat4& world, const Color& color, bool modulate);
+		void upload(const PNTCVertex* vertices, uint32_t num);
+		void drawBatch(const PNTCVertex* vertices, uint32_t num);
 		uint32_t _size;
 		MeshBufferDescriptor _descriptor;
 		v3 _lightPos;
 		//Array<PNTCVertex> _vertices;
 		PNTCVertex* _vertices;
+		// staging buffer for VF_PACKED
+		PackedVertex* _packed;
+		// size of one vertex in the vertex buffer
+		uint32_t _stride;
 		uint32_t _index;
+		// meshes queued by reserve and the number of reserved vertices
+		Array<MeshSubmission> _submissions;
+		uint32_t _reserved;
 		PNTCConstantBuffer _buffer;
 		Color _diffuseColor;
+		uint32_t _maxInstances;
+		RID _inputLayout;
 	};
 
 }
\ No newline at end of file
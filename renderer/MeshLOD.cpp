@@ -0,0 +1,183 @@
+#include "MeshLOD.h"
+#include "MeshSimplifier.h"
+#include "VertexCache.h"
+#include "core\log\Log.h"
+#include "core\profiler\Profiler.h"
+#include <vector>
+
+namespace ds {
+
+	// ------------------------------------------------------
+	// levels 1 - n as plain vertices. Only std::vector is
+	// used so it can run on the loader thread.
+	// ------------------------------------------------------
+	struct LODLevels {
+		uint32_t num;
+		std::vector<PNTCVertex> vertices[MAX_MESH_LODS];
+		float errors[MAX_MESH_LODS];
+	};
+
+	namespace lod {
+
+		// ------------------------------------------------------
+		// new face normal of a quad - (0, 1, 3) and (1, 2, 3)
+		// are summed so single triangles (c == d) work as well.
+		// The normal keeps the side of the old one.
+		// ------------------------------------------------------
+		static void faceNormal(PNTCVertex* q) {
+			v3 n = cross(q[1].position - q[0].position, q[3].position - q[0].position);
+			n += cross(q[2].position - q[1].position, q[3].position - q[1].position);
+			float l = length(n);
+			if (l <= 0.0f) {
+				return;
+			}
+			n = n * (1.0f / l);
+			if (dot(n, q[0].normal) < 0.0f) {
+				n = n * -1.0f;
+			}
+			for (int k = 0; k < 4; ++k) {
+				q[k].normal = n;
+			}
+		}
+
+		// ------------------------------------------------------
+		// compute
+		// ------------------------------------------------------
+		LODLevels* compute(const PNTCVertex* vertices, uint32_t total, uint32_t num) {
+			if (num > MAX_MESH_LODS) {
+				num = MAX_MESH_LODS;
+			}
+			if (num < 2 || total < 4) {
+				return 0;
+			}
+			std::vector<v3> positions(total);
+			for (uint32_t i = 0; i < total; ++i) {
+				positions[i] = vertices[i].position;
+			}
+			// flat shaded meshes have different normals at every corner and are welded by position only
+			std::vector<uint32_t> remap(total);
+			std::vector<uint32_t> unique(total);
+			uint32_t numPositions = vcache::weldVertices(&positions[0], total, sizeof(v3), &remap[0], &unique[0]);
+			uint32_t numUnique = vcache::weldVertices(vertices, total, sizeof(PNTCVertex), &remap[0], &unique[0]);
+			bool flat = numUnique > numPositions * 3 / 2;
+			if (flat) {
+				numUnique = vcache::weldVertices(&positions[0], total, sizeof(v3), &remap[0], &unique[0]);
+			}
+			std::vector<PNTCVertex> welded(numUnique);
+			for (uint32_t i = 0; i < numUnique; ++i) {
+				welded[i] = vertices[unique[i]];
+			}
+			// quads are drawn as (0, 1, 3) and (1, 2, 3)
+			const uint32_t tris[] = { 0, 1, 3, 1, 2, 3 };
+			std::vector<uint32_t> indices;
+			indices.reserve(total / 4 * 6);
+			for (uint32_t i = 0; i + 3 < total; i += 4) {
+				for (int k = 0; k < 6; ++k) {
+					indices.push_back(remap[i + tris[k]]);
+				}
+			}
+			uint32_t numIndices = (uint32_t)indices.size();
+			LODLevels* levels = new LODLevels;
+			levels->num = 1;
+			levels->errors[0] = 0.0f;
+			std::vector<uint32_t> lod(numIndices);
+			std::vector<uint32_t> quads(numIndices / 3 * 4);
+			uint32_t target = numIndices;
+			uint32_t last = numIndices;
+			for (uint32_t level = 1; level < num; ++level) {
+				target = target / 6 * 3;
+				float error = 0.0f;
+				uint32_t numLod = simplify::simplify(&lod[0], &indices[0], numIndices, &welded[0].position.x, numUnique, sizeof(PNTCVertex), target, 1.0f, &error);
+				// nothing left to collapse
+				if (numLod == 0 || numLod >= last) {
+					break;
+				}
+				last = numLod;
+				uint32_t numQuads = simplify::buildQuads(&lod[0], numLod, &quads[0]);
+				std::vector<PNTCVertex>& out = levels->vertices[level];
+				out.resize(numQuads);
+				for (uint32_t i = 0; i < numQuads; i += 4) {
+					PNTCVertex* q = &out[i];
+					for (int k = 0; k < 4; ++k) {
+						q[k] = welded[quads[i + k]];
+					}
+					if (flat) {
+						faceNormal(q);
+					}
+				}
+				levels->errors[level] = error;
+				++levels->num;
+			}
+			if (levels->num < 2) {
+				delete levels;
+				return 0;
+			}
+			return levels;
+		}
+
+		// ------------------------------------------------------
+		// assign
+		// ------------------------------------------------------
+		void assign(Mesh* mesh, LODLevels* levels) {
+			release(mesh);
+			if (levels == 0) {
+				return;
+			}
+			MeshLODs* lods = new MeshLODs;
+			lods->num = levels->num;
+			lods->meshes[0] = mesh;
+			lods->errors[0] = 0.0f;
+			for (uint32_t level = 1; level < levels->num; ++level) {
+				const std::vector<PNTCVertex>& vertices = levels->vertices[level];
+				Mesh* m = new Mesh;
+				m->boundingBox = mesh->boundingBox;
+				for (size_t i = 0; i < vertices.size(); ++i) {
+					m->vertices.push_back(vertices[i]);
+				}
+				lods->meshes[level] = m;
+				lods->errors[level] = levels->errors[level];
+				LOG << "LOD " << level << " - vertices: " << vertices.size() << " error: " << levels->errors[level];
+			}
+			mesh->lods = lods;
+			delete levels;
+		}
+
+		// ------------------------------------------------------
+		// build
+		// ------------------------------------------------------
+		void build(Mesh* mesh, uint32_t num) {
+			ZoneTracker z("lod::build");
+			release(mesh);
+			if (mesh->vertices.size() == 0) {
+				return;
+			}
+			assign(mesh, compute(&mesh->vertices[0], mesh->vertices.size(), num));
+		}
+
+		// ------------------------------------------------------
+		// release - level 0 is the mesh and is kept
+		// ------------------------------------------------------
+		void release(Mesh* mesh) {
+			if (mesh->lods != 0) {
+				for (uint32_t i = 1; i < mesh->lods->num; ++i) {
+					delete mesh->lods->meshes[i];
+				}
+				delete mesh->lods;
+				mesh->lods = 0;
+			}
+		}
+
+		// ------------------------------------------------------
+		// select
+		// ------------------------------------------------------
+		Mesh* select(Mesh* mesh, float screenSize, float maxPixelError) {
+			if (mesh->lods == 0) {
+				return mesh;
+			}
+			const MeshLODs* lods = mesh->lods;
+			return lods->meshes[simplify::selectLevel(lods->errors, lods->num, screenSize, maxPixelError)];
+		}
+
+	}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "MeshBuffer.h"
+
+namespace ds {
+
+	const uint32_t MAX_MESH_LODS = 4;
+
+	// ------------------------------------------------------
+	// LOD levels of a mesh. Level 0 is the mesh itself.
+	// errors are relative to the radius of the bounding box
+	// and increase with the level.
+	// ------------------------------------------------------
+	struct MeshLODs {
+		uint32_t num;
+		Mesh* meshes[MAX_MESH_LODS];
+		float errors[MAX_MESH_LODS];
+	};
+
+	// levels computed by lod::compute - owned by the caller
+	// until they are handed to lod::assign
+	struct LODLevels;
+
+	namespace lod {
+
+		// ------------------------------------------------------
+		// builds up to num levels (including level 0) with the
+		// quadric simplifier. Every level has half the triangles
+		// of the previous one. Flat shaded meshes are welded by
+		// position and get new face normals.
+		// ------------------------------------------------------
+		void build(Mesh* mesh, uint32_t num);
+
+		// ------------------------------------------------------
+		// the two halves of build. compute does not use the
+		// engine allocator and may run on any thread. It
+		// returns 0 if no level could be built. assign runs
+		// on the main thread and deletes the levels.
+		// ------------------------------------------------------
+		LODLevels* compute(const PNTCVertex* vertices, uint32_t num, uint32_t levels);
+
+		void assign(Mesh* mesh, LODLevels* levels);
+
+		void release(Mesh* mesh);
+
+		// ------------------------------------------------------
+		// returns the coarsest level whose error stays below
+		// maxPixelError for the given screen size in pixels
+		// ------------------------------------------------------
+		Mesh* select(Mesh* mesh, float screenSize, float maxPixelError);
+
+	}
+
+}
@@ -0,0 +1,506 @@
+#include "MeshSimplifier.h"
+#include "VertexCache.h"
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+namespace ds {
+
+	namespace simplify {
+
+		// border edges are kept in place by planes along them
+		const double BORDER_WEIGHT = 10.0;
+
+		// ------------------------------------------------------
+		// symmetric 4x4 matrix of the plane equations and the
+		// sum of the weights
+		// ------------------------------------------------------
+		struct Quadric {
+			double a2, ab, ac, ad;
+			double b2, bc, bd;
+			double c2, cd;
+			double d2;
+			double w;
+		};
+
+		static void addPlane(Quadric& q, double a, double b, double c, double d, double w) {
+			q.a2 += w * a * a;
+			q.ab += w * a * b;
+			q.ac += w * a * c;
+			q.ad += w * a * d;
+			q.b2 += w * b * b;
+			q.bc += w * b * c;
+			q.bd += w * b * d;
+			q.c2 += w * c * c;
+			q.cd += w * c * d;
+			q.d2 += w * d * d;
+			q.w += w;
+		}
+
+		static void addQuadric(Quadric& q, const Quadric& o) {
+			q.a2 += o.a2;
+			q.ab += o.ab;
+			q.ac += o.ac;
+			q.ad += o.ad;
+			q.b2 += o.b2;
+			q.bc += o.bc;
+			q.bd += o.bd;
+			q.c2 += o.c2;
+			q.cd += o.cd;
+			q.d2 += o.d2;
+			q.w += o.w;
+		}
+
+		// weighted sum of the squared distances to all planes
+		static double evaluate(const Quadric& q, const float* p) {
+			double x = p[0];
+			double y = p[1];
+			double z = p[2];
+			double r = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2;
+			r += 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z);
+			r += 2.0 * (q.ad * x + q.bd * y + q.cd * z);
+			return r > 0.0 ? r : 0.0;
+		}
+
+		static void cross(const float* a, const float* b, const float* c, double* n) {
+			double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+			n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+			n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		}
+
+		struct Collapse {
+			float cost;
+			uint32_t from;
+			uint32_t to;
+			uint32_t fromVersion;
+			uint32_t toVersion;
+
+			// smallest cost first
+			bool operator<(const Collapse& other) const {
+				return cost > other.cost;
+			}
+		};
+
+		// ------------------------------------------------------
+		// all state works on welded positions - triangles store
+		// the original vertices to keep the attributes
+		// ------------------------------------------------------
+		struct Context {
+			std::vector<float> positions;
+			std::vector<uint32_t> vertexPos;
+			std::vector<Quadric> quadrics;
+			std::vector<std::vector<uint32_t>> triangles;
+			std::vector<uint32_t> versions;
+			std::vector<bool> alive;
+			std::vector<bool> border;
+			std::vector<uint32_t> indices;
+			std::vector<bool> triAlive;
+			std::priority_queue<Collapse> queue;
+			double radius;
+			// scratch data of canCollapse
+			std::vector<uint32_t> neighbours;
+			std::vector<uint32_t> wedges;
+		};
+
+		static const float* posOf(const Context& ctx, uint32_t p) {
+			return &ctx.positions[p * 3];
+		}
+
+		// corner of the triangle at position p or -1
+		static int findCorner(const Context& ctx, uint32_t t, uint32_t p) {
+			for (int k = 0; k < 3; ++k) {
+				if (ctx.vertexPos[ctx.indices[t * 3 + k]] == p) {
+					return k;
+				}
+			}
+			return -1;
+		}
+
+		static float collapseCost(const Context& ctx, uint32_t from, uint32_t to) {
+			Quadric q = ctx.quadrics[from];
+			addQuadric(q, ctx.quadrics[to]);
+			if (q.w <= 0.0) {
+				return 0.0f;
+			}
+			return (float)(sqrt(evaluate(q, posOf(ctx, to)) / q.w) / ctx.radius);
+		}
+
+		static void push(Context& ctx, uint32_t from, uint32_t to) {
+			Collapse c;
+			c.cost = collapseCost(ctx, from, to);
+			c.from = from;
+			c.to = to;
+			c.fromVersion = ctx.versions[from];
+			c.toVersion = ctx.versions[to];
+			ctx.queue.push(c);
+		}
+
+		// ------------------------------------------------------
+		// checks topology, attributes and flipped triangles. The
+		// wedges receive pairs of (vertex at from, vertex at to).
+		// ------------------------------------------------------
+		static bool canCollapse(Context& ctx, uint32_t from, uint32_t to) {
+			std::vector<uint32_t>& wedges = ctx.wedges;
+			std::vector<uint32_t>& neighbours = ctx.neighbours;
+			wedges.clear();
+			neighbours.clear();
+			uint32_t shared = 0;
+			const std::vector<uint32_t>& tris = ctx.triangles[from];
+			for (size_t i = 0; i < tris.size(); ++i) {
+				uint32_t t = tris[i];
+				if (!ctx.triAlive[t]) {
+					continue;
+				}
+				int cf = findCorner(ctx, t, from);
+				int ct = findCorner(ctx, t, to);
+				for (int k = 0; k < 3; ++k) {
+					uint32_t p = ctx.vertexPos[ctx.indices[t * 3 + k]];
+					if (p != from && p != to) {
+						neighbours.push_back(p);
+					}
+				}
+				if (ct != -1) {
+					++shared;
+					uint32_t wf = ctx.indices[t * 3 + cf];
+					bool found = false;
+					for (size_t j = 0; j < wedges.size(); j += 2) {
+						found |= wedges[j] == wf;
+					}
+					if (!found) {
+						wedges.push_back(wf);
+						wedges.push_back(ctx.indices[t * 3 + ct]);
+					}
+				}
+			}
+			if (shared == 0) {
+				return false;
+			}
+			// a border vertex may only slide along its border edge
+			if (ctx.border[from] && (shared != 1 || !ctx.border[to])) {
+				return false;
+			}
+			// link condition - the only common neighbours are the opposite corners of the shared triangles
+			std::sort(neighbours.begin(), neighbours.end());
+			neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+			uint32_t common = 0;
+			const std::vector<uint32_t>& toTris = ctx.triangles[to];
+			for (size_t i = 0; i < toTris.size(); ++i) {
+				uint32_t t = toTris[i];
+				if (!ctx.triAlive[t] || findCorner(ctx, t, from) != -1) {
+					continue;
+				}
+				for (int k = 0; k < 3; ++k) {
+					uint32_t p = ctx.vertexPos[ctx.indices[t * 3 + k]];
+					if (p == to) {
+						continue;
+					}
+					for (size_t j = 0; j < neighbours.size(); ++j) {
+						if (neighbours[j] == p) {
+							neighbours[j] = UINT32_MAX;
+							++common;
+						}
+					}
+				}
+			}
+			if (common > shared) {
+				return false;
+			}
+			// every attribute set of the vertex needs a partner and no triangle may flip
+			for (size_t i = 0; i < tris.size(); ++i) {
+				uint32_t t = tris[i];
+				if (!ctx.triAlive[t] || findCorner(ctx, t, to) != -1) {
+					continue;
+				}
+				int cf = findCorner(ctx, t, from);
+				uint32_t wf = ctx.indices[t * 3 + cf];
+				bool found = false;
+				for (size_t j = 0; j < wedges.size(); j += 2) {
+					found |= wedges[j] == wf;
+				}
+				if (!found) {
+					return false;
+				}
+				const float* p[3];
+				for (int k = 0; k < 3; ++k) {
+					p[k] = posOf(ctx, ctx.vertexPos[ctx.indices[t * 3 + k]]);
+				}
+				double before[3];
+				cross(p[0], p[1], p[2], before);
+				p[cf] = posOf(ctx, to);
+				double after[3];
+				cross(p[0], p[1], p[2], after);
+				if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// ------------------------------------------------------
+		// moves from onto to - returns the removed triangles
+		// ------------------------------------------------------
+		static uint32_t collapse(Context& ctx, uint32_t from, uint32_t to) {
+			uint32_t removed = 0;
+			std::vector<uint32_t>& tris = ctx.triangles[from];
+			std::vector<uint32_t>& toTris = ctx.triangles[to];
+			for (size_t i = 0; i < tris.size(); ++i) {
+				uint32_t t = tris[i];
+				if (!ctx.triAlive[t]) {
+					continue;
+				}
+				if (findCorner(ctx, t, to) != -1) {
+					ctx.triAlive[t] = false;
+					++removed;
+					continue;
+				}
+				uint32_t& v = ctx.indices[t * 3 + findCorner(ctx, t, from)];
+				for (size_t j = 0; j < ctx.wedges.size(); j += 2) {
+					if (ctx.wedges[j] == v) {
+						v = ctx.wedges[j + 1];
+						break;
+					}
+				}
+				toTris.push_back(t);
+			}
+			tris.clear();
+			// drop the removed triangles
+			size_t cnt = 0;
+			for (size_t i = 0; i < toTris.size(); ++i) {
+				if (ctx.triAlive[toTris[i]]) {
+					toTris[cnt++] = toTris[i];
+				}
+			}
+			toTris.resize(cnt);
+			addQuadric(ctx.quadrics[to], ctx.quadrics[from]);
+			ctx.alive[from] = false;
+			++ctx.versions[to];
+			for (size_t i = 0; i < toTris.size(); ++i) {
+				uint32_t t = toTris[i];
+				for (int k = 0; k < 3; ++k) {
+					uint32_t p = ctx.vertexPos[ctx.indices[t * 3 + k]];
+					if (p != to) {
+						push(ctx, p, to);
+						push(ctx, to, p);
+					}
+				}
+			}
+			return removed;
+		}
+
+		// ------------------------------------------------------
+		// simplify
+		// ------------------------------------------------------
+		uint32_t simplify(uint32_t* dest, const uint32_t* indices, uint32_t numIndices, const float* positions, uint32_t numVertices, uint32_t stride, uint32_t targetIndices, float targetError, float* resultError) {
+			if (resultError != 0) {
+				*resultError = 0.0f;
+			}
+			uint32_t numTris = numIndices / 3;
+			if (numTris == 0 || numVertices == 0) {
+				return 0;
+			}
+			Context ctx;
+			// weld positions
+			std::vector<float> packed(numVertices * 3);
+			const uint8_t* src = (const uint8_t*)positions;
+			for (uint32_t i = 0; i < numVertices; ++i) {
+				memcpy(&packed[i * 3], src + i * stride, 3 * sizeof(float));
+			}
+			ctx.vertexPos.resize(numVertices);
+			std::vector<uint32_t> unique(numVertices);
+			uint32_t numPos = vcache::weldVertices(&packed[0], numVertices, 3 * sizeof(float), &ctx.vertexPos[0], &unique[0]);
+			ctx.positions.resize(numPos * 3);
+			float min[3] = { 1e30f, 1e30f, 1e30f };
+			float max[3] = { -1e30f, -1e30f, -1e30f };
+			for (uint32_t i = 0; i < numPos; ++i) {
+				for (int k = 0; k < 3; ++k) {
+					float v = packed[unique[i] * 3 + k];
+					ctx.positions[i * 3 + k] = v;
+					min[k] = v < min[k] ? v : min[k];
+					max[k] = v > max[k] ? v : max[k];
+				}
+			}
+			double dx = max[0] - min[0];
+			double dy = max[1] - min[1];
+			double dz = max[2] - min[2];
+			ctx.radius = 0.5 * sqrt(dx * dx + dy * dy + dz * dz);
+			if (ctx.radius <= 0.0) {
+				ctx.radius = 1.0;
+			}
+			ctx.indices.assign(indices, indices + numTris * 3);
+			ctx.triAlive.assign(numTris, true);
+			ctx.triangles.resize(numPos);
+			ctx.versions.assign(numPos, 0);
+			ctx.alive.assign(numPos, true);
+			ctx.border.assign(numPos, false);
+			Quadric zero;
+			memset(&zero, 0, sizeof(Quadric));
+			ctx.quadrics.assign(numPos, zero);
+			// directed edges - an edge without its reverse is a border
+			std::unordered_map<uint64_t, uint32_t> edges;
+			for (uint32_t t = 0; t < numTris; ++t) {
+				for (int k = 0; k < 3; ++k) {
+					uint64_t a = ctx.vertexPos[ctx.indices[t * 3 + k]];
+					uint64_t b = ctx.vertexPos[ctx.indices[t * 3 + (k + 1) % 3]];
+					edges[(a << 32) | b] = t;
+				}
+			}
+			uint32_t live = 0;
+			for (uint32_t t = 0; t < numTris; ++t) {
+				uint32_t p[3];
+				for (int k = 0; k < 3; ++k) {
+					p[k] = ctx.vertexPos[ctx.indices[t * 3 + k]];
+				}
+				if (p[0] == p[1] || p[1] == p[2] || p[0] == p[2]) {
+					ctx.triAlive[t] = false;
+					continue;
+				}
+				++live;
+				double n[3];
+				cross(posOf(ctx, p[0]), posOf(ctx, p[1]), posOf(ctx, p[2]), n);
+				double l = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (int k = 0; k < 3; ++k) {
+					ctx.triangles[p[k]].push_back(t);
+				}
+				if (l <= 0.0) {
+					continue;
+				}
+				n[0] /= l;
+				n[1] /= l;
+				n[2] /= l;
+				const float* p0 = posOf(ctx, p[0]);
+				double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+				// weighted by the area
+				for (int k = 0; k < 3; ++k) {
+					addPlane(ctx.quadrics[p[k]], n[0], n[1], n[2], d, l * 0.5);
+				}
+				for (int k = 0; k < 3; ++k) {
+					uint64_t a = p[k];
+					uint64_t b = p[(k + 1) % 3];
+					if (edges.find((b << 32) | a) != edges.end()) {
+						continue;
+					}
+					ctx.border[a] = true;
+					ctx.border[b] = true;
+					const float* pa = posOf(ctx, (uint32_t)a);
+					const float* pb = posOf(ctx, (uint32_t)b);
+					double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+					double el = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+					// plane through the edge perpendicular to the triangle
+					double bn[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+					double bl = sqrt(bn[0] * bn[0] + bn[1] * bn[1] + bn[2] * bn[2]);
+					if (bl <= 0.0) {
+						continue;
+					}
+					bn[0] /= bl;
+					bn[1] /= bl;
+					bn[2] /= bl;
+					double bd = -(bn[0] * pa[0] + bn[1] * pa[1] + bn[2] * pa[2]);
+					addPlane(ctx.quadrics[a], bn[0], bn[1], bn[2], bd, el * BORDER_WEIGHT);
+					addPlane(ctx.quadrics[b], bn[0], bn[1], bn[2], bd, el * BORDER_WEIGHT);
+				}
+			}
+			for (uint32_t t = 0; t < numTris; ++t) {
+				if (ctx.triAlive[t]) {
+					for (int k = 0; k < 3; ++k) {
+						uint32_t a = ctx.vertexPos[ctx.indices[t * 3 + k]];
+						uint32_t b = ctx.vertexPos[ctx.indices[t * 3 + (k + 1) % 3]];
+						push(ctx, a, b);
+						push(ctx, b, a);
+					}
+				}
+			}
+			float error = 0.0f;
+			uint32_t targetTris = targetIndices / 3;
+			while (live > targetTris && !ctx.queue.empty()) {
+				Collapse c = ctx.queue.top();
+				ctx.queue.pop();
+				if (!ctx.alive[c.from] || !ctx.alive[c.to] || c.fromVersion != ctx.versions[c.from] || c.toVersion != ctx.versions[c.to]) {
+					continue;
+				}
+				if (c.cost > targetError) {
+					break;
+				}
+				if (!canCollapse(ctx, c.from, c.to)) {
+					continue;
+				}
+				live -= collapse(ctx, c.from, c.to);
+				error = c.cost > error ? c.cost : error;
+			}
+			uint32_t cnt = 0;
+			for (uint32_t t = 0; t < numTris; ++t) {
+				if (ctx.triAlive[t]) {
+					dest[cnt++] = ctx.indices[t * 3];
+					dest[cnt++] = ctx.indices[t * 3 + 1];
+					dest[cnt++] = ctx.indices[t * 3 + 2];
+				}
+			}
+			if (resultError != 0) {
+				*resultError = error;
+			}
+			return cnt;
+		}
+
+		// ------------------------------------------------------
+		// build quads - the quad (q0, q1, q2, q3) is drawn as
+		// (q0, q1, q3) and (q1, q2, q3) so the two triangles
+		// must share the edge q1 - q3
+		// ------------------------------------------------------
+		uint32_t buildQuads(const uint32_t* indices, uint32_t numIndices, uint32_t* quads) {
+			uint32_t numTris = numIndices / 3;
+			std::unordered_map<uint64_t, uint32_t> edges;
+			edges.reserve(numTris * 3);
+			for (uint32_t t = 0; t < numTris; ++t) {
+				for (int k = 0; k < 3; ++k) {
+					uint64_t a = indices[t * 3 + k];
+					uint64_t b = indices[t * 3 + (k + 1) % 3];
+					edges[(a << 32) | b] = t;
+				}
+			}
+			std::vector<bool> used(numTris, false);
+			uint32_t cnt = 0;
+			for (uint32_t t = 0; t < numTris; ++t) {
+				if (used[t]) {
+					continue;
+				}
+				used[t] = true;
+				const uint32_t* ti = indices + t * 3;
+				bool paired = false;
+				for (int r = 0; r < 3 && !paired; ++r) {
+					uint64_t q1 = ti[(r + 1) % 3];
+					uint64_t q3 = ti[(r + 2) % 3];
+					std::unordered_map<uint64_t, uint32_t>::const_iterator it = edges.find((q3 << 32) | q1);
+					if (it == edges.end() || used[it->second]) {
+						continue;
+					}
+					uint32_t o = it->second;
+					const uint32_t* oi = indices + o * 3;
+					for (int s = 0; s < 3; ++s) {
+						if (oi[s] == q3 && oi[(s + 1) % 3] == q1) {
+							quads[cnt++] = ti[r];
+							quads[cnt++] = (uint32_t)q1;
+							quads[cnt++] = oi[(s + 2) % 3];
+							quads[cnt++] = (uint32_t)q3;
+							used[o] = true;
+							paired = true;
+							break;
+						}
+					}
+				}
+				if (!paired) {
+					quads[cnt++] = ti[0];
+					quads[cnt++] = ti[1];
+					quads[cnt++] = ti[2];
+					quads[cnt++] = ti[2];
+				}
+			}
+			return cnt;
+		}
+
+	}
+
+}
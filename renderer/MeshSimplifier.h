@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+
+namespace ds {
+
+	// -------------------------------------------------------
+	// Mesh simplification for LODs. Like the vertex cache
+	// helpers everything works on raw arrays and does not
+	// depend on the core library.
+	// -------------------------------------------------------
+	namespace simplify {
+
+		// -------------------------------------------------------
+		// Quadric error edge collapse (Garland / Heckbert). The
+		// vertices must be welded - vertices with the same
+		// position but different attributes are kept apart and
+		// are moved together. Every collapse moves a vertex onto
+		// one of its neighbours so no new vertices are created.
+		// Stops when targetIndices is reached or the next
+		// collapse would exceed targetError. Errors are relative
+		// to the radius of the bounding box. dest needs room for
+		// numIndices and receives the remaining triangles.
+		// Returns the number of indices written.
+		// -------------------------------------------------------
+		uint32_t simplify(uint32_t* dest, const uint32_t* indices, uint32_t numIndices, const float* positions, uint32_t numVertices, uint32_t stride, uint32_t targetIndices, float targetError, float* resultError);
+
+		// -------------------------------------------------------
+		// pairs triangles sharing an edge into quads that draw
+		// the same triangles with the quad index buffer. Single
+		// triangles repeat the last corner. quads needs room for
+		// numIndices / 3 * 4 entries. Returns the number written.
+		// -------------------------------------------------------
+		uint32_t buildQuads(const uint32_t* indices, uint32_t numIndices, uint32_t* quads);
+
+		// size of the bounding sphere on screen in pixels
+		inline float screenSize(float radius, float distance, float projectionScale) {
+			if (distance <= radius) {
+				return 1e30f;
+			}
+			return radius * projectionScale / distance;
+		}
+
+		// -------------------------------------------------------
+		// returns the coarsest level whose error is not larger
+		// than maxPixelError on screen. errors are relative to
+		// the radius and increase with the level.
+		// -------------------------------------------------------
+		inline uint32_t selectLevel(const float* errors, uint32_t num, float screenSize, float maxPixelError) {
+			uint32_t level = 0;
+			for (uint32_t i = 1; i < num; ++i) {
+				if (errors[i] * screenSize > maxPixelError) {
+					break;
+				}
+				level = i;
+			}
+			return level;
+		}
+
+	}
+
+}
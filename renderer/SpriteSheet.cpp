@@ -2,13 +2,19 @@
 #include "core\log\Log.h"
 #include "core\string\StringUtils.h"
 #include "core\base\Assert.h"
+#include "core\memory\DefaultAllocator.h"
 
 namespace ds {
 
-	SpriteSheet::SpriteSheet(const char* fileName) : JSONAssetFile(fileName) {
+	const int MAX_SHEET_ENTRIES = 4096;
+
+	SpriteSheet::SpriteSheet(const char* fileName) : JSONAssetFile(fileName), _index(0), _indexCapacity(0) {
 	}
 
 	SpriteSheet::~SpriteSheet() {
+		if (_index != 0) {
+			DEALLOC(_index);
+		}
 	}
 
 	void SpriteSheet::add(const char* name, const Rect& r) {
@@ -16,6 +22,67 @@ namespace ds {
 		entry.hash = SID(name);
 		entry.texture = Texture(r);
 		_entries.push_back(entry);
+		// keep the load factor below 0.5
+		if (_entries.size() * 2 > _indexCapacity) {
+			buildIndex();
+		}
+		else {
+			addToIndex(_entries.size() - 1);
+		}
+	}
+
+	// ------------------------------------------------------
+	// rebuild the hash index for all entries
+	// ------------------------------------------------------
+	void SpriteSheet::buildIndex() {
+		uint32_t capacity = 64;
+		while (capacity < _entries.size() * 2) {
+			capacity *= 2;
+		}
+		if (capacity != _indexCapacity) {
+			if (_index != 0) {
+				DEALLOC(_index);
+			}
+			_index = (int*)ALLOC(capacity * sizeof(int));
+			_indexCapacity = capacity;
+		}
+		for (uint32_t i = 0; i < _indexCapacity; ++i) {
+			_index[i] = -1;
+		}
+		for (uint32_t i = 0; i < _entries.size(); ++i) {
+			addToIndex(i);
+		}
+	}
+
+	void SpriteSheet::addToIndex(int entryIndex) {
+		uint32_t mask = _indexCapacity - 1;
+		uint32_t slot = _entries[entryIndex].hash.get() & mask;
+		while (_index[slot] != -1) {
+			if (_entries[_index[slot]].hash == _entries[entryIndex].hash) {
+				return;
+			}
+			slot = (slot + 1) & mask;
+		}
+		_index[slot] = entryIndex;
+	}
+
+	// ------------------------------------------------------
+	// linear probing lookup
+	// ------------------------------------------------------
+	int SpriteSheet::lookup(const StaticHash& sid) const {
+		if (_index == 0) {
+			return -1;
+		}
+		uint32_t mask = _indexCapacity - 1;
+		uint32_t slot = sid.get() & mask;
+		while (_index[slot] != -1) {
+			int idx = _index[slot];
+			if (_entries[idx].hash == sid) {
+				return idx;
+			}
+			slot = (slot + 1) & mask;
+		}
+		return -1;
 	}
 
 	const Texture& SpriteSheet::get(const char* name) const {
@@ -35,24 +102,15 @@ namespace ds {
 	}
 
 	int SpriteSheet::findIndex(const char* name) const {
-		StaticHash hash = SID(name);
-		for (uint32_t i = 0; i < _entries.size(); ++i) {
-			if (_entries[i].hash == hash) {
-				return i;
-			}
-		}
-		XASSERT(1 == 2, "No matching spritesheet found for '%s'", name);
-		return -1;
+		int idx = lookup(SID(name));
+		XASSERT(idx != -1, "No matching spritesheet found for '%s'", name);
+		return idx;
 	}
 
 	int SpriteSheet::findIndex(const StaticHash& sid) const {
-		for (uint32_t i = 0; i < _entries.size(); ++i) {
-			if (_entries[i].hash == sid) {
-				return i;
-			}
-		}
-		XASSERT(1 == 2, "No matching spritesheet found for '%d'", sid);
-		return -1;
+		int idx = lookup(sid);
+		XASSERT(idx != -1, "No matching spritesheet found for '%d'", sid);
+		return idx;
 	}
 
 	const Texture& SpriteSheet::get(int index) const {
@@ -61,25 +119,26 @@ namespace ds {
 	}
 
 	bool SpriteSheet::loadData(const JSONReader& loader) {
-		int categories[256];
-		int num = loader.get_categories(categories, 256);
+		int categories[MAX_SHEET_ENTRIES];
+		int num = loader.get_categories(categories, MAX_SHEET_ENTRIES);
 		for (int i = 0; i < num; ++i) {
 			Rect r;
 			loader.get(categories[i], "rect", &r);
 			const char* sn = loader.get_string(categories[i], "name");
 			add(sn, r);
 		}
+		buildIndex();
 		return true;
 	}
 
 	bool SpriteSheet::reloadData(const JSONReader& loader) {
-		int categories[256];
-		int num = loader.get_categories(categories, 256);
+		int categories[MAX_SHEET_ENTRIES];
+		int num = loader.get_categories(categories, MAX_SHEET_ENTRIES);
 		for (int i = 0; i < num; ++i) {
 			Rect r;
 			loader.get(categories[i], "rect", &r);
 			const char* sn = loader.get_string(categories[i], "name");
-			int idx = findIndex(sn);
+			int idx = lookup(SID(sn));
 			if (idx == -1) {
 				add(sn, r);
 			}
@@ -88,6 +147,7 @@ namespace ds {
 				se.texture = Texture(r);
 			}
 		}
+		buildIndex();
 		return true;
 	}
 }
\ No newline at end of file
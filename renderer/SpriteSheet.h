@@ -21,13 +21,24 @@ namespace ds {
 		void add(const char* name, const Rect& r);
 		const Texture& get(const char* name) const;
 		const Texture& get(const StaticHash& sid) const;
+		// the index is a stable handle - entries are never removed and
+		// reloading only updates the texture of existing entries
 		int findIndex(const char* name) const;
 		int findIndex(const StaticHash& sid) const;
 		const Texture& get(int index) const;
 		bool loadData(const JSONReader& loader);
 		bool reloadData(const JSONReader& loader);
 	private:
+		int lookup(const StaticHash& sid) const;
+		void buildIndex();
+		void addToIndex(int entryIndex);
+		// not copyable - the index is owned by the sheet
+		SpriteSheet(const SpriteSheet& other);
+		void operator=(const SpriteSheet& other);
 		Array<SheetEntry> _entries;
+		// open addressed hash index - stores entry index or -1
+		int* _index;
+		uint32_t _indexCapacity;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include <math.h>
+#include "core\math\matrix.h"
+#include "core\math\AABBox.h"
+
+namespace ds {
+
+	namespace transform {
+
+		// -------------------------------------------------------
+		// Builds rotZ * rotY * rotX * scale * translation directly
+		// from the euler angles without any matrix multiplication.
+		// Uses the same row vector convention as the matrix
+		// functions (rotationX = [1 0 0, 0 c s, 0 -s c]).
+		// -------------------------------------------------------
+		inline void buildWorld(const v3& position, const v3& scale, const v3& rotation, mat4* world) {
+			float cx = cos(rotation.x);
+			float sx = sin(rotation.x);
+			float cy = cos(rotation.y);
+			float sy = sin(rotation.y);
+			float cz = cos(rotation.z);
+			float sz = sin(rotation.z);
+			mat4& m = *world;
+			m._11 = cz * cy * scale.x;
+			m._12 = (sz * cx + cz * sy * sx) * scale.y;
+			m._13 = (sz * sx - cz * sy * cx) * scale.z;
+			m._14 = 0.0f;
+			m._21 = -sz * cy * scale.x;
+			m._22 = (cz * cx - sz * sy * sx) * scale.y;
+			m._23 = (cz * sx + sz * sy * cx) * scale.z;
+			m._24 = 0.0f;
+			m._31 = sy * scale.x;
+			m._32 = -cy * sx * scale.y;
+			m._33 = cy * cx * scale.z;
+			m._34 = 0.0f;
+			m._41 = position.x;
+			m._42 = position.y;
+			m._43 = position.z;
+			m._44 = 1.0f;
+		}
+
+		inline mat4 buildWorld(const v3& position, const v3& scale, const v3& rotation) {
+			mat4 m;
+			buildWorld(position, scale, rotation, &m);
+			return m;
+		}
+
+		// -------------------------------------------------------
+		// local * parent for two affine matrices (last column is
+		// 0,0,0,1) - skips the terms that are known to be zero
+		// -------------------------------------------------------
+		inline void multiplyAffine(const mat4& a, const mat4& b, mat4* ret) {
+			mat4& m = *ret;
+			m._11 = a._11 * b._11 + a._12 * b._21 + a._13 * b._31;
+			m._12 = a._11 * b._12 + a._12 * b._22 + a._13 * b._32;
+			m._13 = a._11 * b._13 + a._12 * b._23 + a._13 * b._33;
+			m._14 = 0.0f;
+			m._21 = a._21 * b._11 + a._22 * b._21 + a._23 * b._31;
+			m._22 = a._21 * b._12 + a._22 * b._22 + a._23 * b._32;
+			m._23 = a._21 * b._13 + a._22 * b._23 + a._23 * b._33;
+			m._24 = 0.0f;
+			m._31 = a._31 * b._11 + a._32 * b._21 + a._33 * b._31;
+			m._32 = a._31 * b._12 + a._32 * b._22 + a._33 * b._32;
+			m._33 = a._31 * b._13 + a._32 * b._23 + a._33 * b._33;
+			m._34 = 0.0f;
+			m._41 = a._41 * b._11 + a._42 * b._21 + a._43 * b._31 + b._41;
+			m._42 = a._41 * b._12 + a._42 * b._22 + a._43 * b._32 + b._42;
+			m._43 = a._41 * b._13 + a._42 * b._23 + a._43 * b._33 + b._43;
+			m._44 = 1.0f;
+		}
+
+		// -------------------------------------------------------
+		// axis aligned box around box transformed by world. The
+		// extent is projected onto the axes with the absolute
+		// values of the upper 3x3.
+		// -------------------------------------------------------
+		inline void transformBox(const AABBox& box, const mat4& world, AABBox* ret) {
+			const mat4& w = world;
+			const v3& c = box.position;
+			const v3& e = box.extent;
+			ret->position.x = c.x * w._11 + c.y * w._21 + c.z * w._31 + w._41;
+			ret->position.y = c.x * w._12 + c.y * w._22 + c.z * w._32 + w._42;
+			ret->position.z = c.x * w._13 + c.y * w._23 + c.z * w._33 + w._43;
+			ret->extent.x = fabs(w._11) * e.x + fabs(w._21) * e.y + fabs(w._31) * e.z;
+			ret->extent.y = fabs(w._12) * e.x + fabs(w._22) * e.y + fabs(w._32) * e.z;
+			ret->extent.z = fabs(w._13) * e.x + fabs(w._23) * e.y + fabs(w._33) * e.z;
+		}
+
+	}
+
+}
@@ -0,0 +1,253 @@
+#include "VertexCache.h"
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+namespace ds {
+
+	namespace vcache {
+
+		// ------------------------------------------------------
+		// FNV-1a over the raw bytes of a vertex
+		// ------------------------------------------------------
+		static uint32_t hashVertex(const uint8_t* v, uint32_t stride) {
+			uint32_t h = 2166136261u;
+			for (uint32_t i = 0; i < stride; ++i) {
+				h ^= v[i];
+				h *= 16777619u;
+			}
+			return h;
+		}
+
+		// ------------------------------------------------------
+		// weld vertices - open addressing hash table which
+		// stores the source index of every unique vertex
+		// ------------------------------------------------------
+		uint32_t weldVertices(const void* vertices, uint32_t num, uint32_t stride, uint32_t* remap, uint32_t* unique) {
+			const uint8_t* data = (const uint8_t*)vertices;
+			uint32_t buckets = 16;
+			while (buckets < num * 2) {
+				buckets *= 2;
+			}
+			std::vector<uint32_t> table(buckets, UINT32_MAX);
+			uint32_t mask = buckets - 1;
+			uint32_t cnt = 0;
+			for (uint32_t i = 0; i < num; ++i) {
+				const uint8_t* v = data + i * stride;
+				uint32_t slot = hashVertex(v, stride) & mask;
+				for (;;) {
+					uint32_t entry = table[slot];
+					if (entry == UINT32_MAX) {
+						table[slot] = i;
+						remap[i] = cnt;
+						unique[cnt++] = i;
+						break;
+					}
+					if (memcmp(data + entry * stride, v, stride) == 0) {
+						remap[i] = remap[entry];
+						break;
+					}
+					slot = (slot + 1) & mask;
+				}
+			}
+			return cnt;
+		}
+
+		// ------------------------------------------------------
+		// Forsyth - Linear-Speed Vertex Cache Optimisation
+		// ------------------------------------------------------
+		const float CACHE_DECAY_POWER = 1.5f;
+		const float LAST_TRI_SCORE = 0.75f;
+		const float VALENCE_BOOST_SCALE = 2.0f;
+		const float VALENCE_BOOST_POWER = 0.5f;
+
+		struct CacheVertex {
+			// range in the triangle list
+			uint32_t first;
+			uint32_t numActive;
+			int cachePos;
+			float score;
+		};
+
+		static float vertexScore(int cachePos, uint32_t numActive) {
+			if (numActive == 0) {
+				return -1.0f;
+			}
+			float score = 0.0f;
+			if (cachePos >= 3) {
+				float scaler = 1.0f / (CACHE_SIZE - 3);
+				score = powf(1.0f - (cachePos - 3) * scaler, CACHE_DECAY_POWER);
+			}
+			else if (cachePos >= 0) {
+				// the last triangle was just emitted - avoid using it again right away
+				score = LAST_TRI_SCORE;
+			}
+			score += VALENCE_BOOST_SCALE * powf((float)numActive, -VALENCE_BOOST_POWER);
+			return score;
+		}
+
+		void optimizeVertexCache(uint32_t* indices, uint32_t numIndices, uint32_t numVertices) {
+			uint32_t numTris = numIndices / 3;
+			if (numTris == 0) {
+				return;
+			}
+			std::vector<CacheVertex> verts(numVertices);
+			for (uint32_t i = 0; i < numVertices; ++i) {
+				verts[i].first = 0;
+				verts[i].numActive = 0;
+				verts[i].cachePos = -1;
+			}
+			for (uint32_t i = 0; i < numTris * 3; ++i) {
+				++verts[indices[i]].numActive;
+			}
+			uint32_t sum = 0;
+			for (uint32_t i = 0; i < numVertices; ++i) {
+				verts[i].first = sum;
+				sum += verts[i].numActive;
+				verts[i].score = vertexScore(-1, verts[i].numActive);
+			}
+			// triangles per vertex - the active ones are kept at the front
+			std::vector<uint32_t> vertexTris(sum);
+			std::vector<uint32_t> fill(numVertices, 0);
+			for (uint32_t t = 0; t < numTris; ++t) {
+				for (int k = 0; k < 3; ++k) {
+					uint32_t v = indices[t * 3 + k];
+					vertexTris[verts[v].first + fill[v]++] = t;
+				}
+			}
+			std::vector<float> triScores(numTris);
+			std::vector<bool> emitted(numTris, false);
+			for (uint32_t t = 0; t < numTris; ++t) {
+				triScores[t] = verts[indices[t * 3]].score + verts[indices[t * 3 + 1]].score + verts[indices[t * 3 + 2]].score;
+			}
+			std::vector<uint32_t> result(numTris * 3);
+			uint32_t cache[CACHE_SIZE + 3];
+			uint32_t cacheSize = 0;
+			uint32_t newCache[CACHE_SIZE + 3];
+			int best = -1;
+			float bestScore = -1.0f;
+			for (uint32_t t = 0; t < numTris; ++t) {
+				if (triScores[t] > bestScore) {
+					bestScore = triScores[t];
+					best = t;
+				}
+			}
+			// triangles are rescanned from here when the cache has no candidate
+			uint32_t scanPos = 0;
+			for (uint32_t out = 0; out < numTris; ++out) {
+				if (best == -1) {
+					bestScore = -1.0f;
+					while (scanPos < numTris && emitted[scanPos]) {
+						++scanPos;
+					}
+					for (uint32_t t = scanPos; t < numTris; ++t) {
+						if (!emitted[t] && triScores[t] > bestScore) {
+							bestScore = triScores[t];
+							best = t;
+						}
+					}
+				}
+				uint32_t tri = best;
+				emitted[tri] = true;
+				const uint32_t* ti = indices + tri * 3;
+				uint32_t newSize = 0;
+				for (int k = 0; k < 3; ++k) {
+					uint32_t v = ti[k];
+					result[out * 3 + k] = v;
+					CacheVertex& cv = verts[v];
+					// move the triangle behind the active ones
+					uint32_t* list = &vertexTris[cv.first];
+					for (uint32_t j = 0; j < cv.numActive; ++j) {
+						if (list[j] == tri) {
+							list[j] = list[cv.numActive - 1];
+							list[cv.numActive - 1] = tri;
+							break;
+						}
+					}
+					--cv.numActive;
+					// degenerated triangles use a vertex twice
+					if (k == 0 || (v != ti[0] && (k == 1 || v != ti[1]))) {
+						newCache[newSize++] = v;
+					}
+				}
+				for (uint32_t i = 0; i < cacheSize; ++i) {
+					uint32_t v = cache[i];
+					if (v != ti[0] && v != ti[1] && v != ti[2]) {
+						newCache[newSize++] = v;
+					}
+				}
+				// vertices pushed out of the cache
+				for (uint32_t i = CACHE_SIZE; i < newSize; ++i) {
+					CacheVertex& cv = verts[newCache[i]];
+					cv.cachePos = -1;
+					cv.score = vertexScore(-1, cv.numActive);
+				}
+				cacheSize = newSize < CACHE_SIZE ? newSize : CACHE_SIZE;
+				for (uint32_t i = 0; i < cacheSize; ++i) {
+					cache[i] = newCache[i];
+					CacheVertex& cv = verts[cache[i]];
+					cv.cachePos = i;
+					cv.score = vertexScore(i, cv.numActive);
+				}
+				// rescore the triangles of all cached vertices
+				best = -1;
+				bestScore = -1.0f;
+				for (uint32_t i = 0; i < newSize; ++i) {
+					const CacheVertex& cv = verts[newCache[i]];
+					for (uint32_t j = 0; j < cv.numActive; ++j) {
+						uint32_t t = vertexTris[cv.first + j];
+						float s = verts[indices[t * 3]].score + verts[indices[t * 3 + 1]].score + verts[indices[t * 3 + 2]].score;
+						triScores[t] = s;
+						if (i < cacheSize && s > bestScore) {
+							bestScore = s;
+							best = t;
+						}
+					}
+				}
+			}
+			memcpy(indices, result.data(), numTris * 3 * sizeof(uint32_t));
+		}
+
+		uint32_t optimizeVertexFetch(uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t* remap) {
+			for (uint32_t i = 0; i < numVertices; ++i) {
+				remap[i] = UINT32_MAX;
+			}
+			uint32_t cnt = 0;
+			for (uint32_t i = 0; i < numIndices; ++i) {
+				uint32_t v = indices[i];
+				if (remap[v] == UINT32_MAX) {
+					remap[v] = cnt++;
+				}
+				indices[i] = remap[v];
+			}
+			return cnt;
+		}
+
+		float computeACMR(const uint32_t* indices, uint32_t numIndices, uint32_t cacheSize) {
+			uint32_t numTris = numIndices / 3;
+			if (numTris == 0) {
+				return 0.0f;
+			}
+			// FIFO cache - the timestamp of a vertex tells if it is still inside
+			uint32_t maxIndex = 0;
+			for (uint32_t i = 0; i < numIndices; ++i) {
+				if (indices[i] > maxIndex) {
+					maxIndex = indices[i];
+				}
+			}
+			std::vector<uint32_t> stamps(maxIndex + 1, 0);
+			uint32_t time = cacheSize + 1;
+			uint32_t misses = 0;
+			for (uint32_t i = 0; i < numTris * 3; ++i) {
+				uint32_t v = indices[i];
+				if (time - stamps[v] > cacheSize) {
+					stamps[v] = time++;
+					++misses;
+				}
+			}
+			return (float)misses / numTris;
+		}
+
+	}
+
+}
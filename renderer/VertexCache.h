@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+
+namespace ds {
+
+	// -------------------------------------------------------
+	// Index buffer helpers. Everything works on raw arrays
+	// and does not depend on the core library so that the
+	// offline tools can use it as well.
+	// -------------------------------------------------------
+	namespace vcache {
+
+		// size of the simulated post transform cache
+		const uint32_t CACHE_SIZE = 32;
+
+		// -------------------------------------------------------
+		// welds all bitwise identical vertices. remap receives
+		// the new index for every vertex (num entries) and
+		// unique the source index of every new vertex. Returns
+		// the number of unique vertices.
+		// -------------------------------------------------------
+		uint32_t weldVertices(const void* vertices, uint32_t num, uint32_t stride, uint32_t* remap, uint32_t* unique);
+
+		// reorders the triangles for the post transform cache (Forsyth)
+		void optimizeVertexCache(uint32_t* indices, uint32_t numIndices, uint32_t numVertices);
+
+		// -------------------------------------------------------
+		// renumbers the vertices in order of first use. remap
+		// receives the new index of every vertex and indices
+		// are rewritten. Returns the number of used vertices.
+		// -------------------------------------------------------
+		uint32_t optimizeVertexFetch(uint32_t* indices, uint32_t numIndices, uint32_t numVertices, uint32_t* remap);
+
+		// average cache miss ratio - transformed vertices per triangle with a FIFO cache
+		float computeACMR(const uint32_t* indices, uint32_t numIndices, uint32_t cacheSize);
+
+	}
+
+}
@@ -0,0 +1,155 @@
+#include "VertexPacking.h"
+#include <emmintrin.h>
+
+namespace ds {
+
+	namespace vertex {
+
+		// -------------------------------------------------------
+		// float to half with round to nearest even (Fabian
+		// Giesen). Every lane holds one half in the lower 16
+		// bits and the sign extended into the upper ones so
+		// that _mm_packs_epi32 keeps the value.
+		// -------------------------------------------------------
+		static inline __m128i floatToHalf(__m128 f) {
+			const __m128i signMask = _mm_set1_epi32(0x80000000u);
+			const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+			const __m128i nanBit = _mm_set1_epi32(0x200);
+			const __m128i infinity = _mm_set1_epi32(0x7c00);
+			const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+			const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+			const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+			__m128 justSign = _mm_and_ps(_mm_castsi128_ps(signMask), f);
+			__m128 absf = _mm_xor_ps(f, justSign);
+			__m128i absi = _mm_castps_si128(absf);
+			__m128 isNaN = _mm_cmpunord_ps(absf, absf);
+			__m128i isRegular = _mm_cmpgt_epi32(f16max, absi);
+			__m128i infOrNaN = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNaN), nanBit), infinity);
+			__m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absi);
+			__m128 sub1 = _mm_add_ps(absf, _mm_castsi128_ps(subnormMagic));
+			__m128i sub2 = _mm_sub_epi32(_mm_castps_si128(sub1), subnormMagic);
+			__m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absi, 31 - 13), 31);
+			__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absi, normalBias), mantOdd), 13);
+			__m128i nonSpecial = _mm_or_si128(_mm_and_si128(sub2, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+			__m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, infOrNaN));
+			return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+		}
+
+		// every lane holds one half in the lower 16 bits
+		static inline __m128 halfToFloat(__m128i h) {
+			const __m128i noSign = _mm_set1_epi32(0x7fff);
+			const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+			const __m128i wasInfNaN = _mm_set1_epi32(0x7bff);
+			const __m128 expInfNaN = _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+			__m128i expMant = _mm_and_si128(noSign, h);
+			__m128i justSign = _mm_xor_si128(h, expMant);
+			__m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), magic);
+			__m128 infNaN = _mm_and_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(expMant, wasInfNaN)), expInfNaN);
+			return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(_mm_slli_epi32(justSign, 16)), infNaN));
+		}
+
+		static inline __m128 absVec(__m128 v) {
+			return _mm_andnot_ps(_mm_castsi128_ps(_mm_set1_epi32(0x80000000u)), v);
+		}
+
+		// 1 or -1 - zero counts as positive
+		static inline __m128 signNotZero(__m128 v) {
+			return _mm_or_ps(_mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x80000000u))), _mm_set1_ps(1.0f));
+		}
+
+		// -------------------------------------------------------
+		// octahedron encoding - returns (x, y, ?, ?)
+		// -------------------------------------------------------
+		static inline __m128 octEncode(__m128 n) {
+			__m128 a = absVec(n);
+			__m128 sum = _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)));
+			__m128 p = _mm_div_ps(n, _mm_max_ps(sum, _mm_set1_ps(1e-20f)));
+			__m128 yx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 2, 0, 1));
+			__m128 folded = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.0f), absVec(yx)), signNotZero(p));
+			__m128 lower = _mm_cmplt_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), _mm_setzero_ps());
+			return _mm_or_ps(_mm_and_ps(lower, folded), _mm_andnot_ps(lower, p));
+		}
+
+		// (x, y, ?, ?) to a normalized (x, y, z, 0)
+		static inline __m128 octDecode(__m128 e) {
+			__m128 a = absVec(e);
+			float z = 1.0f - _mm_cvtss_f32(a) - _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+			__m128 t = _mm_set1_ps(z < 0.0f ? -z : 0.0f);
+			// x += x >= 0 ? -t : t
+			__m128 xy = _mm_sub_ps(e, _mm_mul_ps(t, signNotZero(e)));
+			__m128 v = _mm_setr_ps(_mm_cvtss_f32(xy), _mm_cvtss_f32(_mm_shuffle_ps(xy, xy, _MM_SHUFFLE(1, 1, 1, 1))), z, 0.0f);
+			__m128 sq = _mm_mul_ps(v, v);
+			__m128 len = _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 2, 2, 2)));
+			return _mm_div_ps(v, _mm_sqrt_ps(len));
+		}
+
+		// -------------------------------------------------------
+		// pack
+		// -------------------------------------------------------
+		void pack(const PNTCVertex* src, PackedVertex* dest, uint32_t num) {
+			const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+			const __m128 oneW = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+			// snorm16 normal and unorm16 texture coordinates in one register
+			const __m128 ntMin = _mm_setr_ps(-1.0f, -1.0f, 0.0f, 0.0f);
+			const __m128 ntMax = _mm_set1_ps(1.0f);
+			const __m128 ntScale = _mm_setr_ps(32767.0f, 32767.0f, 65535.0f, 65535.0f);
+			// unsigned values are biased so that the signed saturation keeps them
+			const __m128i ntBias = _mm_setr_epi32(0, 0, 32768, 32768);
+			const __m128i ntFlip = _mm_setr_epi16(0, 0, (short)0x8000, (short)0x8000, 0, 0, 0, 0);
+			const __m128 colorScale = _mm_set1_ps(255.0f);
+			for (uint32_t i = 0; i < num; ++i) {
+				const PNTCVertex& v = src[i];
+				PackedVertex& d = dest[i];
+				__m128 p = _mm_or_ps(_mm_and_ps(_mm_setr_ps(v.position.x, v.position.y, v.position.z, 0.0f), xyzMask), oneW);
+				__m128i h = floatToHalf(p);
+				_mm_storel_epi64((__m128i*)d.position, _mm_packs_epi32(h, h));
+				__m128 oct = octEncode(_mm_setr_ps(v.normal.x, v.normal.y, v.normal.z, 0.0f));
+				__m128 nt = _mm_shuffle_ps(oct, _mm_setr_ps(v.texture.x, v.texture.y, 0.0f, 0.0f), _MM_SHUFFLE(1, 0, 1, 0));
+				nt = _mm_min_ps(_mm_max_ps(nt, ntMin), ntMax);
+				__m128i q = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(nt, ntScale)), ntBias);
+				q = _mm_xor_si128(_mm_packs_epi32(q, q), ntFlip);
+				// normal and texture are next to each other
+				_mm_storel_epi64((__m128i*)d.normal, q);
+				__m128 c = _mm_min_ps(_mm_max_ps(_mm_setr_ps(v.color.r, v.color.g, v.color.b, v.color.a), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+				__m128i ci = _mm_cvtps_epi32(_mm_mul_ps(c, colorScale));
+				ci = _mm_packs_epi32(ci, ci);
+				d.color = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(ci, ci));
+			}
+		}
+
+		// -------------------------------------------------------
+		// unpack
+		// -------------------------------------------------------
+		void unpack(const PackedVertex* src, PNTCVertex* dest, uint32_t num) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i signedMask = _mm_setr_epi32(-1, -1, 0, 0);
+			const __m128 ntScale = _mm_setr_ps(1.0f / 32767.0f, 1.0f / 32767.0f, 1.0f / 65535.0f, 1.0f / 65535.0f);
+			const __m128 ntMin = _mm_setr_ps(-1.0f, -1.0f, 0.0f, 0.0f);
+			const __m128 colorScale = _mm_set1_ps(1.0f / 255.0f);
+			float tmp[4];
+			for (uint32_t i = 0; i < num; ++i) {
+				const PackedVertex& s = src[i];
+				PNTCVertex& d = dest[i];
+				__m128 p = halfToFloat(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)s.position), zero));
+				_mm_storeu_ps(tmp, p);
+				d.position = v3(tmp[0], tmp[1], tmp[2]);
+				__m128i raw = _mm_unpacklo_epi16(zero, _mm_loadl_epi64((const __m128i*)s.normal));
+				__m128i ints = _mm_or_si128(_mm_and_si128(signedMask, _mm_srai_epi32(raw, 16)), _mm_andnot_si128(signedMask, _mm_srli_epi32(raw, 16)));
+				__m128 nt = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(ints), ntScale), ntMin);
+				_mm_storeu_ps(tmp, octDecode(nt));
+				d.normal = v3(tmp[0], tmp[1], tmp[2]);
+				_mm_storeu_ps(tmp, nt);
+				d.texture = v2(tmp[2], tmp[3]);
+				__m128i ci = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)s.color), zero), zero);
+				_mm_storeu_ps(tmp, _mm_mul_ps(_mm_cvtepi32_ps(ci), colorScale));
+				d.color = Color(tmp[0], tmp[1], tmp[2], tmp[3]);
+			}
+		}
+
+		uint32_t vertexSize(VertexFormat format) {
+			return format == VF_PACKED ? sizeof(PackedVertex) : sizeof(PNTCVertex);
+		}
+
+	}
+
+}
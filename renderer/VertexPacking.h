@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include "VertexTypes.h"
+
+namespace ds {
+
+	namespace vertex {
+
+		// -------------------------------------------------------
+		// Converts num vertices to the packed format using SSE2.
+		// Normals must be normalized and texture coordinates are
+		// clamped to 0..1.
+		// -------------------------------------------------------
+		void pack(const PNTCVertex* src, PackedVertex* dest, uint32_t num);
+
+		// -------------------------------------------------------
+		// Converts num packed vertices back. The normals are
+		// renormalized.
+		// -------------------------------------------------------
+		void unpack(const PackedVertex* src, PNTCVertex* dest, uint32_t num);
+
+		uint32_t vertexSize(VertexFormat format);
+
+	}
+
+}
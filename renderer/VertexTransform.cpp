@@ -0,0 +1,140 @@
+#include "VertexTransform.h"
+#include <xmmintrin.h>
+
+namespace ds {
+
+	namespace vertex {
+
+		// -------------------------------------------------------
+		// rows of the matrix as SSE registers
+		// -------------------------------------------------------
+		static void loadRows(const mat4& m, __m128* rows) {
+			rows[0] = _mm_setr_ps(m._11, m._12, m._13, m._14);
+			rows[1] = _mm_setr_ps(m._21, m._22, m._23, m._24);
+			rows[2] = _mm_setr_ps(m._31, m._32, m._33, m._34);
+			rows[3] = _mm_setr_ps(m._41, m._42, m._43, m._44);
+		}
+
+		// -------------------------------------------------------
+		// The inverse transpose of the upper 3x3 is the cofactor
+		// matrix divided by the determinant. Since the normals are
+		// renormalized only the sign of the determinant is used.
+		// -------------------------------------------------------
+		static void loadNormalRows(const mat4& m, __m128* rows) {
+			v3 r0 = v3(m._11, m._12, m._13);
+			v3 r1 = v3(m._21, m._22, m._23);
+			v3 r2 = v3(m._31, m._32, m._33);
+			v3 c0 = cross(r1, r2);
+			v3 c1 = cross(r2, r0);
+			v3 c2 = cross(r0, r1);
+			float s = dot(r0, c0) < 0.0f ? -1.0f : 1.0f;
+			rows[0] = _mm_setr_ps(c0.x * s, c0.y * s, c0.z * s, 0.0f);
+			rows[1] = _mm_setr_ps(c1.x * s, c1.y * s, c1.z * s, 0.0f);
+			rows[2] = _mm_setr_ps(c2.x * s, c2.y * s, c2.z * s, 0.0f);
+		}
+
+		static inline __m128 transformPoint(const __m128* rows, __m128 p) {
+			__m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+			__m128 y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 z = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 r = _mm_add_ps(_mm_mul_ps(x, rows[0]), _mm_mul_ps(y, rows[1]));
+			return _mm_add_ps(_mm_add_ps(r, _mm_mul_ps(z, rows[2])), rows[3]);
+		}
+
+		static inline __m128 transformNormal(const __m128* rows, __m128 n) {
+			__m128 x = _mm_shuffle_ps(n, n, _MM_SHUFFLE(0, 0, 0, 0));
+			__m128 y = _mm_shuffle_ps(n, n, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 z = _mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 2, 2, 2));
+			__m128 r = _mm_add_ps(_mm_mul_ps(x, rows[0]), _mm_mul_ps(y, rows[1]));
+			r = _mm_add_ps(r, _mm_mul_ps(z, rows[2]));
+			// normalize - rsqrt with one Newton-Raphson step
+			__m128 sq = _mm_mul_ps(r, r);
+			__m128 l = _mm_add_ss(sq, _mm_add_ss(_mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 2, 2, 2))));
+			l = _mm_max_ss(l, _mm_set_ss(1e-20f));
+			__m128 inv = _mm_rsqrt_ss(l);
+			inv = _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), inv), _mm_sub_ss(_mm_set_ss(3.0f), _mm_mul_ss(_mm_mul_ss(l, inv), inv)));
+			inv = _mm_shuffle_ps(inv, inv, _MM_SHUFFLE(0, 0, 0, 0));
+			return _mm_mul_ps(r, inv);
+		}
+
+		// -------------------------------------------------------
+		// transform vertices
+		// -------------------------------------------------------
+		void transform(const mat4& world, const PNTCVertex* src, PNTCVertex* dest, uint32_t num, const Color* color) {
+			__m128 rows[4];
+			__m128 normalRows[3];
+			loadRows(world, rows);
+			loadNormalRows(world, normalRows);
+			__m128 clr = color != 0 ? _mm_setr_ps(color->r, color->g, color->b, color->a) : _mm_set1_ps(1.0f);
+			for (uint32_t i = 0; i < num; ++i) {
+				// layout: position 0-2, normal 3-5, texture 6-7, color 8-11
+				const float* s = (const float*)(src + i);
+				float* d = (float*)(dest + i);
+				// load everything before storing so that src can be dest
+				__m128 p = _mm_loadu_ps(s);
+				__m128 n = _mm_loadu_ps(s + 3);
+				float u = s[6];
+				float v = s[7];
+				__m128 c = _mm_mul_ps(_mm_loadu_ps(s + 8), clr);
+				// every store overwrites the first float of the next field
+				// which is written afterwards
+				_mm_storeu_ps(d, transformPoint(rows, p));
+				_mm_storeu_ps(d + 3, transformNormal(normalRows, n));
+				d[6] = u;
+				d[7] = v;
+				_mm_storeu_ps(d + 8, c);
+			}
+		}
+
+		// -------------------------------------------------------
+		// transform positions
+		// -------------------------------------------------------
+		void transformPositions(const mat4& world, const v3* src, v3* dest, uint32_t num) {
+			__m128 rows[4];
+			loadRows(world, rows);
+			for (uint32_t i = 0; i < num; ++i) {
+				const float* s = (const float*)(src + i);
+				float* d = (float*)(dest + i);
+				__m128 p = _mm_setr_ps(s[0], s[1], s[2], 1.0f);
+				__m128 r = transformPoint(rows, p);
+				_mm_storel_pi((__m64*)d, r);
+				_mm_store_ss(d + 2, _mm_movehl_ps(r, r));
+			}
+		}
+
+		// -------------------------------------------------------
+		// bounds - the 4th lane holds normal.x and is ignored.
+		// Two vertices per step with separate registers so the
+		// min and max do not wait on each other.
+		// -------------------------------------------------------
+		void bounds(const PNTCVertex* vertices, uint32_t num, v3* min, v3* max) {
+			__m128 p = _mm_loadu_ps((const float*)vertices);
+			__m128 min0 = p;
+			__m128 max0 = p;
+			__m128 min1 = p;
+			__m128 max1 = p;
+			uint32_t i = 1;
+			for (; i + 1 < num; i += 2) {
+				__m128 a = _mm_loadu_ps((const float*)(vertices + i));
+				__m128 b = _mm_loadu_ps((const float*)(vertices + i + 1));
+				min0 = _mm_min_ps(min0, a);
+				max0 = _mm_max_ps(max0, a);
+				min1 = _mm_min_ps(min1, b);
+				max1 = _mm_max_ps(max1, b);
+			}
+			if (i < num) {
+				__m128 a = _mm_loadu_ps((const float*)(vertices + i));
+				min0 = _mm_min_ps(min0, a);
+				max0 = _mm_max_ps(max0, a);
+			}
+			float mn[4];
+			float mx[4];
+			_mm_storeu_ps(mn, _mm_min_ps(min0, min1));
+			_mm_storeu_ps(mx, _mm_max_ps(max0, max1));
+			*min = v3(mn[0], mn[1], mn[2]);
+			*max = v3(mx[0], mx[1], mx[2]);
+		}
+
+	}
+
+}
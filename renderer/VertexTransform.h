@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+#include "core\math\matrix.h"
+#include "core\graphics\Color.h"
+#include "VertexTypes.h"
+
+namespace ds {
+
+	namespace vertex {
+
+		// -------------------------------------------------------
+		// Transforms num vertices by world using SSE. Positions
+		// are transformed by world and normals by the inverse
+		// transpose of the upper 3x3 and renormalized. The vertex
+		// colors are multiplied by color if it is given.
+		// src and dest may be the same buffer.
+		// -------------------------------------------------------
+		void transform(const mat4& world, const PNTCVertex* src, PNTCVertex* dest, uint32_t num, const Color* color = 0);
+
+		// -------------------------------------------------------
+		// Transforms num positions by world using SSE
+		// -------------------------------------------------------
+		void transformPositions(const mat4& world, const v3* src, v3* dest, uint32_t num);
+
+		// -------------------------------------------------------
+		// min and max of all positions using SSE. num must be
+		// larger than 0.
+		// -------------------------------------------------------
+		void bounds(const PNTCVertex* vertices, uint32_t num, v3* min, v3* max);
+
+	}
+
+}
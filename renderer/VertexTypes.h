@@ -1,4 +1,5 @@
 #pragma once
+#include <stdint.h>
 #include <Vector.h>
 #include "core\graphics\Color.h"
 
@@ -35,6 +36,25 @@ namespace ds {
 		PNTCVertex(const v2& p, const v2& t, const Color& c) : position(p, 1.0f), texture(t), color(c) {}
 	};
 
+	// ------------------------------------------------------
+	// 20 byte version of PNTCVertex - see VertexPacking.h
+	//   position : half float (w = 1)
+	//   normal   : octahedron encoded snorm16
+	//   texture  : unorm16 - only 0..1 is supported
+	//   color    : RGBA8
+	// ------------------------------------------------------
+	struct PackedVertex {
+		uint16_t position[4];
+		int16_t normal[2];
+		uint16_t texture[2];
+		uint32_t color;
+	};
+
+	enum VertexFormat {
+		VF_PNTC,
+		VF_PACKED
+	};
+
 	struct SpriteVertex {
 
 		v3 position;
@@ -771,6 +771,67 @@ namespace graphics {
 		_context->d3dContext->IASetPrimitiveTopology(topology);
 	}
 
+	// ------------------------------------------------------
+	// caller owned vertex buffers
+	// ------------------------------------------------------
+	ID3D11Buffer* createVertexBuffer(const void* data, uint32_t size) {
+		D3D11_BUFFER_DESC bufferDesciption;
+		ZeroMemory(&bufferDesciption, sizeof(bufferDesciption));
+		bufferDesciption.Usage = D3D11_USAGE_DEFAULT;
+		bufferDesciption.CPUAccessFlags = 0;
+		bufferDesciption.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bufferDesciption.ByteWidth = size;
+		ID3D11Buffer* buffer = 0;
+		HRESULT d3dResult;
+		if (data != 0) {
+			D3D11_SUBRESOURCE_DATA resource;
+			resource.pSysMem = data;
+			resource.SysMemPitch = 0;
+			resource.SysMemSlicePitch = 0;
+			d3dResult = _context->d3dDevice->CreateBuffer(&bufferDesciption, &resource, &buffer);
+		}
+		else {
+			d3dResult = _context->d3dDevice->CreateBuffer(&bufferDesciption, 0, &buffer);
+		}
+		if (FAILED(d3dResult)) {
+			LOGE << "Failed to create vertex buffer - size: " << size;
+			return 0;
+		}
+		return buffer;
+	}
+
+	void updateVertexBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size) {
+		D3D11_BOX box;
+		box.left = 0;
+		box.right = size;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		_context->d3dContext->UpdateSubresource(buffer, 0, &box, data, 0, 0);
+	}
+
+	void releaseVertexBuffer(ID3D11Buffer* buffer) {
+		if (buffer != 0) {
+			buffer->Release();
+		}
+	}
+
+	void setVertexBuffer(ID3D11Buffer* buffer, RID inputLayout, uint32_t* stride, uint32_t* offset, D3D11_PRIMITIVE_TOPOLOGY topology) {
+		ID3D11InputLayout* layout = ds::res::getInputLayout(inputLayout);
+		_context->d3dContext->IASetInputLayout(layout);
+		_context->d3dContext->IASetVertexBuffers(0, 1, &buffer, stride, offset);
+		_context->d3dContext->IASetPrimitiveTopology(topology);
+	}
+
+	void setInstanceBuffer(RID rid, uint32_t* stride, uint32_t* offset) {
+		ds::VertexBufferResource* res = static_cast<ds::VertexBufferResource*>(ds::res::getResource(rid, ds::ResourceType::VERTEXBUFFER));
+		ID3D11InputLayout* layout = ds::res::getInputLayout(res->getInputLayout());
+		_context->d3dContext->IASetInputLayout(layout);
+		ID3D11Buffer* buffer = res->get();
+		_context->d3dContext->IASetVertexBuffers(1, 1, &buffer, stride, offset);
+	}
+
 	void setVertexShaderConstantBuffer(RID rid) {
 		ID3D11Buffer* buffer = ds::res::getConstantBuffer(rid);
 		_context->d3dContext->VSSetConstantBuffers(0, 1, &buffer);
@@ -790,6 +851,14 @@ namespace graphics {
 		_context->d3dContext->DrawIndexed(num, 0, 0);
 	}
 
+	void drawIndexed(uint32_t num, uint32_t baseVertex) {
+		_context->d3dContext->DrawIndexed(num, 0, baseVertex);
+	}
+
+	void drawIndexedInstanced(uint32_t num, uint32_t instances) {
+		_context->d3dContext->DrawIndexedInstanced(num, instances, 0, 0, 0);
+	}
+
 	void draw(uint32_t num) {
 		_context->d3dContext->Draw(num, 0);
 	}
@@ -864,6 +933,10 @@ namespace graphics {
 		return _context->viewports[idx];
 	}
 
+	const ds::Viewport& getSelectedViewport() {
+		return _context->viewports[_context->selectedViewport];
+	}
+
 	// ------------------------------------------------------
 	// end rendering
 	// ------------------------------------------------------
@@ -81,6 +81,18 @@ namespace graphics {
 
 	void setVertexBuffer(RID rid, uint32_t* stride, uint32_t* offset, D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+	// vertex buffer in video memory owned by the caller - only changed by updateVertexBuffer
+	ID3D11Buffer* createVertexBuffer(const void* data, uint32_t size);
+
+	void updateVertexBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size);
+
+	void releaseVertexBuffer(ID3D11Buffer* buffer);
+
+	void setVertexBuffer(ID3D11Buffer* buffer, RID inputLayout, uint32_t* stride, uint32_t* offset, D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	// binds the buffer to input slot 1 and selects its input layout - call after setVertexBuffer
+	void setInstanceBuffer(RID rid, uint32_t* stride, uint32_t* offset);
+
 	void mapData(RID rid, void* data, uint32_t size);
 
 	void setShader(RID rid);
@@ -103,6 +115,10 @@ namespace graphics {
 
 	void drawIndexed(uint32_t num);
 
+	void drawIndexed(uint32_t num, uint32_t baseVertex);
+
+	void drawIndexedInstanced(uint32_t num, uint32_t instances);
+
 	void draw(uint32_t num);
 
 	void endRendering();
@@ -129,6 +145,8 @@ namespace graphics {
 
 	const ds::Viewport& getViewport(int idx);
 
+	const ds::Viewport& getSelectedViewport();
+
 	void selectViewport(int idx);
 
 	void selectBlendState(RID rid);
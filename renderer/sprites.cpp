@@ -8,10 +8,12 @@
 #include "core\log\Log.h"
 #include "core\profiler\Profiler.h"
 #include "..\stats\DrawCounter.h"
+#include "Culling.h"
+#include "..\utils\font.h"
 
 namespace ds {
 
-	SpriteBuffer::SpriteBuffer(const SpriteBufferDescriptor& descriptor) : _descriptor(descriptor), _index(0), _started(false) {
+	SpriteBuffer::SpriteBuffer(const SpriteBufferDescriptor& descriptor) : _descriptor(descriptor), _index(0), _started(false), _culling(true), _visible(0), _visibleCapacity(0) {
 		// create data
 		_maxSprites = descriptor.size;
 		_sprites = new Sprite[descriptor.size];
@@ -25,9 +27,72 @@ namespace ds {
 	SpriteBuffer::~SpriteBuffer() {
 		delete[] _sprites;
 		delete[] _vertices;
+		if (_visible != 0) {
+			delete[] _visible;
+		}
+	}
+
+	// ------------------------------------------------------
+	// scratch buffer for the indices of all visible sprites
+	// ------------------------------------------------------
+	uint32_t* SpriteBuffer::getVisibleIndices(uint32_t num) {
+		if (num > _visibleCapacity) {
+			if (_visible != 0) {
+				delete[] _visible;
+			}
+			_visibleCapacity = num * 2;
+			_visible = new uint32_t[_visibleCapacity];
+		}
+		return _visible;
 	}
 
-	void SpriteBuffer::draw(const EntityArray & array) {
+	// ------------------------------------------------------
+	// draw all active entities inside the visible area
+	// ------------------------------------------------------
+	void SpriteBuffer::draw(const EntityArray& array) {
+		ZoneTracker z("SpriteBuffer::drawEntities");
+		if (_culling) {
+			uint32_t* visible = getVisibleIndices(array.num);
+			uint32_t tested = 0;
+			uint32_t cnt = culling::cullSprites(culling::getVisibleArea(), array.positions, array.scales, array.rotations, array.textures, array.active, array.num, visible, &tested);
+			for (uint32_t i = 0; i < cnt; ++i) {
+				int idx = visible[i];
+				draw(array.positions[idx].xy(), array.textures[idx], array.rotations[idx].z, array.scales[idx].xy(), array.colors[idx], array.materials[idx]);
+			}
+			gDrawCounter->visibleSprites += cnt;
+			gDrawCounter->culledSprites += tested - cnt;
+		}
+		else {
+			for (int i = 0; i < array.num; ++i) {
+				if (array.active[i]) {
+					draw(array.positions[i].xy(), array.textures[i], array.rotations[i].z, array.scales[i].xy(), array.colors[i], array.materials[i]);
+					++gDrawCounter->visibleSprites;
+				}
+			}
+		}
+	}
+
+	// ------------------------------------------------------
+	// draw all sprites inside the visible area
+	// ------------------------------------------------------
+	void SpriteBuffer::draw(const SpriteArray& array) {
+		ZoneTracker z("SpriteBuffer::drawSprites");
+		if (_culling) {
+			uint32_t* visible = getVisibleIndices(array.num);
+			uint32_t cnt = culling::cullSprites(culling::getVisibleArea(), array.positions, array.scales, array.rotations, array.textures, array.num, visible);
+			for (uint32_t i = 0; i < cnt; ++i) {
+				int idx = visible[i];
+				draw(array.positions[idx], array.textures[idx], array.rotations[idx], array.scales[idx], array.colors[idx]);
+			}
+			gDrawCounter->visibleSprites += cnt;
+			gDrawCounter->culledSprites += array.num - cnt;
+		}
+		else {
+			for (int i = 0; i < array.num; ++i) {
+				draw(array.positions[i], array.textures[i], array.rotations[i], array.scales[i], array.colors[i]);
+			}
+			gDrawCounter->visibleSprites += array.num;
+		}
 	}
 
 	void SpriteBuffer::draw(const Sprite& sprite) {
@@ -78,34 +143,15 @@ namespace ds {
 	}
 
 	void SpriteBuffer::drawText(RID fontID, int x, int y, const char* text, int padding, float scaleX, float scaleY, const Color& color) {
-		ds::Bitmapfont* font = ds::res::getFont(fontID);
-		int len = strlen(text);
-		for (int cnt = 0; cnt < len; ++cnt) {
-			char c = text[cnt];
-			const ds::Texture& t = font->get(c);
-			float dimX = t.dim.x * scaleX;
-			float dimY = t.dim.y * scaleY;
-			draw(v2(x + dimX * 0.5f, y + dimY * 0.5f), t, 0.0f, v2(scaleX, scaleY), color);
-			x += dimX + padding;
+		const font::TextRun& run = font::getTextRun(fontID, text, padding, scaleX, scaleY);
+		for (uint32_t i = 0; i < run.glyphs.size(); ++i) {
+			const font::Glyph& g = run.glyphs[i];
+			draw(v2(x + g.offset.x, y + g.offset.y), g.texture, 0.0f, v2(scaleX, scaleY), color);
 		}
 	}
 
 	v2 SpriteBuffer::getTextSize(RID fontID, const char* text, int padding, float scaleX, float scaleY) {
-		ds::Bitmapfont* font = ds::res::getFont(fontID);
-		v2 ret;
-		int x = 0;
-		int len = strlen(text);
-		for (int cnt = 0; cnt < len; ++cnt) {
-			char c = text[cnt];
-			const ds::Texture& t = font->get(c);
-			float dimX = t.dim.x * scaleX;
-			float dimY = t.dim.y * scaleY;
-			if (dimY > ret.y) {
-				ret.y = dimY;
-			}
-			ret.x += dimX + padding;
-		}
-		return ret;
+		return font::getTextRun(fontID, text, padding, scaleX, scaleY).size;
 	}
 
 	void SpriteBuffer::drawTiledXY(const v2& position, const v2& size, const Texture& texture, float cornersize, const Color& color) {
@@ -8,6 +8,7 @@
 #include "..\sprites\Sprite.h"
 #include "VertexTypes.h"
 #include "..\scene\EntityArray.h"
+#include "..\sprites\SpriteArray.h"
 
 namespace ds {
 
@@ -17,6 +18,7 @@ namespace ds {
 		SpriteBuffer(const SpriteBufferDescriptor& descriptor);
 		~SpriteBuffer();
 		void draw(const EntityArray& array);
+		void draw(const SpriteArray& array);
 		void draw(const v2& position, const ds::Texture& texture, float rotation = 0.0f, const v2& scale = v2(1, 1), const Color& color = Color(255, 255, 255, 255), RID material = INVALID_RID);
 		void draw(const p2i& position, const ds::Texture& texture, float rotation = 0.0f, const v2& scale = v2(1, 1), const Color& color = Color(255, 255, 255, 255), RID material = INVALID_RID);
 		void draw(const Sprite& sprite);
@@ -28,6 +30,12 @@ namespace ds {
 		void end();
 		v2 getTextSize(RID fontID, const char* text, int padding = 4, float scaleX = 1.0f, float scaleY = 1.0f);
 		void drawScreenQuad(RID material);
+		void setCulling(bool culling) {
+			_culling = culling;
+		}
+		bool isCulling() const {
+			return _culling;
+		}
 		RID getCurrentMaterial() const {
 			return _currentMtrl;
 		}
@@ -39,6 +47,7 @@ namespace ds {
 		}
 	private:
 		void flush();
+		uint32_t* getVisibleIndices(uint32_t num);
 		int _index;
 		RID _currentMtrl;
 		SpriteBufferDescriptor _descriptor;
@@ -46,6 +55,9 @@ namespace ds {
 		SpriteVertex* _vertices;
 		int _maxSprites;
 		bool _started;
+		bool _culling;
+		uint32_t* _visible;
+		uint32_t _visibleCapacity;
 		//v4 _screenDimension;
 		SpriteBufferCB _constantBuffer;
 	};
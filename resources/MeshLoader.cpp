@@ -0,0 +1,287 @@
+#include "MeshLoader.h"
+#include "..\renderer\MeshLOD.h"
+#include "core\log\Log.h"
+#include "core\profiler\Profiler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <float.h>
+#include <stdio.h>
+
+namespace ds {
+
+	namespace loader {
+
+		struct LoadRequest {
+			Mesh* mesh;
+			char fileName[256];
+			uint32_t lods;
+		};
+
+		// filled by the worker
+		struct LoadResult {
+			LoadRequest request;
+			MeshFile file;
+			LODLevels* levels;
+		};
+
+		struct LoaderContext {
+			std::thread worker;
+			std::mutex mutex;
+			std::condition_variable wakeUp;
+			std::condition_variable finished;
+			std::deque<LoadRequest> requests;
+			std::vector<LoadResult*> completed;
+			bool running;
+			// main thread only
+			std::deque<LoadResult*> ready;
+			uint32_t pending;
+			// every mesh replaced by update - the index is the generation
+			std::vector<const Mesh*> replaced;
+		};
+
+		static LoaderContext* _loaderCtx = 0;
+
+		// ------------------------------------------------------
+		// decode - reads the file like Mesh::load. The LOD
+		// levels are computed here as well.
+		// ------------------------------------------------------
+		static void decode(LoadResult* result) {
+			result->levels = 0;
+			readMeshFile(result->request.fileName, &result->file);
+			const std::vector<PNTCVertex>& vertices = result->file.vertices;
+			if (result->request.lods > 1 && !vertices.empty()) {
+				result->levels = lod::compute(&vertices[0], vertices.size(), result->request.lods);
+			}
+		}
+
+		static void work() {
+			LoaderContext* ctx = _loaderCtx;
+			for (;;) {
+				LoadRequest request;
+				{
+					std::unique_lock<std::mutex> lock(ctx->mutex);
+					ctx->wakeUp.wait(lock, [ctx] { return !ctx->running || !ctx->requests.empty(); });
+					if (!ctx->running) {
+						return;
+					}
+					request = ctx->requests.front();
+					ctx->requests.pop_front();
+				}
+				LoadResult* result = new LoadResult;
+				result->request = request;
+				decode(result);
+				{
+					std::lock_guard<std::mutex> lock(ctx->mutex);
+					ctx->completed.push_back(result);
+				}
+				ctx->finished.notify_all();
+			}
+		}
+
+		// ------------------------------------------------------
+		// placeholder - the cube of MeshGen::add_cube
+		// ------------------------------------------------------
+		static void buildPlaceholder(Mesh* mesh) {
+			const v3 p[] = {
+				v3(-0.5f, 0.5f, 0.5f), v3(0.5f, 0.5f, 0.5f), v3(0.5f, 0.5f, -0.5f), v3(-0.5f, 0.5f, -0.5f),
+				v3(-0.5f, -0.5f, 0.5f), v3(0.5f, -0.5f, 0.5f), v3(0.5f, -0.5f, -0.5f), v3(-0.5f, -0.5f, -0.5f)
+			};
+			const int indices[] = { 3, 2, 6, 7, 2, 1, 5, 6, 1, 0, 4, 5, 0, 3, 7, 4, 0, 1, 2, 3, 5, 4, 7, 6 };
+			const v2 uv[] = { v2(0.0f, 0.0f), v2(1.0f, 0.0f), v2(1.0f, 1.0f), v2(0.0f, 1.0f) };
+			mesh->clear();
+			for (int j = 0; j < 6; ++j) {
+				const int* f = indices + j * 4;
+				v3 n = normalize(cross(p[f[1]] - p[f[0]], p[f[3]] - p[f[0]]));
+				for (int i = 0; i < 4; ++i) {
+					mesh->add(p[f[i]], n, uv[i]);
+				}
+			}
+			mesh->boundingBox.position = v3(0.0f, 0.0f, 0.0f);
+			mesh->boundingBox.extent = v3(0.5f, 0.5f, 0.5f);
+		}
+
+		// ------------------------------------------------------
+		// apply - main thread part of the loading
+		// ------------------------------------------------------
+		static void apply(LoadResult* result) {
+			const LoadRequest& request = result->request;
+			Mesh* mesh = request.mesh;
+			if (result->file.found) {
+				// an unsupported version keeps the placeholder
+				if (result->file.supported()) {
+					mesh->clear();
+				}
+				assignMeshFile(mesh, result->file, request.fileName);
+			}
+			else {
+				mesh->clear();
+				LOGE << "Cannot load mesh '" << request.fileName << "'";
+			}
+			lod::assign(mesh, result->levels);
+			mesh->loading = false;
+		}
+
+		// ------------------------------------------------------
+		// drain - applies finished meshes until the budget in
+		// milliseconds is used up. At least one mesh is applied.
+		// ------------------------------------------------------
+		static uint32_t drain(float budget) {
+			LoaderContext* ctx = _loaderCtx;
+			{
+				std::lock_guard<std::mutex> lock(ctx->mutex);
+				for (size_t i = 0; i < ctx->completed.size(); ++i) {
+					ctx->ready.push_back(ctx->completed[i]);
+				}
+				ctx->completed.clear();
+			}
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			uint32_t num = 0;
+			float used = 0.0f;
+			while (!ctx->ready.empty() && (num == 0 || used < budget)) {
+				LoadResult* result = ctx->ready.front();
+				ctx->ready.pop_front();
+				apply(result);
+				ctx->replaced.push_back(result->request.mesh);
+				delete result;
+				++num;
+				used = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+			ctx->pending -= num;
+			return num;
+		}
+
+		void initialize() {
+			if (_loaderCtx == 0) {
+				_loaderCtx = new LoaderContext;
+				_loaderCtx->running = true;
+				_loaderCtx->pending = 0;
+				_loaderCtx->worker = std::thread(work);
+				LOG << "mesh loader started";
+			}
+		}
+
+		void shutdown() {
+			if (_loaderCtx != 0) {
+				{
+					std::lock_guard<std::mutex> lock(_loaderCtx->mutex);
+					_loaderCtx->running = false;
+				}
+				_loaderCtx->wakeUp.notify_all();
+				_loaderCtx->worker.join();
+				// finished meshes are still applied since they own the LOD levels
+				drain(FLT_MAX);
+				for (size_t i = 0; i < _loaderCtx->requests.size(); ++i) {
+					_loaderCtx->requests[i].mesh->loading = false;
+				}
+				delete _loaderCtx;
+				_loaderCtx = 0;
+			}
+		}
+
+		// ------------------------------------------------------
+		// load
+		// ------------------------------------------------------
+		void load(Mesh* mesh, const char* fileName, uint32_t lods) {
+			if (_loaderCtx == 0) {
+				mesh->load(fileName);
+				if (lods > 1) {
+					lod::build(mesh, lods);
+				}
+				return;
+			}
+			LoadRequest request;
+			request.mesh = mesh;
+			request.lods = lods;
+			sprintf_s(request.fileName, 256, "content\\meshes\\%s.mesh", fileName);
+			buildPlaceholder(mesh);
+			mesh->loading = true;
+			++_loaderCtx->pending;
+			{
+				std::lock_guard<std::mutex> lock(_loaderCtx->mutex);
+				_loaderCtx->requests.push_back(request);
+			}
+			_loaderCtx->wakeUp.notify_one();
+		}
+
+		// ------------------------------------------------------
+		// update
+		// ------------------------------------------------------
+		uint32_t update() {
+			if (_loaderCtx == 0 || _loaderCtx->pending == 0) {
+				return 0;
+			}
+			ZoneTracker z("loader::update");
+			return drain(MAX_LOADER_TIME);
+		}
+
+		// ------------------------------------------------------
+		// blocks until the worker has finished something
+		// ------------------------------------------------------
+		static void waitForWorker() {
+			if (_loaderCtx->ready.empty()) {
+				std::unique_lock<std::mutex> lock(_loaderCtx->mutex);
+				_loaderCtx->finished.wait(lock, [] { return !_loaderCtx->completed.empty(); });
+			}
+		}
+
+		// ------------------------------------------------------
+		// wait - the mesh is moved to the front of the queue
+		// ------------------------------------------------------
+		void wait(Mesh* mesh) {
+			if (_loaderCtx == 0 || !mesh->loading) {
+				return;
+			}
+			ZoneTracker z("loader::wait");
+			{
+				std::lock_guard<std::mutex> lock(_loaderCtx->mutex);
+				std::deque<LoadRequest>& requests = _loaderCtx->requests;
+				for (size_t i = 0; i < requests.size(); ++i) {
+					if (requests[i].mesh == mesh) {
+						LoadRequest request = requests[i];
+						requests.erase(requests.begin() + i);
+						requests.push_front(request);
+						break;
+					}
+				}
+			}
+			while (mesh->loading) {
+				waitForWorker();
+				drain(FLT_MAX);
+			}
+		}
+
+		void waitAll() {
+			if (_loaderCtx == 0) {
+				return;
+			}
+			ZoneTracker z("loader::waitAll");
+			while (_loaderCtx->pending > 0) {
+				waitForWorker();
+				drain(FLT_MAX);
+			}
+		}
+
+		uint32_t numPending() {
+			return _loaderCtx != 0 ? _loaderCtx->pending : 0;
+		}
+
+		uint32_t generation() {
+			return _loaderCtx != 0 ? (uint32_t)_loaderCtx->replaced.size() : 0;
+		}
+
+		const Mesh* const* replaced(uint32_t generation, uint32_t* num) {
+			if (_loaderCtx == 0 || generation >= _loaderCtx->replaced.size()) {
+				*num = 0;
+				return 0;
+			}
+			*num = (uint32_t)_loaderCtx->replaced.size() - generation;
+			return &_loaderCtx->replaced[generation];
+		}
+
+	}
+
+}
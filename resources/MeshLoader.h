@@ -0,0 +1,59 @@
+#pragma once
+#include "..\renderer\MeshBuffer.h"
+
+namespace ds {
+
+	// milliseconds update may spend per frame - at least one mesh is applied
+	const float MAX_LOADER_TIME = 2.0f;
+
+	// ------------------------------------------------------
+	// Background mesh loading. The files are read and decoded
+	// on a worker thread and handed back through a completion
+	// queue that update drains once per frame. Until then the
+	// mesh is a placeholder cube. A file with an unsupported
+	// version keeps it. The Mesh pointer does not change so
+	// entities can use it right away. Without initialize
+	// every mesh is loaded on the calling thread.
+	// ------------------------------------------------------
+	namespace loader {
+
+		void initialize();
+
+		// finished meshes are applied - queued ones are dropped
+		// and keep the placeholder
+		void shutdown();
+
+		// queues content\meshes\<fileName>.mesh - lods > 1
+		// builds the LOD levels once the file is loaded
+		void load(Mesh* mesh, const char* fileName, uint32_t lods = 1);
+
+		// moves finished meshes into place on the main thread
+		// within MAX_LOADER_TIME and returns their number
+		uint32_t update();
+
+		// blocks until the mesh is loaded
+		void wait(Mesh* mesh);
+
+		// blocks until all queued meshes are loaded
+		void waitAll();
+
+		inline bool isReady(const Mesh* mesh) {
+			return !mesh->loading;
+		}
+
+		uint32_t numPending();
+
+		// ------------------------------------------------------
+		// number of meshes update has replaced so far. Anything
+		// built from a placeholder (bounds) has to be refreshed
+		// for the meshes replaced since it was built.
+		// ------------------------------------------------------
+		uint32_t generation();
+
+		// the meshes replaced since generation in the order they
+		// were applied - num is set to their number
+		const Mesh* const* replaced(uint32_t generation, uint32_t* num);
+
+	}
+
+}
@@ -42,7 +42,7 @@ namespace ds {
 	class InputLayoutResource : public AbstractResource<ID3D11InputLayout*> {
 
 	public:
-		InputLayoutResource(ID3D11InputLayout* t,int size) : AbstractResource(t) , _size(size) {}
+		InputLayoutResource(ID3D11InputLayout* t,int size,int instanceSize = 0) : AbstractResource(t) , _size(size) , _instanceSize(instanceSize) {}
 		virtual ~InputLayoutResource() {
 			if (_data != 0) {
 				_data->Release();
@@ -52,8 +52,13 @@ namespace ds {
 		int size() const {
 			return _size;
 		}
+		// size of the per instance elements (input slot 1)
+		int instanceSize() const {
+			return _instanceSize;
+		}
 	private:
 		int _size;
+		int _instanceSize;
 	};
 
 	class VertexBufferResource : public AbstractResource<ID3D11Buffer*> {
@@ -8,6 +8,7 @@
 #include "core\log\Log.h"
 #include "..\renderer\render_types.h"
 #include "..\imgui\IMGUI.h"
+#include "..\utils\font.h"
 #include "core\base\Assert.h"
 #include "Resource.h"
 #include "core\string\StaticHash.h"
@@ -58,6 +59,7 @@ namespace ds {
 			for (size_t i = 0; i < _resCtx->resources.size(); ++i) {
 				delete _resCtx->resources[i];
 			}
+			font::clearTextCache();
 
 			gui::shutdown();
 			delete _resCtx;
@@ -492,6 +494,19 @@ namespace ds {
 			return res->get();
 		}
 
+		RID findMesh(const Mesh* mesh) {
+			for (uint32_t i = 0; i < _resCtx->indices.size(); ++i) {
+				const ResourceIndex& res_idx = _resCtx->indices[i];
+				if (res_idx.type == ResourceType::MESH) {
+					MeshResource* res = static_cast<MeshResource*>(_resCtx->resources[res_idx.id]);
+					if (res->get() == mesh) {
+						return res_idx.id;
+					}
+				}
+			}
+			return INVALID_RID;
+		}
+
 		RenderTarget* getRenderTarget(RID rid) {
 			const ResourceIndex& res_idx = _resCtx->indices[rid];
 			XASSERT(res_idx.type == ResourceType::RENDERTARGET, "Different resource types - expected RENDERTARGET but found %s", ResourceTypeNames[res_idx.type]);
@@ -211,6 +211,9 @@ namespace ds {
 
 		Mesh* getMesh(const char* name);
 
+		// RID of a mesh resource or INVALID_RID if the mesh was not loaded as resource
+		RID findMesh(const Mesh* mesh);
+
 		SquareBuffer* getSquareBuffer(RID rid);
 
 		SkyBox* getSkyBox(const char* name);
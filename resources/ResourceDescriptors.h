@@ -6,6 +6,7 @@
 #include <Vector.h>
 #include "core\string\StaticHash.h"
 #include "core\graphics\Color.h"
+#include "..\renderer\VertexTypes.h"
 
 namespace ds {
 
@@ -43,8 +44,10 @@ namespace ds {
 		RID layout;
 		void* data;
 		int dataSize;
+		// size is the number of instances and the buffer holds the per instance elements of the layout
+		bool instanced;
 
-		VertexBufferDescriptor() : size(0), dynamic(false), layout(INVALID_RID), data(0), dataSize(0) {}
+		VertexBufferDescriptor() : size(0), dynamic(false), layout(INVALID_RID), data(0), dataSize(0), instanced(false) {}
 	};
 
 	struct ShaderDescriptor {
@@ -142,6 +145,11 @@ namespace ds {
 		//RID colormap;
 		//RID inputlayout;
 		RID material;
+		// optional - instanced drawing is only available if both are set
+		RID instanceBuffer;
+		RID instanceShader;
+		// optional - VF_PACKED needs an input layout and shader for PackedVertex
+		VertexFormat format;
 	};
 
 	struct MeshDescriptor {
@@ -149,6 +157,8 @@ namespace ds {
 		v3 position;
 		v3 scale;
 		v3 rotation;
+		// number of LOD levels including the mesh - 1 means no LODs
+		uint32_t lods;
 	};
 
 	struct SpriteSheetDescriptor {
@@ -1,4 +1,5 @@
 #include "FontParser.h"
+#include "..\..\utils\font.h"
 
 namespace ds {
 
@@ -45,6 +46,8 @@ namespace ds {
 			}
 			BitmapfontResource* cbr = new BitmapfontResource(font);
 			_resCtx->resources.push_back(cbr);
+			// cached text runs may point to the textures of a previous font
+			ds::font::clearTextCache();
 			return create(name, ResourceType::BITMAPFONT);
 		}
 
@@ -9,27 +9,39 @@ namespace ds {
 			const char* semantic;
 			DXGI_FORMAT format;
 			uint32_t size;
+			// 0 = per vertex / 1 = per instance
+			uint32_t slot;
 
-			InputElementDescriptor(const char* sem, DXGI_FORMAT f, uint32_t s) :
-				semantic(sem), format(f), size(s) {
+			InputElementDescriptor(const char* sem, DXGI_FORMAT f, uint32_t s, uint32_t sl) :
+				semantic(sem), format(f), size(s), slot(sl) {
 			}
 		};
 
 		static const InputElementDescriptor INPUT_ELEMENT_DESCRIPTIONS[] = {
 
-			{ "POSITION", DXGI_FORMAT_R32G32B32_FLOAT, 12 },
-			{ "COLOR", DXGI_FORMAT_R32G32B32A32_FLOAT, 16 },
-			{ "TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 8 },
-			{ "NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, 12 }
+			{ "POSITION", DXGI_FORMAT_R32G32B32_FLOAT, 12, 0 },
+			{ "COLOR", DXGI_FORMAT_R32G32B32A32_FLOAT, 16, 0 },
+			{ "TEXCOORD", DXGI_FORMAT_R32G32_FLOAT, 8, 0 },
+			{ "NORMAL", DXGI_FORMAT_R32G32B32_FLOAT, 12, 0 },
+			// PackedVertex
+			{ "HALFPOSITION", DXGI_FORMAT_R16G16B16A16_FLOAT, 8, 0 },
+			{ "OCTNORMAL", DXGI_FORMAT_R16G16_SNORM, 4, 0 },
+			{ "UNORMTEXCOORD", DXGI_FORMAT_R16G16_UNORM, 4, 0 },
+			{ "UNORMCOLOR", DXGI_FORMAT_R8G8B8A8_UNORM, 4, 0 },
+			// one row of the instance world matrix - use it four times
+			{ "WORLD", DXGI_FORMAT_R32G32B32A32_FLOAT, 16, 1 },
+			{ "INSTANCECOLOR", DXGI_FORMAT_R32G32B32A32_FLOAT, 16, 1 }
 		};
 
+		static const int NUM_INPUT_ELEMENTS = sizeof(INPUT_ELEMENT_DESCRIPTIONS) / sizeof(InputElementDescriptor);
+
 
 
 		// ------------------------------------------------------
 		// find inputelement by name
 		// ------------------------------------------------------
 		static int findInputElement(const char* name) {
-			for (int i = 0; i < 4; ++i) {
+			for (int i = 0; i < NUM_INPUT_ELEMENTS; ++i) {
 				if (strcmp(INPUT_ELEMENT_DESCRIPTIONS[i].semantic, name) == 0) {
 					return i;
 				}
@@ -39,7 +51,8 @@ namespace ds {
 
 		RID InputLayoutParser::createInputLayout(const char* name, const InputLayoutDescriptor& descriptor) {
 			D3D11_INPUT_ELEMENT_DESC* descriptors = new D3D11_INPUT_ELEMENT_DESC[descriptor.num];
-			uint32_t index = 0;
+			// byte offset per input slot
+			uint32_t offsets[2] = { 0 };
 			uint32_t counter = 0;
 			int si[8] = { 0 };
 			for (int i = 0; i < descriptor.num; ++i) {
@@ -48,11 +61,17 @@ namespace ds {
 				desc.SemanticName = d.semantic;
 				desc.SemanticIndex = si[descriptor.indices[i]];// d.semanticIndex;
 				desc.Format = d.format;
-				desc.InputSlot = 0;
-				desc.AlignedByteOffset = index;
-				desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-				desc.InstanceDataStepRate = 0;
-				index += d.size;
+				desc.InputSlot = d.slot;
+				desc.AlignedByteOffset = offsets[d.slot];
+				if (d.slot == 0) {
+					desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+					desc.InstanceDataStepRate = 0;
+				}
+				else {
+					desc.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+					desc.InstanceDataStepRate = 1;
+				}
+				offsets[d.slot] += d.size;
 				si[descriptor.indices[i]] += 1;
 			}
 			ID3D11InputLayout* layout = 0;
@@ -70,7 +89,7 @@ namespace ds {
 				}
 			}
 			delete[] descriptors;
-			InputLayoutResource* ilr = new InputLayoutResource(layout, index);
+			InputLayoutResource* ilr = new InputLayoutResource(layout, offsets[0], offsets[1]);
 			_resCtx->resources.push_back(ilr);
 			return create(name, ResourceType::INPUTLAYOUT);
 		}
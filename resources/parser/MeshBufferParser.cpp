@@ -22,6 +22,26 @@ namespace ds {
 			descriptor.vertexBuffer = find(vertexBufferName, ResourceType::VERTEXBUFFER);
 			const char* materialName = reader.get_string(childIndex, "material");
 			descriptor.material = find(materialName, ResourceType::MATERIAL);
+			descriptor.instanceBuffer = INVALID_RID;
+			descriptor.instanceShader = INVALID_RID;
+			if (reader.contains_property(childIndex, "instance_buffer")) {
+				const char* instanceBufferName = reader.get_string(childIndex, "instance_buffer");
+				descriptor.instanceBuffer = find(instanceBufferName, ResourceType::VERTEXBUFFER);
+			}
+			if (reader.contains_property(childIndex, "instance_shader")) {
+				const char* instanceShaderName = reader.get_string(childIndex, "instance_shader");
+				descriptor.instanceShader = find(instanceShaderName, ResourceType::SHADER);
+			}
+			descriptor.format = VF_PNTC;
+			if (reader.contains_property(childIndex, "vertex_format")) {
+				const char* format = reader.get_string(childIndex, "vertex_format");
+				if (strcmp(format, "packed") == 0) {
+					descriptor.format = VF_PACKED;
+				}
+				else if (strcmp(format, "pntc") != 0) {
+					LOGE << "Unknown vertex format '" << format << "' - using pntc";
+				}
+			}
 			const char* name = reader.get_string(childIndex, "name");
 			return createMeshBuffer(name, descriptor);
 		}
@@ -1,4 +1,5 @@
 #include "MeshParser.h"
+#include "..\MeshLoader.h"
 
 namespace ds {
 
@@ -6,7 +7,7 @@ namespace ds {
 
 		RID MeshParser::createMesh(const char* name, const MeshDescriptor& descriptor) {
 			Mesh* mesh = new Mesh;
-			mesh->load(descriptor.fileName);
+			loader::load(mesh, descriptor.fileName, descriptor.lods);
 			MeshResource* cbr = new MeshResource(mesh);
 			_resCtx->resources.push_back(cbr);
 			return create(name, ResourceType::MESH);
@@ -17,6 +18,10 @@ namespace ds {
 			reader.get(childIndex, "position", &descriptor.position);
 			reader.get(childIndex, "scale", &descriptor.scale);
 			reader.get(childIndex, "rotation", &descriptor.rotation);
+			descriptor.lods = 1;
+			if (reader.contains_property(childIndex, "lods")) {
+				reader.get(childIndex, "lods", &descriptor.lods);
+			}
 			const char* name = reader.get_string(childIndex, "name");
 			descriptor.fileName = name;
 			return createMesh(name, descriptor);
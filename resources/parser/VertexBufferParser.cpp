@@ -6,7 +6,7 @@ namespace ds {
 
 		RID VertexBufferParser::createVertexBuffer(const char* name, const VertexBufferDescriptor& descriptor) {
 			InputLayoutResource* res = static_cast<InputLayoutResource*>(_resCtx->resources[descriptor.layout]);
-			UINT size = descriptor.size * res->size();
+			UINT size = descriptor.size * (descriptor.instanced ? res->instanceSize() : res->size());
 
 			D3D11_BUFFER_DESC bufferDesciption;
 			ZeroMemory(&bufferDesciption, sizeof(bufferDesciption));
@@ -50,6 +50,9 @@ namespace ds {
 			VertexBufferDescriptor descriptor;
 			reader.get(childIndex, "size", &descriptor.size);
 			reader.get(childIndex, "dynamic", &descriptor.dynamic);
+			if (reader.contains_property(childIndex, "instanced")) {
+				reader.get(childIndex, "instanced", &descriptor.instanced);
+			}
 			const char* layoutName = reader.get_string(childIndex, "layout");
 			descriptor.layout = find(layoutName, ResourceType::INPUTLAYOUT);
 			const char* name = reader.get_string(childIndex, "name");
@@ -0,0 +1,414 @@
+#include "AABBTree.h"
+#include "core\base\Assert.h"
+#include <float.h>
+#include <math.h>
+
+namespace ds {
+
+	const int MAX_RAYCAST_STACK = 256;
+
+	static inline float perimeter(const v3& min, const v3& max) {
+		v3 d = max - min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	static inline float combinedPerimeter(const AABBTreeNode& a, const AABBTreeNode& b) {
+		return perimeter(math::min_val(a.min, b.min), math::max_val(a.max, b.max));
+	}
+
+	static inline bool containsBox(const AABBTreeNode& n, const v3& min, const v3& max) {
+		return n.min.x <= min.x && n.min.y <= min.y && n.min.z <= min.z && max.x <= n.max.x && max.y <= n.max.y && max.z <= n.max.z;
+	}
+
+	// direction components below this are treated as parallel
+	const float RAY_PARALLEL_EPSILON = 1e-30f;
+
+	// ------------------------------------------------------
+	// slab test - returns the entry distance clamped to 0.
+	// A zero in inv marks an axis the ray is parallel to. It
+	// only hits if the origin lies inside that slab. This
+	// avoids 0 * inf = NaN for an origin on a slab plane.
+	// ------------------------------------------------------
+	static inline bool intersectBox(const v3& o, const v3& inv, const v3& min, const v3& max, float maxT, float* entry) {
+		float tmin = 0.0f;
+		float tmax = maxT;
+		for (int i = 0; i < 3; ++i) {
+			if (inv.data[i] == 0.0f) {
+				if (o.data[i] < min.data[i] || o.data[i] > max.data[i]) {
+					return false;
+				}
+				continue;
+			}
+			float t1 = (min.data[i] - o.data[i]) * inv.data[i];
+			float t2 = (max.data[i] - o.data[i]) * inv.data[i];
+			if (t1 > t2) {
+				float tmp = t1;
+				t1 = t2;
+				t2 = tmp;
+			}
+			if (t1 > tmin) {
+				tmin = t1;
+			}
+			if (t2 < tmax) {
+				tmax = t2;
+			}
+			if (tmin > tmax) {
+				return false;
+			}
+		}
+		*entry = tmin;
+		return true;
+	}
+
+	AABBTree::AABBTree(float margin) : _root(-1), _free(-1), _numLeaves(0), _margin(margin) {
+	}
+
+	// ------------------------------------------------------
+	// clear
+	// ------------------------------------------------------
+	void AABBTree::clear() {
+		_nodes.clear();
+		_root = -1;
+		_free = -1;
+		_numLeaves = 0;
+	}
+
+	int AABBTree::allocateNode() {
+		int index = _free;
+		if (index == -1) {
+			AABBTreeNode n;
+			_nodes.push_back(n);
+			index = _nodes.size() - 1;
+		}
+		else {
+			_free = _nodes[index].parent;
+		}
+		AABBTreeNode& n = _nodes[index];
+		n.parent = -1;
+		n.left = -1;
+		n.right = -1;
+		n.height = 0;
+		n.data = 0;
+		return index;
+	}
+
+	void AABBTree::freeNode(int index) {
+		_nodes[index].parent = _free;
+		_nodes[index].height = -1;
+		_free = index;
+	}
+
+	// ------------------------------------------------------
+	// insert
+	// ------------------------------------------------------
+	int AABBTree::insert(const v3& min, const v3& max, uint32_t data) {
+		int proxy = allocateNode();
+		AABBTreeNode& n = _nodes[proxy];
+		v3 m = v3(_margin, _margin, _margin);
+		n.min = min - m;
+		n.max = max + m;
+		n.tightMin = min;
+		n.tightMax = max;
+		n.data = data;
+		insertLeaf(proxy);
+		++_numLeaves;
+		return proxy;
+	}
+
+	// ------------------------------------------------------
+	// remove
+	// ------------------------------------------------------
+	void AABBTree::remove(int proxy) {
+		XASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf() && _nodes[proxy].height == 0, "Invalid proxy %d", proxy);
+		removeLeaf(proxy);
+		freeNode(proxy);
+		--_numLeaves;
+	}
+
+	// ------------------------------------------------------
+	// move - only reinserts when the tight box has left the
+	// fat box
+	// ------------------------------------------------------
+	bool AABBTree::move(int proxy, const v3& min, const v3& max) {
+		XASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf() && _nodes[proxy].height == 0, "Invalid proxy %d", proxy);
+		AABBTreeNode& n = _nodes[proxy];
+		n.tightMin = min;
+		n.tightMax = max;
+		if (containsBox(n, min, max)) {
+			return false;
+		}
+		removeLeaf(proxy);
+		v3 m = v3(_margin, _margin, _margin);
+		_nodes[proxy].min = min - m;
+		_nodes[proxy].max = max + m;
+		insertLeaf(proxy);
+		return true;
+	}
+
+	void AABBTree::refit(int index) {
+		AABBTreeNode& n = _nodes[index];
+		const AABBTreeNode& l = _nodes[n.left];
+		const AABBTreeNode& r = _nodes[n.right];
+		n.min = math::min_val(l.min, r.min);
+		n.max = math::max_val(l.max, r.max);
+		n.height = 1 + (l.height > r.height ? l.height : r.height);
+	}
+
+	// ------------------------------------------------------
+	// insert leaf - walks down choosing the child with the
+	// lowest perimeter cost and rebalances on the way up
+	// ------------------------------------------------------
+	void AABBTree::insertLeaf(int leaf) {
+		if (_root == -1) {
+			_root = leaf;
+			_nodes[leaf].parent = -1;
+			return;
+		}
+		int index = _root;
+		while (!_nodes[index].isLeaf()) {
+			const AABBTreeNode& n = _nodes[index];
+			const AABBTreeNode& l = _nodes[leaf];
+			float area = perimeter(n.min, n.max);
+			float combined = combinedPerimeter(n, l);
+			float cost = 2.0f * combined;
+			float inheritance = 2.0f * (combined - area);
+			const AABBTreeNode& c1 = _nodes[n.left];
+			float cost1 = combinedPerimeter(c1, l) + inheritance;
+			if (!c1.isLeaf()) {
+				cost1 -= perimeter(c1.min, c1.max);
+			}
+			const AABBTreeNode& c2 = _nodes[n.right];
+			float cost2 = combinedPerimeter(c2, l) + inheritance;
+			if (!c2.isLeaf()) {
+				cost2 -= perimeter(c2.min, c2.max);
+			}
+			if (cost < cost1 && cost < cost2) {
+				break;
+			}
+			index = cost1 < cost2 ? n.left : n.right;
+		}
+		int sibling = index;
+		int oldParent = _nodes[sibling].parent;
+		// might grow the array so no references before this
+		int newParent = allocateNode();
+		AABBTreeNode& p = _nodes[newParent];
+		p.parent = oldParent;
+		p.left = sibling;
+		p.right = leaf;
+		if (oldParent != -1) {
+			if (_nodes[oldParent].left == sibling) {
+				_nodes[oldParent].left = newParent;
+			}
+			else {
+				_nodes[oldParent].right = newParent;
+			}
+		}
+		else {
+			_root = newParent;
+		}
+		_nodes[sibling].parent = newParent;
+		_nodes[leaf].parent = newParent;
+		index = newParent;
+		while (index != -1) {
+			index = balance(index);
+			refit(index);
+			index = _nodes[index].parent;
+		}
+	}
+
+	// ------------------------------------------------------
+	// remove leaf - the sibling takes the place of the parent
+	// ------------------------------------------------------
+	void AABBTree::removeLeaf(int leaf) {
+		if (leaf == _root) {
+			_root = -1;
+			return;
+		}
+		int parent = _nodes[leaf].parent;
+		int grandParent = _nodes[parent].parent;
+		int sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+		if (grandParent != -1) {
+			if (_nodes[grandParent].left == parent) {
+				_nodes[grandParent].left = sibling;
+			}
+			else {
+				_nodes[grandParent].right = sibling;
+			}
+			_nodes[sibling].parent = grandParent;
+			freeNode(parent);
+			int index = grandParent;
+			while (index != -1) {
+				index = balance(index);
+				refit(index);
+				index = _nodes[index].parent;
+			}
+		}
+		else {
+			_root = sibling;
+			_nodes[sibling].parent = -1;
+			freeNode(parent);
+		}
+	}
+
+	// ------------------------------------------------------
+	// balance - rotates the higher child up if the heights
+	// differ by more than one. Returns the new subtree root.
+	// ------------------------------------------------------
+	int AABBTree::balance(int iA) {
+		AABBTreeNode& A = _nodes[iA];
+		if (A.isLeaf() || A.height < 2) {
+			return iA;
+		}
+		int iB = A.left;
+		int iC = A.right;
+		AABBTreeNode& B = _nodes[iB];
+		AABBTreeNode& C = _nodes[iC];
+		int diff = C.height - B.height;
+		if (diff > 1) {
+			// rotate C up
+			int iF = C.left;
+			int iG = C.right;
+			AABBTreeNode& F = _nodes[iF];
+			AABBTreeNode& G = _nodes[iG];
+			C.left = iA;
+			C.parent = A.parent;
+			A.parent = iC;
+			if (C.parent != -1) {
+				if (_nodes[C.parent].left == iA) {
+					_nodes[C.parent].left = iC;
+				}
+				else {
+					_nodes[C.parent].right = iC;
+				}
+			}
+			else {
+				_root = iC;
+			}
+			if (F.height > G.height) {
+				C.right = iF;
+				A.right = iG;
+				G.parent = iA;
+			}
+			else {
+				C.right = iG;
+				A.right = iF;
+				F.parent = iA;
+			}
+			refit(iA);
+			refit(iC);
+			return iC;
+		}
+		if (diff < -1) {
+			// rotate B up
+			int iD = B.left;
+			int iE = B.right;
+			AABBTreeNode& D = _nodes[iD];
+			AABBTreeNode& E = _nodes[iE];
+			B.left = iA;
+			B.parent = A.parent;
+			A.parent = iB;
+			if (B.parent != -1) {
+				if (_nodes[B.parent].left == iA) {
+					_nodes[B.parent].left = iB;
+				}
+				else {
+					_nodes[B.parent].right = iB;
+				}
+			}
+			else {
+				_root = iB;
+			}
+			if (D.height > E.height) {
+				B.right = iD;
+				A.left = iE;
+				E.parent = iA;
+			}
+			else {
+				B.right = iE;
+				A.left = iD;
+				D.parent = iA;
+			}
+			refit(iA);
+			refit(iB);
+			return iB;
+		}
+		return iA;
+	}
+
+	// ------------------------------------------------------
+	// raycast - visits the nearer child first and skips every
+	// node that starts behind the best hit so far
+	// ------------------------------------------------------
+	bool AABBTree::raycast(const Ray& ray, uint32_t* data, float* t) const {
+		if (_root == -1) {
+			return false;
+		}
+		v3 inv;
+		for (int i = 0; i < 3; ++i) {
+			float d = ray.direction.data[i];
+			inv.data[i] = fabs(d) < RAY_PARALLEL_EPSILON ? 0.0f : 1.0f / d;
+		}
+		const v3& o = ray.origin;
+		float best = FLT_MAX;
+		bool found = false;
+		int stack[MAX_RAYCAST_STACK];
+		float entries[MAX_RAYCAST_STACK];
+		int cnt = 0;
+		float entry = 0.0f;
+		if (!intersectBox(o, inv, _nodes[_root].min, _nodes[_root].max, best, &entry)) {
+			return false;
+		}
+		stack[cnt] = _root;
+		entries[cnt++] = entry;
+		while (cnt > 0) {
+			--cnt;
+			if (entries[cnt] >= best) {
+				continue;
+			}
+			const AABBTreeNode& n = _nodes[stack[cnt]];
+			if (n.isLeaf()) {
+				if (intersectBox(o, inv, n.tightMin, n.tightMax, best, &entry)) {
+					best = entry;
+					*data = n.data;
+					found = true;
+				}
+				continue;
+			}
+			float el = 0.0f;
+			float er = 0.0f;
+			const AABBTreeNode& l = _nodes[n.left];
+			const AABBTreeNode& r = _nodes[n.right];
+			bool hl = intersectBox(o, inv, l.min, l.max, best, &el);
+			bool hr = intersectBox(o, inv, r.min, r.max, best, &er);
+			XASSERT(cnt + 2 <= MAX_RAYCAST_STACK, "Raycast stack overflow");
+			// push the farther one first so the nearer one is popped next
+			if (hl && hr) {
+				if (el < er) {
+					stack[cnt] = n.right;
+					entries[cnt++] = er;
+					stack[cnt] = n.left;
+					entries[cnt++] = el;
+				}
+				else {
+					stack[cnt] = n.left;
+					entries[cnt++] = el;
+					stack[cnt] = n.right;
+					entries[cnt++] = er;
+				}
+			}
+			else if (hl) {
+				stack[cnt] = n.left;
+				entries[cnt++] = el;
+			}
+			else if (hr) {
+				stack[cnt] = n.right;
+				entries[cnt++] = er;
+			}
+		}
+		if (found) {
+			*t = best;
+		}
+		return found;
+	}
+
+}
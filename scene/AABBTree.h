@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include "core\math\math_types.h"
+#include "core\math\AABBox.h"
+#include "core\lib\collection_types.h"
+
+namespace ds {
+
+	// ------------------------------------------------------
+	// AABBTreeNode - leaves keep the tight box next to the
+	// fattened one that is used for the tree itself
+	// ------------------------------------------------------
+	struct AABBTreeNode {
+		v3 min;
+		v3 max;
+		v3 tightMin;
+		v3 tightMax;
+		uint32_t data;
+		// parent or next free node
+		int parent;
+		int left;
+		int right;
+		// -1 marks a free node
+		int height;
+
+		bool isLeaf() const {
+			return left == -1;
+		}
+	};
+
+	// ------------------------------------------------------
+	// Dynamic AABB tree. Leaves are stored with a fat box so
+	// that small movements only update the tight box. The
+	// tree is kept balanced by rotations on insert/remove.
+	// ------------------------------------------------------
+	class AABBTree {
+
+	public:
+		AABBTree(float margin = 0.1f);
+		~AABBTree() {}
+		int insert(const v3& min, const v3& max, uint32_t data);
+		void remove(int proxy);
+		// returns true if the leaf had to be reinserted
+		bool move(int proxy, const v3& min, const v3& max);
+		// nearest hit of the tight boxes along the ray
+		bool raycast(const Ray& ray, uint32_t* data, float* t) const;
+		void clear();
+		uint32_t getData(int proxy) const {
+			return _nodes[proxy].data;
+		}
+		uint32_t numProxies() const {
+			return _numLeaves;
+		}
+		int getHeight() const {
+			return _root == -1 ? 0 : _nodes[_root].height;
+		}
+	private:
+		int allocateNode();
+		void freeNode(int index);
+		void insertLeaf(int leaf);
+		void removeLeaf(int leaf);
+		int balance(int index);
+		void refit(int index);
+
+		Array<AABBTreeNode> _nodes;
+		int _root;
+		int _free;
+		uint32_t _numLeaves;
+		float _margin;
+	};
+
+}
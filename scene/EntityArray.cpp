@@ -1,113 +1,276 @@
 #include "EntityArray.h"
 #include "core\log\Log.h"
+#include "core\base\Assert.h"
+#include "..\renderer\Transform.h"
+#include "core\profiler\Profiler.h"
 
 namespace ds {
 
-	/*
-	EntityArrayIndex* indices;
-	ID* ids;
-	v3* positions;
-	v3* scales;
-	v3* rotations;
-	Color* colors;
-	float* timers;
-	uint16_t* types;
-	Texture* textures;
-	Mesh** meshes;
-	mat4* worlds;
-	ID* parents;
-	DrawMode* drawModes;
-	RID* materials;
-	int* staticIndices;
-	bool* active;
-	*/
-	void EntityArray::allocate(uint16_t size) {
+	// ------------------------------------------------------
+	// element size of every column - the order must match
+	// EntityColumn and assignColumns
+	// ------------------------------------------------------
+	static const uint32_t COLUMN_SIZES[] = {
+		sizeof(EntityArrayIndex), sizeof(ID), sizeof(v3), sizeof(v3), sizeof(v3), sizeof(Color), sizeof(float),
+		sizeof(uint16_t), sizeof(Texture), sizeof(Mesh*), sizeof(mat4), sizeof(ID), sizeof(DrawMode), sizeof(RID),
+		sizeof(int), sizeof(bool), sizeof(bool), sizeof(uint32_t), sizeof(AABBox)
+	};
+
+	static const uint32_t NUM_COLUMNS = NUM_ENTITY_COLUMNS;
+
+	static_assert(sizeof(COLUMN_SIZES) / sizeof(COLUMN_SIZES[0]) == NUM_ENTITY_COLUMNS, "COLUMN_SIZES does not match EntityColumn");
+
+	// ------------------------------------------------------
+	// byte offsets of all columns for the given capacity.
+	// Every column starts 16 byte aligned. Returns the total
+	// size of the buffer.
+	// ------------------------------------------------------
+	static uint32_t columnOffsets(uint32_t size, uint32_t* offsets) {
+		uint64_t offset = 0;
+		for (uint32_t i = 0; i < NUM_COLUMNS; ++i) {
+			offset = (offset + 15) & ~(uint64_t)15;
+			offsets[i] = (uint32_t)offset;
+			offset += (uint64_t)size * COLUMN_SIZES[i];
+		}
+		XASSERT(offset <= UINT32_MAX, "EntityArray buffer for %d entities exceeds 4GB", size);
+		return (uint32_t)offset;
+	}
+
+	uint32_t EntityArray::columnSize(uint32_t column) {
+		XASSERT(column < NUM_COLUMNS, "Invalid column %d", column);
+		return COLUMN_SIZES[column];
+	}
+
+	// ------------------------------------------------------
+	// the current address of a column. While reserveAhead
+	// moves the columns some of them are already in pending.
+	// ------------------------------------------------------
+	char* EntityArray::getColumn(uint32_t column) const {
+		XASSERT(column < NUM_COLUMNS, "Invalid column %d", column);
+		switch (column) {
+			case COLUMN_INDICES: return (char*)indices;
+			case COLUMN_IDS: return (char*)ids;
+			case COLUMN_POSITIONS: return (char*)positions;
+			case COLUMN_SCALES: return (char*)scales;
+			case COLUMN_ROTATIONS: return (char*)rotations;
+			case COLUMN_COLORS: return (char*)colors;
+			case COLUMN_TIMERS: return (char*)timers;
+			case COLUMN_TYPES: return (char*)types;
+			case COLUMN_TEXTURES: return (char*)textures;
+			case COLUMN_MESHES: return (char*)meshes;
+			case COLUMN_WORLDS: return (char*)worlds;
+			case COLUMN_PARENTS: return (char*)parents;
+			case COLUMN_DRAWMODES: return (char*)drawModes;
+			case COLUMN_MATERIALS: return (char*)materials;
+			case COLUMN_STATICINDICES: return (char*)staticIndices;
+			case COLUMN_ACTIVE: return (char*)active;
+			case COLUMN_DIRTY: return (char*)dirty;
+			case COLUMN_TYPEINDICES: return (char*)typeIndices;
+			default: return (char*)bounds;
+		}
+	}
+
+	void EntityArray::assignColumn(uint32_t column, char* p) {
+		switch (column) {
+			case COLUMN_INDICES: indices = (EntityArrayIndex*)p; break;
+			case COLUMN_IDS: ids = (ID*)p; break;
+			case COLUMN_POSITIONS: positions = (v3*)p; break;
+			case COLUMN_SCALES: scales = (v3*)p; break;
+			case COLUMN_ROTATIONS: rotations = (v3*)p; break;
+			case COLUMN_COLORS: colors = (Color*)p; break;
+			case COLUMN_TIMERS: timers = (float*)p; break;
+			case COLUMN_TYPES: types = (uint16_t*)p; break;
+			case COLUMN_TEXTURES: textures = (Texture*)p; break;
+			case COLUMN_MESHES: meshes = (Mesh**)p; break;
+			case COLUMN_WORLDS: worlds = (mat4*)p; break;
+			case COLUMN_PARENTS: parents = (ID*)p; break;
+			case COLUMN_DRAWMODES: drawModes = (DrawMode*)p; break;
+			case COLUMN_MATERIALS: materials = (RID*)p; break;
+			case COLUMN_STATICINDICES: staticIndices = (int*)p; break;
+			case COLUMN_ACTIVE: active = (bool*)p; break;
+			case COLUMN_DIRTY: dirty = (bool*)p; break;
+			case COLUMN_TYPEINDICES: typeIndices = (uint32_t*)p; break;
+			default: bounds = (AABBox*)p; break;
+		}
+	}
+
+	// new slots start with generation 0
+	void EntityArray::initSlots(uint32_t start, uint32_t end) {
+		for (uint32_t i = start; i < end; ++i) {
+			indices[i].id = handle::make(i, 0);
+			indices[i].index = handle::INVALID_INDEX;
+		}
+	}
+
+	// ------------------------------------------------------
+	// the capacity create and reserveAhead grow to - both
+	// must agree so that create can use the pending buffer
+	// ------------------------------------------------------
+	uint32_t EntityArray::nextCapacity() const {
+		uint64_t size = (uint64_t)capacity * 2 + 8;
+		return size > handle::MAX_INDEX ? handle::MAX_INDEX : (uint32_t)size;
+	}
+
+	struct ColumnCopy {
+		char* dest;
+		const uint32_t* destOffsets;
+		// 0 marks a column that is already in dest
+		const char* src[NUM_COLUMNS];
+		uint32_t num;
+		uint32_t capacity;
+	};
+
+	// one column per job - all slots of the indices must be kept
+	// since removed slots keep their generation
+	static void copyColumns(uint32_t start, uint32_t end, void* data) {
+		const ColumnCopy* copy = (const ColumnCopy*)data;
+		for (uint32_t i = start; i < end; ++i) {
+			if (copy->src[i] != 0) {
+				uint32_t cnt = i == COLUMN_INDICES ? copy->capacity : copy->num;
+				memcpy(copy->dest + copy->destOffsets[i], copy->src[i], cnt * COLUMN_SIZES[i]);
+			}
+		}
+	}
+
+	// ------------------------------------------------------
+	// allocate - moves all columns into a new buffer. Large
+	// arrays are copied column by column on the job workers.
+	// A buffer prepared by reserveAhead is used if it is
+	// large enough. The columns it already holds are not
+	// copied again.
+	// ------------------------------------------------------
+	void EntityArray::allocate(uint32_t size) {
 		if (size > capacity) {
-			int sum = sizeof(EntityArrayIndex) + sizeof(ID) + sizeof(v3) + sizeof(v3) + sizeof(v3) + sizeof(Color) + sizeof(float);
-			sum += sizeof(uint16_t) + sizeof(Texture) + sizeof(Mesh*) + sizeof(mat4) + sizeof(ID) + sizeof(DrawMode) + sizeof(RID) + sizeof(int) + sizeof(bool) + sizeof(bool);
-			int sz = size * sum;
-			char* b = (char*)ALLOC(sz);			
-			indices = (EntityArrayIndex*)b;
-			ids = (ID*)(indices + size);
-			positions = (v3*)(ids + size);
-			scales = (v3*)(positions + size);
-			rotations = (v3*)(scales + size);
-			colors = (Color*)(rotations + size);
-			timers = (float*)(colors + size);
-			types = (uint16_t*)(timers + size);
-			textures = (Texture*)(types + size);
-			meshes = (Mesh**)(textures + size);
-			worlds = (mat4*)(meshes + size);
-			parents = (ID*)(worlds + size);
-			drawModes = (DrawMode*)(parents + size);
-			materials = (RID*)(drawModes + size);
-			staticIndices = (int*)(materials + size);
-			active = (bool*)(staticIndices + size);
-			dirty = (bool*)(active + size);
+			XASSERT(size <= handle::MAX_INDEX, "EntityArray size %d exceeds max %d", size, handle::MAX_INDEX);
+			ZoneTracker z("EntityArray::allocate");
+			uint32_t offsets[NUM_COLUMNS];
+			char* b = 0;
+			uint32_t moved = 0;
+			if (pending != 0 && pendingCapacity >= size) {
+				size = pendingCapacity;
+				b = pending;
+				moved = pendingColumns;
+			}
+			uint32_t total = columnOffsets(size, offsets);
+			if (b == 0) {
+				b = (char*)ALLOC(total);
+			}
 			if (buffer != 0) {
-				memcpy(indices, buffer, num * sizeof(EntityArrayIndex));
-				int index = capacity * sizeof(EntityArrayIndex);
-				memcpy(ids, buffer + index, num * sizeof(ID));
-				index += capacity * sizeof(ID);
-				memcpy(positions, buffer + index, num * sizeof(v3));
-				index += capacity * sizeof(v3);
-				memcpy(scales, buffer + index, num * sizeof(v3));
-				index += capacity * sizeof(v3);
-				memcpy(rotations, buffer + index, num * sizeof(v3));
-				index += capacity * sizeof(v3);
-				memcpy(colors, buffer + index, num * sizeof(Color));
-				index += capacity * sizeof(Color);
-				memcpy(timers, buffer + index, num * sizeof(float));
-				index += capacity * sizeof(float);
-				memcpy(types, buffer + index, num * sizeof(uint16_t));
-				index += capacity * sizeof(uint16_t);
-				memcpy(textures, buffer + index, num * sizeof(Texture));
-				index += capacity * sizeof(Texture);
-				memcpy(meshes, buffer + index, num * sizeof(Mesh*));
-				index += capacity * sizeof(Mesh*);
-				memcpy(worlds, buffer + index, num * sizeof(mat4));
-				index += capacity * sizeof(mat4);
-				memcpy(parents, buffer + index, num * sizeof(ID));
-				index += capacity * sizeof(ID);
-				memcpy(drawModes, buffer + index, num * sizeof(DrawMode));
-				index += capacity * sizeof(DrawMode);
-				memcpy(materials, buffer + index, num * sizeof(RID));
-				index += capacity * sizeof(RID);
-				memcpy(staticIndices, buffer + index, num * sizeof(int));
-				index += capacity * sizeof(int);
-				memcpy(active, buffer + index, num * sizeof(bool));
-				index += capacity * sizeof(bool);
-				memcpy(dirty, buffer + index, num * sizeof(bool));
-				index += capacity * sizeof(bool);
-				for (int i = num; i < size; ++i) {
-					indices[i].id = i;
-					indices[i].index = UINT16_MAX;
+				ColumnCopy copy;
+				copy.dest = b;
+				copy.destOffsets = offsets;
+				for (uint32_t i = 0; i < NUM_COLUMNS; ++i) {
+					copy.src[i] = i < moved ? 0 : getColumn(i);
+				}
+				copy.num = num;
+				copy.capacity = capacity;
+				if (num >= ENTITY_PARALLEL_COPY) {
+					jobs::parallelFor(NUM_COLUMNS, 1, copyColumns, &copy);
+				}
+				else {
+					copyColumns(0, NUM_COLUMNS, &copy);
 				}
 				DEALLOC(buffer);
 			}
+			// a pending buffer that was too small may hold columns - free it after the copy
+			if (pending != 0 && pending != b) {
+				DEALLOC(pending);
+			}
+			pending = 0;
+			pendingColumns = 0;
+			for (uint32_t i = 0; i < NUM_COLUMNS; ++i) {
+				assignColumn(i, b + offsets[i]);
+			}
+			// reserveAhead prepares the new slots when it moves the indices
+			if (moved == 0) {
+				initSlots(capacity, size);
+			}
 			capacity = size;
 			buffer = b;
 		}
 	}
 
+	// ------------------------------------------------------
+	// reserve ahead - called once per frame. Once half of
+	// the capacity is used the next buffer is allocated and
+	// its pages are touched a few MB per frame so that the
+	// page faults do not hit a single frame. After that the
+	// columns move over one by one, at least one per frame
+	// and at most ENTITY_PREFAULT_BYTES, so the largest
+	// single copy is one column. Every column pointer stays
+	// valid while the others are still in the old buffer.
+	// ------------------------------------------------------
+	void EntityArray::reserveAhead() {
+		if (pending == 0) {
+			if (num == 0 || num < capacity / ENTITY_RESERVE_DIVISOR || capacity >= handle::MAX_INDEX) {
+				return;
+			}
+			uint32_t size = nextCapacity();
+			uint32_t offsets[NUM_COLUMNS];
+			pendingSize = columnOffsets(size, offsets);
+			pending = (char*)ALLOC(pendingSize);
+			pendingCapacity = size;
+			pendingTouched = 0;
+			pendingColumns = 0;
+		}
+		if (pendingTouched < pendingSize) {
+			uint32_t bytes = pendingSize - pendingTouched;
+			if (bytes > ENTITY_PREFAULT_BYTES) {
+				bytes = ENTITY_PREFAULT_BYTES;
+			}
+			memset(pending + pendingTouched, 0, bytes);
+			pendingTouched += bytes;
+			return;
+		}
+		ZoneTracker z("EntityArray::moveColumns");
+		uint32_t offsets[NUM_COLUMNS];
+		columnOffsets(pendingCapacity, offsets);
+		uint32_t bytes = 0;
+		while (pendingColumns < NUM_COLUMNS && bytes < ENTITY_PREFAULT_BYTES) {
+			uint32_t c = pendingColumns;
+			uint32_t cnt = c == COLUMN_INDICES ? capacity : num;
+			char* dest = pending + offsets[c];
+			memcpy(dest, getColumn(c), cnt * COLUMN_SIZES[c]);
+			assignColumn(c, dest);
+			if (c == COLUMN_INDICES) {
+				initSlots(capacity, pendingCapacity);
+			}
+			bytes += cnt * COLUMN_SIZES[c];
+			++pendingColumns;
+		}
+		if (pendingColumns == NUM_COLUMNS) {
+			// nothing left to copy
+			allocate(pendingCapacity);
+		}
+	}
+
+	void EntityArray::release() {
+		if (buffer != 0) {
+			DEALLOC(buffer);
+			buffer = 0;
+		}
+		if (pending != 0) {
+			DEALLOC(pending);
+			pending = 0;
+		}
+		pendingColumns = 0;
+		num = 0;
+		capacity = 0;
+	}
+
 	ID EntityArray::create(const v3& pos, Mesh* m, const v3& scale,const v3& rotation, RID material, const Color& color) {
 		if (num + 1 > capacity) {
-			allocate(capacity * 2 + 8);
+			allocate(nextCapacity());
 		}
-		ID id = 0;
+		ID slot = 0;
 		if (freeList.empty()) {
-			id = current++;
+			slot = current++;
 		}
 		else {
-			id = freeList.back();
+			slot = freeList.back();
 			freeList.pop_back();
 		}
-		mat4 rotY = matrix::mat4RotationY(rotation.y);
-		mat4 rotX = matrix::mat4RotationX(rotation.x);
-		mat4 rotZ = matrix::mat4RotationZ(rotation.z);
-		mat4 t = matrix::mat4Transform(pos);
-		mat4 s = matrix::mat4Scale(scale);
-		EntityArrayIndex &in = indices[id];
+		EntityArrayIndex &in = indices[slot];
 		in.index = num++;
 		ids[in.index] = in.id;
 		positions[in.index] = pos;
@@ -117,29 +280,32 @@ namespace ds {
 		timers[in.index] = 0.0f;
 		types[in.index] = 0;
 		meshes[in.index] = m;
-		worlds[in.index] = rotZ * rotY * rotX * s * t;
+		transform::buildWorld(pos, scale, rotation, &worlds[in.index]);
+		updateBounds(in.index);
 		parents[in.index] = INVALID_ID;
 		drawModes[in.index] = DrawMode::TRANSFORM;
 		materials[in.index] = material;
 		staticIndices[in.index] = -1;
 		active[in.index] = true;
 		dirty[in.index] = false;
+		addToTypeList(in.index);
+		hierarchyChanged = true;
 		return in.id;
 	}
 
 	ID EntityArray::create(const v2& pos, const Texture& t, const v2& scale, const float rotation, RID material, const Color& color) {
 		if (num + 1 > capacity) {
-			allocate(capacity * 2 + 8);
+			allocate(nextCapacity());
 		}
-		ID id = 0;
+		ID slot = 0;
 		if (freeList.empty()) {
-			id = current++;
+			slot = current++;
 		}
 		else {
-			id = freeList.back();
+			slot = freeList.back();
 			freeList.pop_back();
 		}
-		EntityArrayIndex &in = indices[id];
+		EntityArrayIndex &in = indices[slot];
 		in.index = num++;
 		ids[in.index] = in.id;
 		positions[in.index] = v3(pos,0.0f);
@@ -151,90 +317,338 @@ namespace ds {
 		textures[in.index] = t;
 		meshes[in.index] = 0;
 		worlds[in.index] = matrix::m4identity();
+		updateBounds(in.index);
 		parents[in.index] = INVALID_ID;
 		drawModes[in.index] = DrawMode::TRANSFORM;
 		materials[in.index] = material;
 		staticIndices[in.index] = -1;
 		active[in.index] = true;
 		dirty[in.index] = false;
+		addToTypeList(in.index);
+		hierarchyChanged = true;
 		return in.id;
 	}
 
 	bool EntityArray::contains(ID id) const {
-		EntityArrayIndex &in = indices[id];
-		if (in.index != USHRT_MAX) {
-			return true;
+		uint32_t slot = handle::index(id);
+		if (slot < capacity) {
+			const EntityArrayIndex &in = indices[slot];
+			if (in.id == id && in.index != handle::INVALID_INDEX) {
+				return true;
+			}
 		}
 		LOG << "ID: " << id << " is NOT valid - no valid index found";
 		return false;
 	}
 
 	int EntityArray::getIndex(ID id) const {
-		EntityArrayIndex &in = indices[id];
-		if (in.index != USHRT_MAX) {
-			return in.index;
+		uint32_t slot = handle::index(id);
+		if (slot < capacity) {
+			const EntityArrayIndex &in = indices[slot];
+			if (in.id == id && in.index != handle::INVALID_INDEX) {
+				return in.index;
+			}
 		}
 		LOG << "ID: " << id << " is NOT valid - no valid index found";
 		return -1;
 	}
 
 	void EntityArray::updateWorld(ID id) {
-		EntityArrayIndex &in = indices[id];
-		if (in.index != USHRT_MAX) {
-			mat4 rotY = matrix::mat4RotationY(rotations[in.index].y);
-			mat4 rotX = matrix::mat4RotationX(rotations[in.index].x);
-			mat4 rotZ = matrix::mat4RotationZ(rotations[in.index].z);
-			mat4 t = matrix::mat4Transform(positions[in.index]);
-			mat4 s = matrix::mat4Scale(scales[in.index]);
-			worlds[in.index] = rotZ * rotY * rotX * s * t;
+		EntityArrayIndex &in = indices[handle::index(id)];
+		if (in.id == id && in.index != handle::INVALID_INDEX) {
+			transform::buildWorld(positions[in.index], scales[in.index], rotations[in.index], &worlds[in.index]);
+			updateBounds(in.index);
+		}
+	}
+
+	// ------------------------------------------------------
+	// world space bounds - entities without a mesh get an
+	// empty box at their position
+	// ------------------------------------------------------
+	void EntityArray::updateBounds(uint32_t index) {
+		if (meshes[index] != 0) {
+			transform::transformBox(meshes[index]->boundingBox, worlds[index], &bounds[index]);
+		}
+		else {
+			const mat4& w = worlds[index];
+			bounds[index].position = v3(w._41, w._42, w._43);
+			bounds[index].extent = v3(0.0f, 0.0f, 0.0f);
+		}
+	}
+
+	void EntityArray::rebuildBounds() {
+		for (uint32_t i = 0; i < num; ++i) {
+			updateBounds(i);
 		}
 	}
 
 	void EntityArray::setDrawMode(ID id, DrawMode mode) {
-		EntityArrayIndex &in = indices[id];
+		XASSERT(contains(id), "Invalid or stale ID %d", id);
+		EntityArrayIndex &in = indices[handle::index(id)];
 		drawModes[in.index] = mode;
 	}
 
 	void EntityArray::setStaticIndex(ID id, int idx) {
-		EntityArrayIndex &in = indices[id];
+		XASSERT(contains(id), "Invalid or stale ID %d", id);
+		EntityArrayIndex &in = indices[handle::index(id)];
 		staticIndices[in.index] = idx;
 	}
 
+	void EntityArray::setParent(ID child, ID parent) {
+		XASSERT(contains(child), "Invalid or stale ID %d", child);
+		EntityArrayIndex &in = indices[handle::index(child)];
+		parents[in.index] = parent;
+		dirty[in.index] = true;
+		hierarchyChanged = true;
+	}
+
+	// ------------------------------------------------------
+	// data index of an ID or -1 - does not log like getIndex
+	// since removed parents are expected here
+	// ------------------------------------------------------
+	static int resolveIndex(const EntityArray& array, ID id) {
+		if (id == INVALID_ID) {
+			return -1;
+		}
+		uint32_t slot = handle::index(id);
+		if (slot >= array.capacity) {
+			return -1;
+		}
+		const EntityArrayIndex& in = array.indices[slot];
+		if (in.id != id || in.index == handle::INVALID_INDEX) {
+			return -1;
+		}
+		return in.index;
+	}
+
+	// ------------------------------------------------------
+	// sort all entities by depth using a counting sort so
+	// that every parent comes before its children
+	// ------------------------------------------------------
+	void EntityArray::buildTransformOrder() {
+		const uint32_t MAX_DEPTH = 64;
+		depths.clear();
+		uint32_t counts[MAX_DEPTH + 1] = { 0 };
+		uint32_t maxDepth = 0;
+		for (uint32_t i = 0; i < num; ++i) {
+			uint32_t d = 0;
+			int p = resolveIndex(*this, parents[i]);
+			while (p != -1 && d < MAX_DEPTH) {
+				++d;
+				p = resolveIndex(*this, parents[p]);
+			}
+			XASSERT(p == -1, "Entity hierarchy is deeper than %d or contains a cycle", MAX_DEPTH);
+			depths.push_back(d);
+			++counts[d];
+			if (d > maxDepth) {
+				maxDepth = d;
+			}
+		}
+		uint32_t offsets[MAX_DEPTH + 1];
+		uint32_t sum = 0;
+		for (uint32_t d = 0; d <= maxDepth; ++d) {
+			offsets[d] = sum;
+			sum += counts[d];
+		}
+		transformOrder.clear();
+		for (uint32_t i = 0; i < num; ++i) {
+			transformOrder.push_back(0);
+		}
+		for (uint32_t i = 0; i < num; ++i) {
+			transformOrder[offsets[depths[i]]++] = i;
+		}
+		hierarchyChanged = false;
+	}
+
+	// ------------------------------------------------------
+	// recompute the world matrix of all dirty entities and
+	// their children. The dirty flag of a parent is still set
+	// when its children are visited so it can be propagated.
+	// ------------------------------------------------------
+	void EntityArray::updateTransforms(Array<ID>* moved) {
+		if (hierarchyChanged) {
+			buildTransformOrder();
+		}
+		bool any = false;
+		for (uint32_t i = 0; i < num; ++i) {
+			uint32_t idx = transformOrder[i];
+			int pidx = resolveIndex(*this, parents[idx]);
+			if (pidx != -1 && dirty[pidx]) {
+				dirty[idx] = true;
+			}
+			if (dirty[idx]) {
+				if (pidx != -1) {
+					mat4 local;
+					transform::buildWorld(positions[idx], scales[idx], rotations[idx], &local);
+					transform::multiplyAffine(local, worlds[pidx], &worlds[idx]);
+				}
+				else {
+					transform::buildWorld(positions[idx], scales[idx], rotations[idx], &worlds[idx]);
+				}
+				updateBounds(idx);
+				if (moved != 0) {
+					moved->push_back(ids[idx]);
+				}
+				any = true;
+			}
+		}
+		if (any) {
+			memset(dirty, 0, num * sizeof(bool));
+		}
+	}
+
+	// ------------------------------------------------------
+	// valid slots - every live slot points to a different
+	// entity below numEntities and every free slot is a
+	// different unused slot below numSlots
+	// ------------------------------------------------------
+	bool EntityArray::validSlots(const EntityArrayIndex* slots, uint32_t numSlots, const ID* freeSlots, uint32_t numFree, const ID* entityIds, uint32_t numEntities) {
+		// every slot is either live or free - create relies on it once the free list is empty
+		if (numEntities > numSlots || numSlots > handle::MAX_INDEX || (uint64_t)numEntities + numFree != numSlots) {
+			return false;
+		}
+		// entities and slots seen so far
+		uint32_t cnt = numSlots + numEntities;
+		bool* used = (bool*)ALLOC(cnt > 0 ? cnt : 1);
+		memset(used, 0, cnt);
+		bool* usedSlots = used + numEntities;
+		uint32_t live = 0;
+		bool valid = true;
+		for (uint32_t i = 0; i < numSlots && valid; ++i) {
+			// a handle only reaches the slot it was made for
+			valid = handle::index(slots[i].id) == i;
+			uint32_t index = slots[i].index;
+			if (valid && index != handle::INVALID_INDEX) {
+				valid = index < numEntities && !used[index] && entityIds[index] == slots[i].id;
+				if (valid) {
+					used[index] = true;
+					usedSlots[i] = true;
+					++live;
+				}
+			}
+		}
+		valid = valid && live == numEntities;
+		for (uint32_t i = 0; i < numFree && valid; ++i) {
+			uint32_t slot = freeSlots[i];
+			valid = slot < numSlots && !usedSlots[slot];
+			if (valid) {
+				usedSlots[slot] = true;
+			}
+		}
+		DEALLOC(used);
+		return valid;
+	}
+
+	// ------------------------------------------------------
+	// restore the slots of a snapshot. The columns have to be
+	// filled by the caller followed by rebuildTypeLists.
+	// ------------------------------------------------------
+	void EntityArray::restore(const EntityArrayIndex* slots, uint32_t numSlots, const ID* freeSlots, uint32_t numFree, uint32_t numEntities) {
+		clear();
+		allocate(numSlots > numEntities ? numSlots : numEntities);
+		memcpy(indices, slots, numSlots * sizeof(EntityArrayIndex));
+		for (uint32_t i = 0; i < numFree; ++i) {
+			freeList.push_back(freeSlots[i]);
+		}
+		current = numSlots;
+		num = numEntities;
+		hierarchyChanged = true;
+	}
+
+	void EntityArray::rebuildTypeLists() {
+		for (uint32_t i = 0; i < MAX_ENTITY_TYPES; ++i) {
+			typeLists[i].clear();
+		}
+		for (uint32_t i = 0; i < num; ++i) {
+			addToTypeList(i);
+		}
+	}
+
+	// ------------------------------------------------------
+	// type lists - every entity knows its position in the
+	// list of its type so that it can be removed in O(1)
+	// ------------------------------------------------------
+	void EntityArray::addToTypeList(uint32_t index) {
+		XASSERT(types[index] < MAX_ENTITY_TYPES, "Type %d exceeds max %d", types[index], MAX_ENTITY_TYPES);
+		Array<ID>& list = typeLists[types[index]];
+		typeIndices[index] = list.size();
+		list.push_back(ids[index]);
+	}
+
+	void EntityArray::removeFromTypeList(uint32_t index) {
+		Array<ID>& list = typeLists[types[index]];
+		uint32_t pos = typeIndices[index];
+		ID lastID = list.back();
+		if (lastID != ids[index]) {
+			list[pos] = lastID;
+			typeIndices[indices[handle::index(lastID)].index] = pos;
+		}
+		list.pop_back();
+	}
+
+	void EntityArray::setType(ID id, uint16_t type) {
+		XASSERT(contains(id), "Invalid or stale ID %d", id);
+		uint32_t index = indices[handle::index(id)].index;
+		if (types[index] != type) {
+			removeFromTypeList(index);
+			types[index] = type;
+			addToTypeList(index);
+		}
+	}
+
+	EntityTypeQuery EntityArray::query(uint16_t type) const {
+		EntityTypeQuery q;
+		q.first = 0;
+		q.num = 0;
+		if (type < MAX_ENTITY_TYPES) {
+			const Array<ID>& list = typeLists[type];
+			q.num = list.size();
+			if (q.num > 0) {
+				q.first = &list[0];
+			}
+		}
+		return q;
+	}
+
 	const mat4& EntityArray::getWorld(ID id) const {
-		EntityArrayIndex &in = indices[id];
+		XASSERT(contains(id), "Invalid or stale ID %d", id);
+		EntityArrayIndex &in = indices[handle::index(id)];
 		return worlds[in.index];
 	}
 
 	void EntityArray::remove(ID id) {
-		EntityArrayIndex& in = indices[id];
-		//XASSERT(in.index != UINT16_MAX, "Invalid index for %d", id);
-		//XASSERT(id < capacity, "ID %d out of range %d", id, capacity);
-		if (num > 1) {
-			int last = num - 1;
-			ID lastID = ids[last];
-			EntityArrayIndex& lastIn = indices[lastID];
-			if (last != in.index) {
-				ids[in.index] = ids[lastIn.index];
-				positions[in.index] = positions[lastIn.index];
-				scales[in.index] = scales[lastIn.index];
-				rotations[in.index] = rotations[lastIn.index];
-				colors[in.index] = colors[lastIn.index];
-				timers[in.index] = timers[lastIn.index];
-				types[in.index] = types[lastIn.index];
-				textures[in.index] = textures[lastIn.index];
-				meshes[in.index] = meshes[lastIn.index];
-				worlds[in.index] = worlds[lastIn.index];
-				parents[in.index] = parents[lastIn.index];
-				drawModes[in.index] = drawModes[lastIn.index];
-				materials[in.index] = materials[lastIn.index];
-				staticIndices[in.index] = staticIndices[lastIn.index];
-				active[in.index] = active[lastIn.index];
-				dirty[in.index] = dirty[lastIn.index];
-			}
+		XASSERT(contains(id), "Invalid or stale ID %d", id);
+		uint32_t slot = handle::index(id);
+		EntityArrayIndex& in = indices[slot];
+		removeFromTypeList(in.index);
+		uint32_t last = num - 1;
+		if (in.index != last) {
+			EntityArrayIndex& lastIn = indices[handle::index(ids[last])];
+			ids[in.index] = ids[last];
+			positions[in.index] = positions[last];
+			scales[in.index] = scales[last];
+			rotations[in.index] = rotations[last];
+			colors[in.index] = colors[last];
+			timers[in.index] = timers[last];
+			types[in.index] = types[last];
+			textures[in.index] = textures[last];
+			meshes[in.index] = meshes[last];
+			worlds[in.index] = worlds[last];
+			parents[in.index] = parents[last];
+			drawModes[in.index] = drawModes[last];
+			materials[in.index] = materials[last];
+			staticIndices[in.index] = staticIndices[last];
+			active[in.index] = active[last];
+			dirty[in.index] = dirty[last];
+			typeIndices[in.index] = typeIndices[last];
+			bounds[in.index] = bounds[last];
 			lastIn.index = in.index;
 		}
-		in.index = UINT16_MAX;
-		freeList.push_back(id);
+		in.index = handle::INVALID_INDEX;
+		// invalidate all existing IDs of this slot
+		in.id = handle::next(in.id);
+		freeList.push_back(slot);
 		--num;
+		hierarchyChanged = true;
 	}
 }
\ No newline at end of file
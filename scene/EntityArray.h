@@ -3,18 +3,106 @@
 #include "..\renderer\render_types.h"
 #include "..\renderer\MeshBuffer.h"
 #include <core\world\ActionEventBuffer.h>
+#include "..\utils\Handle.h"
+#include "..\utils\JobSystem.h"
 
 namespace ds {
 
 	struct EntityArrayIndex {
 		ID id;
-		uint16_t index;
+		uint32_t index;
 	};
 
+	const uint32_t MAX_ENTITY_TYPES = 256;
+
+	// entities per chunk when a system runs in parallel - 1024 positions are 12KB
+	const uint32_t ENTITY_CHUNK_SIZE = 1024;
+
+	// reserveAhead prepares the next buffer once capacity / ENTITY_RESERVE_DIVISOR is used
+	const uint32_t ENTITY_RESERVE_DIVISOR = 2;
+	// bytes of the prepared buffer touched and later bytes of columns moved per frame
+	const uint32_t ENTITY_PREFAULT_BYTES = 2 * 1024 * 1024;
+
+	// growing arrays with at least this many entities copies the columns in parallel
+	const uint32_t ENTITY_PARALLEL_COPY = 16384;
+
+	// ------------------------------------------------------
+	// IDs of all entities of one type. Only valid until the
+	// next create/remove/setType.
+	// ------------------------------------------------------
+	struct EntityTypeQuery {
+		const ID* first;
+		uint32_t num;
+
+		const ID* begin() const {
+			return first;
+		}
+		const ID* end() const {
+			return first + num;
+		}
+		uint32_t size() const {
+			return num;
+		}
+	};
+
+	// ------------------------------------------------------
+	// all columns in the order they are stored in the buffer
+	// ------------------------------------------------------
+	enum EntityColumn {
+		COLUMN_INDICES,
+		COLUMN_IDS,
+		COLUMN_POSITIONS,
+		COLUMN_SCALES,
+		COLUMN_ROTATIONS,
+		COLUMN_COLORS,
+		COLUMN_TIMERS,
+		COLUMN_TYPES,
+		COLUMN_TEXTURES,
+		COLUMN_MESHES,
+		COLUMN_WORLDS,
+		COLUMN_PARENTS,
+		COLUMN_DRAWMODES,
+		COLUMN_MATERIALS,
+		COLUMN_STATICINDICES,
+		COLUMN_ACTIVE,
+		COLUMN_DIRTY,
+		COLUMN_TYPEINDICES,
+		COLUMN_BOUNDS,
+		NUM_ENTITY_COLUMNS
+	};
+
+	// ------------------------------------------------------
+	// typed view of one column. Only valid until the next
+	// create/remove/reserveAhead since these may move the
+	// data.
+	// ------------------------------------------------------
+	template<class T>
+	struct ColumnView {
+		T* data;
+		uint32_t num;
+
+		T& operator[](uint32_t idx) const {
+			return data[idx];
+		}
+		T* begin() const {
+			return data;
+		}
+		T* end() const {
+			return data + num;
+		}
+		uint32_t size() const {
+			return num;
+		}
+	};
+
+	// ------------------------------------------------------
+	// SoA entity storage. IDs are generational handles so
+	// that an ID of a removed entity never aliases a new one.
+	// ------------------------------------------------------
 	struct EntityArray {
 	
-		uint16_t num;
-		uint16_t capacity;
+		uint32_t num;
+		uint32_t capacity;
 		EntityArrayIndex* indices;
 
 		ID* ids;
@@ -33,29 +121,79 @@ namespace ds {
 		int* staticIndices;
 		bool* active;
 		bool* dirty;
+		// position of the entity in the list of its type
+		uint32_t* typeIndices;
+		// world space box of the mesh - rebuilt with the world matrix
+		AABBox* bounds;
 		char* buffer;
 
+		// next buffer prepared by reserveAhead
+		char* pending;
+		uint32_t pendingCapacity;
+		uint32_t pendingSize;
+		uint32_t pendingTouched;
+		// columns already moved into pending - see EntityColumn
+		uint32_t pendingColumns;
+
 		ID current;
 		Array<ID> freeList;
 
-		EntityArray() : num(0), capacity(0), buffer(0), current(0) {
+		// data indices sorted parent first - rebuilt when the hierarchy changes
+		Array<uint32_t> transformOrder;
+		Array<uint32_t> depths;
+		bool hierarchyChanged;
+
+		// IDs per type
+		Array<ID> typeLists[MAX_ENTITY_TYPES];
+
+		EntityArray() : num(0), capacity(0), buffer(0), pending(0), pendingCapacity(0), pendingSize(0), pendingTouched(0), pendingColumns(0), current(0), hierarchyChanged(true) {
 			allocate(256);
 			clear();
 		}
 
 		void clear() {
 			if (buffer != 0) {
-				for (unsigned short i = 0; i < capacity; ++i) {
-					indices[i].id = i;
-					indices[i].index = UINT16_MAX;
+				for (uint32_t i = 0; i < capacity; ++i) {
+					indices[i].id = handle::make(i, handle::generation(indices[i].id) + 1);
+					indices[i].index = handle::INVALID_INDEX;
 				}				
 				freeList.clear();
 			}
+			for (uint32_t i = 0; i < MAX_ENTITY_TYPES; ++i) {
+				typeLists[i].clear();
+			}
 			num = 0;
 			current = 0;
+			hierarchyChanged = true;
+		}
+
+		void allocate(uint32_t size);
+
+		void reserve(uint32_t size) {
+			allocate(size);
 		}
 
-		void allocate(uint16_t size);
+		// spreads the growth of the storage over several frames
+		void reserveAhead();
+
+		// frees the storage
+		void release();
+
+		// untyped access to a column - see EntityColumn
+		static uint32_t columnSize(uint32_t column);
+
+		char* getColumn(uint32_t column) const;
+
+		// true if restore can use the slots - every slot is live or free once, its handle points
+		// back to it and a live slot matches the ID stored at its entity index
+		static bool validSlots(const EntityArrayIndex* slots, uint32_t numSlots, const ID* freeSlots, uint32_t numFree, const ID* entityIds, uint32_t numEntities);
+
+		// replaces all slots - used when loading a snapshot. Check them with validSlots first.
+		void restore(const EntityArrayIndex* slots, uint32_t numSlots, const ID* freeSlots, uint32_t numFree, uint32_t numEntities);
+
+		void rebuildTypeLists();
+
+		void rebuildBounds();
 
 		bool contains(ID id) const;
 
@@ -69,11 +207,51 @@ namespace ds {
 
 		void setStaticIndex(ID id, int idx);
 
+		void setParent(ID child, ID parent);
+
+		void setType(ID id, uint16_t type);
+
+		EntityTypeQuery query(uint16_t type) const;
+
+		// view of [0,num) of a column, for example column(&EntityArray::positions)
+		template<class T>
+		ColumnView<T> column(T* EntityArray::* member) const {
+			ColumnView<T> view;
+			view.data = this->*member;
+			view.num = num;
+			return view;
+		}
+
+		// ------------------------------------------------------
+		// runs fn(start, end) on chunks of [0,num) on the job
+		// workers. A system that changes positions, rotations
+		// or scales has to set dirty[i] so that the world
+		// matrix is rebuilt. Entities must not be created or
+		// removed inside fn since that moves the columns. A
+		// parallelFor inside fn runs on the calling worker.
+		// ------------------------------------------------------
+		template<class F>
+		void forEachChunk(F& fn, uint32_t chunkSize = ENTITY_CHUNK_SIZE) {
+			jobs::parallelFor(num, chunkSize, fn);
+		}
+
 		int getIndex(ID id) const;
 
 		const mat4& getWorld(ID id) const;
 
 		void updateWorld(ID id);
+
+		// moved receives the IDs of all entities whose world matrix changed
+		void updateTransforms(Array<ID>* moved = 0);
+
+	private:
+		void assignColumn(uint32_t column, char* p);
+		uint32_t nextCapacity() const;
+		void initSlots(uint32_t start, uint32_t end);
+		void updateBounds(uint32_t index);
+		void buildTransformOrder();
+		void addToTypeList(uint32_t index);
+		void removeFromTypeList(uint32_t index);
 	};
 
 }
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include "Scene.h"
 #include "..\resources\ResourceContainer.h"
+#include "..\renderer\Culling.h"
+#include "..\stats\DrawCounter.h"
+#include "SceneSnapshot.h"
+#include "..\renderer\MeshLOD.h"
+#include "..\renderer\MeshSimplifier.h"
+#include "..\resources\MeshLoader.h"
+#include <algorithm>
 
 namespace ds {
 
@@ -7,15 +14,14 @@ namespace ds {
 		_meshBuffer = res::getMeshBuffer(descriptor.meshBuffer);
 		_camera = graphics::getFPSCamera();
 		_depthEnabled = descriptor.depthEnabled;
-
-
+		_instancing = _meshBuffer->supportsInstancing();
+		_lodError = 1.0f;
+		_meshGeneration = loader::generation();
+		_data.reserve(descriptor.size);
 	}
 
 	Scene::~Scene()	{
-		if (_data.buffer != 0) {
-			DEALLOC(_data.buffer);
-		}
-
+		_data.release();
 	}
 
 	// ------------------------------------
@@ -30,7 +36,9 @@ namespace ds {
 	// add entity
 	// ------------------------------------
 	ID Scene::add(Mesh* mesh, const v3& position, RID material, DrawMode mode) {
-		return _data.create(position, mesh, v3(1, 1, 1), v3(0, 0, 0), material, Color::WHITE);
+		ID id = _data.create(position, mesh, v3(1, 1, 1), v3(0, 0, 0), material, Color::WHITE);
+		addProxy(id);
+		return id;
 		/*
 		ID id = _entities.add();
 		Entity& e = _entities.get(id);
@@ -54,10 +62,11 @@ namespace ds {
 	// add entity
 	// ------------------------------------
 	ID Scene::addStatic(Mesh* mesh, const v3& position, RID material) {
+		// the vertices are copied into the chunks so the placeholder cannot be used
+		loader::wait(mesh);
 		ID id = _data.create(position, mesh, v3(1, 1, 1), v3(0, 0, 0), material, Color::WHITE);
 		_data.setDrawMode(id, DrawMode::STATIC);
-		_data.setStaticIndex(id, _staticMeshes.size());
-		const mat4& world = _data.getWorld(id);
+		_data.setStaticIndex(id, _staticChunks.add(mesh, _data.getWorld(id)));
 		/*
 		ID id = _entities.add();
 		Entity& e = _entities.get(id);
@@ -75,37 +84,18 @@ namespace ds {
 		e.staticIndex = _staticMeshes.size();
 		e.material = material;
 		*/
-		StaticMesh sm;
-		sm.id = id;
-		sm.index = _staticVertices.size();
-		sm.size = mesh->vertices.size();
-		for (uint32_t i = 0; i < mesh->vertices.size(); ++i) {
-			PNTCVertex v = mesh->vertices[i];
-			v.position = world * v.position;
-			_staticVertices.push_back(v);
-		}
-		_staticMeshes.push_back(sm);
+		addProxy(id);
 		return id;
 	}
 
-	void Scene::updateWorld(int idx) {
-		mat4 rotY = matrix::mat4RotationY(_data.rotations[idx].y);
-		mat4 rotX = matrix::mat4RotationX(_data.rotations[idx].x);
-		mat4 rotZ = matrix::mat4RotationZ(_data.rotations[idx].z);
-		mat4 t = matrix::mat4Transform(_data.positions[idx]);
-		mat4 s = matrix::mat4Scale(_data.scales[idx]);
-		_data.worlds[idx] = rotZ * rotY * rotX * s * t;
-		_data.dirty[idx] = false;
-		if (_data.parents[idx] != INVALID_ID) {
-			int pidx = _data.getIndex(_data.parents[idx]);
-			_data.worlds[idx] = _data.worlds[idx] * _data.worlds[pidx];
-		}
-	}
-
 	void Scene::activate(ID id) {
 		if (_data.contains(id)) {
 			int idx = _data.getIndex(id);
 			_data.active[idx] = true;
+			if (_data.drawModes[idx] == DrawMode::STATIC) {
+				_staticChunks.setActive(_data.staticIndices[idx], true);
+			}
+			addProxy(id);
 		}
 	}
 
@@ -136,6 +126,10 @@ namespace ds {
 		if (_data.contains(id)) {
 			int idx = _data.getIndex(id);
 			_data.active[idx] = false;
+			if (_data.drawModes[idx] == DrawMode::STATIC) {
+				_staticChunks.setActive(_data.staticIndices[idx], false);
+			}
+			removeProxy(id);
 		}
 	}
 
@@ -152,19 +146,25 @@ namespace ds {
 	// ------------------------------------
 	void Scene::attach(ID child, ID parent)	{
 		if (_data.contains(child)) {
-			int idx = _data.getIndex(child);
-			_data.parents[idx] = parent;
+			_data.setParent(child, parent);
 		}
 	}
 
 	void Scene::clear() {
 		_data.clear();
+		_bounds.clear();
+		_proxies.clear();
+		_moved.clear();
+		_staticChunks.clear();
 	}
 	// ------------------------------------
 	// draw
 	// ------------------------------------
 	void Scene::draw() {
 		ZoneTracker z("Scene::draw");
+		updateBounds();
+		// grow here instead of inside add during the game logic
+		_data.reserveAhead();
 		_currentMaterial = INVALID_RID;
 		graphics::setCamera(_camera);
 		if (_depthEnabled) {
@@ -173,27 +173,92 @@ namespace ds {
 		else {
 			graphics::turnOffZBuffer();
 		}
+		culling::Frustum frustum;
+		culling::extractFrustum(_camera->getViewProjectionMatrix(), &frustum);
+		cull(frustum);
+		_instances.clear();
 		_meshBuffer->begin();
 		for (int i = 0; i < _data.num; ++i) {
-			if (_data.active[i]) {
+			if (_visible[i]) {
+				Mesh* mesh = lod::select(_data.meshes[i], _screenSizes[i], _lodError);
+				if (_instancing && _data.drawModes[i] == DrawMode::TRANSFORM) {
+					_instances.add(mesh, _data.materials[i], i);
+					continue;
+				}
 				if (_data.materials[i] != _currentMaterial) {
 					_meshBuffer->flush();
 					_currentMaterial = _data.materials[i];
 				}
 				if (_data.drawModes[i] == DrawMode::IMMEDIATE) {
 					_meshBuffer->flush();
-					_meshBuffer->drawImmediate(_data.meshes[i], _data.worlds[i], _data.scales[i], _data.rotations[i], _data.colors[i]);
+					_meshBuffer->drawImmediate(mesh, _data.worlds[i], _data.scales[i], _data.rotations[i], _data.colors[i]);
 				}
 				else if (_data.drawModes[i] == DrawMode::TRANSFORM) {
-					_meshBuffer->add(_data.meshes[i], _data.worlds[i], _data.colors[i]);
-				}
-				else if (_data.drawModes[i] == DrawMode::STATIC) {
-					const StaticMesh& sm = _staticMeshes[_data.staticIndices[i]];
-					_meshBuffer->add(_staticVertices.data() + sm.index, sm.size);
+					_meshBuffer->reserve(mesh, _data.worlds[i], _data.colors[i]);
 				}
 			}
 		}
+		// all TRANSFORM entities are transformed in parallel
+		_meshBuffer->submit();
 		_meshBuffer->end();
+		_staticChunks.draw(_meshBuffer, frustum);
+		if (_instancing) {
+			_instances.build(_data.worlds, _data.colors);
+			_meshBuffer->drawInstanced(_instances);
+		}
+	}
+
+	// ------------------------------------
+	// TRANSFORM entities are drawn instanced
+	// if the mesh buffer supports it
+	// ------------------------------------
+	void Scene::setInstancing(bool instancing) {
+		_instancing = instancing && _meshBuffer->supportsInstancing();
+	}
+
+	// ------------------------------------
+	// frustum culling - all dynamic entities
+	// are gathered and tested in one batch.
+	// Static meshes are culled per chunk.
+	// The screen size of every candidate is
+	// kept for the LOD selection.
+	// ------------------------------------
+	void Scene::cull(const culling::Frustum& frustum) {
+		ZoneTracker z("Scene::cull");
+		_visible.clear();
+		_centers.clear();
+		_extents.clear();
+		_candidates.clear();
+		_screenSizes.clear();
+		const v3& eye = _camera->getPosition();
+		float projectionScale = _camera->getProjectionMatrix()._22 * graphics::getScreenHeight() * 0.5f;
+		uint32_t tested = 0;
+		for (uint32_t i = 0; i < _data.num; ++i) {
+			bool v = false;
+			float size = 0.0f;
+			if (_data.active[i] && _data.drawModes[i] != DrawMode::STATIC) {
+				if (_data.meshes[i] != 0) {
+					++tested;
+					const AABBox& bb = _data.bounds[i];
+					_centers.push_back(bb.position);
+					_extents.push_back(bb.extent);
+					_candidates.push_back(i);
+					size = simplify::screenSize(length(bb.extent), length(bb.position - eye), projectionScale);
+				}
+			}
+			_visible.push_back(v);
+			_screenSizes.push_back(size);
+		}
+		_visibleIndices.clear();
+		for (uint32_t i = 0; i < _candidates.size(); ++i) {
+			_visibleIndices.push_back(0);
+		}
+		uint32_t cnt = culling::cullBoxes(frustum, _centers.data(), _extents.data(), _candidates.size(), _visibleIndices.data());
+		for (uint32_t i = 0; i < cnt; ++i) {
+			_visible[_candidates[_visibleIndices[i]]] = true;
+		}
+		gDrawCounter->visibleMeshes += cnt;
+		gDrawCounter->culledMeshes += tested - cnt;
 	}
 
 	// ------------------------------------
@@ -201,62 +266,156 @@ namespace ds {
 	// ------------------------------------
 	int Scene::find(int type, ID* ids, int max) {
 		int cnt = 0;
-		/*
-		for (EntityList::iterator it = _entities.begin(); it != _entities.end(); ++it) {
-			const Entity& e = (*it);
-			if (e.type == type && cnt < max) {
-				ids[cnt++] = e.id;
-			}
+		EntityTypeQuery q = _data.query(type);
+		for (const ID* it = q.begin(); it != q.end() && cnt < max; ++it) {
+			ids[cnt++] = *it;
 		}
-		*/
 		return cnt;
 	}
+
+	void Scene::setType(ID id, int type) {
+		if (_data.contains(id)) {
+			_data.setType(id, type);
+		}
+	}
 	
 	// ------------------------------------
 	// remove entity
 	// ------------------------------------
 	void Scene::remove(ID id) {
 		// check if this is a parent to anyone and then remove this as well?
+		removeProxy(id);
+		int idx = _data.getIndex(id);
+		if (idx != -1 && _data.drawModes[idx] == DrawMode::STATIC) {
+			_staticChunks.remove(_data.staticIndices[idx]);
+		}
 		_data.remove(id);
 	}
 
 	// ------------------------------------
-	// intersects with ray
+	// world AABB of the mesh bounding box
+	// cached by the entity array
 	// ------------------------------------
-	ID Scene::intersects(const Ray& ray) {
-		float t0 = 0.0f;
-		float t1 = 0.0f;
-		ID ret = INVALID_ID;
-		float tm = 0.0f;
-		for ( int i = 0; i < _data.num; ++i ) {
-			if (_data.active[i]) {
-				AABBox bb = _data.meshes[i]->boundingBox;
-				bb.transpose(_data.positions[i]);
-				/*
-				if (bb.intersects(ray, &t0, &t1)) {
-					if (ret == INVALID_ID) {
-						tm = t0;
-						ret = _data.ids[i];
-					}
-					else {
-						if (t0 < tm) {
-							tm = t0;
-							ret = _data.ids[i];
-						}
-					}
+	void Scene::getWorldBounds(int idx, v3* min, v3* max) const {
+		const AABBox& bb = _data.bounds[idx];
+		*min = bb.position - bb.extent;
+		*max = bb.position + bb.extent;
+	}
+
+	// ------------------------------------
+	// add entity to the bounds tree
+	// ------------------------------------
+	void Scene::addProxy(ID id) {
+		int idx = _data.getIndex(id);
+		if (idx == -1 || _data.meshes[idx] == 0) {
+			return;
+		}
+		uint32_t slot = handle::index(id);
+		while (_proxies.size() <= slot) {
+			_proxies.push_back(-1);
+		}
+		if (_proxies[slot] == -1) {
+			v3 min, max;
+			getWorldBounds(idx, &min, &max);
+			_proxies[slot] = _bounds.insert(min, max, id);
+		}
+	}
+
+	void Scene::removeProxy(ID id) {
+		uint32_t slot = handle::index(id);
+		if (slot < _proxies.size() && _proxies[slot] != -1 && _bounds.getData(_proxies[slot]) == id) {
+			_bounds.remove(_proxies[slot]);
+			_proxies[slot] = -1;
+		}
+	}
+
+	// ------------------------------------
+	// marks the entities whose streamed mesh
+	// has replaced its placeholder since the
+	// last bounds update
+	// ------------------------------------
+	void Scene::markReplacedMeshes() {
+		uint32_t generation = loader::generation();
+		if (generation == _meshGeneration) {
+			return;
+		}
+		if (generation < _meshGeneration) {
+			// the loader was restarted
+			memset(_data.dirty, 1, _data.num * sizeof(bool));
+		}
+		else {
+			uint32_t num = 0;
+			const Mesh* const* replaced = loader::replaced(_meshGeneration, &num);
+			_replaced.clear();
+			for (uint32_t i = 0; i < num; ++i) {
+				_replaced.push_back(replaced[i]);
+			}
+			const Mesh** first = _replaced.data();
+			const Mesh** last = first + num;
+			std::sort(first, last);
+			for (int i = 0; i < _data.num; ++i) {
+				if (std::binary_search(first, last, (const Mesh*)_data.meshes[i])) {
+					_data.dirty[i] = true;
 				}
-				*/
 			}
 		}
-		/*
-		if (ret != INVALID_ID) {
-			LOG << "INTERSECTION!!!! id: " << ret << " t0: " << t0 << " t1: " << t1;
+		_meshGeneration = generation;
+	}
+
+	// ------------------------------------
+	// update transforms and refit the bounds
+	// of every entity that has moved or whose
+	// mesh has replaced its placeholder.
+	// ------------------------------------
+	void Scene::updateBounds() {
+		markReplacedMeshes();
+		_moved.clear();
+		_data.updateTransforms(&_moved);
+		for (uint32_t i = 0; i < _moved.size(); ++i) {
+			ID id = _moved[i];
+			uint32_t slot = handle::index(id);
+			if (slot < _proxies.size() && _proxies[slot] != -1) {
+				v3 min, max;
+				getWorldBounds(_data.getIndex(id), &min, &max);
+				_bounds.move(_proxies[slot], min, max);
+			}
 		}
-		else {
-			LOG << "NO intersection!";
+	}
+
+	// ------------------------------------
+	// intersects with ray - returns the
+	// nearest active entity
+	// ------------------------------------
+	ID Scene::intersects(const Ray& ray) {
+		updateBounds();
+		uint32_t data = INVALID_ID;
+		float t = 0.0f;
+		if (_bounds.raycast(ray, &data, &t)) {
+			return data;
 		}
-		*/
-		return ret;
+		return INVALID_ID;
+	}
+
+	// ------------------------------------
+	// intersects with many rays - writes
+	// the nearest entity or INVALID_ID per
+	// ray and returns the number of hits
+	// ------------------------------------
+	uint32_t Scene::intersects(const Ray* rays, uint32_t num, ID* ids) {
+		updateBounds();
+		uint32_t cnt = 0;
+		for (uint32_t i = 0; i < num; ++i) {
+			uint32_t data = INVALID_ID;
+			float t = 0.0f;
+			if (_bounds.raycast(rays[i], &data, &t)) {
+				ids[i] = data;
+				++cnt;
+			}
+			else {
+				ids[i] = INVALID_ID;
+			}
+		}
+		return cnt;
 	}
 
 	// ------------------------------------
@@ -293,6 +452,239 @@ namespace ds {
 		writer.endBox();
 		*/
 	}
+	// ------------------------------------
+	// resource table of a snapshot
+	// ------------------------------------
+	static uint32_t addSnapshotResource(RID rid, ResourceType type, Array<SnapshotResource>& resources, Array<RID>& rids, Array<char>& names) {
+		if (rid == INVALID_RID) {
+			return SNAPSHOT_NO_RESOURCE;
+		}
+		for (uint32_t i = 0; i < rids.size(); ++i) {
+			if (rids[i] == rid && resources[i].type == type) {
+				return i;
+			}
+		}
+		SnapshotResource r;
+		r.type = type;
+		r.nameOffset = names.size();
+		const char* name = res::getName(rid);
+		for (const char* c = name; *c != 0; ++c) {
+			names.push_back(*c);
+		}
+		names.push_back(0);
+		resources.push_back(r);
+		rids.push_back(rid);
+		return resources.size() - 1;
+	}
+
+	// bytes of all stored columns per entity
+	static uint32_t snapshotEntitySize() {
+		uint32_t size = 0;
+		for (uint32_t c = COLUMN_IDS; c <= COLUMN_ACTIVE; ++c) {
+			size += (c == COLUMN_MESHES || c == COLUMN_MATERIALS) ? sizeof(uint32_t) : EntityArray::columnSize(c);
+		}
+		return size;
+	}
+
+	// first stored column of the snapshot is COLUMN_IDS
+	static const char* snapshotColumn(const char* columns, uint32_t num, uint32_t column) {
+		for (uint32_t c = COLUMN_IDS; c < column; ++c) {
+			columns += num * ((c == COLUMN_MESHES || c == COLUMN_MATERIALS) ? sizeof(uint32_t) : EntityArray::columnSize(c));
+		}
+		return columns;
+	}
+
+	// ------------------------------------
+	// save binary snapshot
+	// ------------------------------------
+	bool Scene::saveSnapshot(const char* fileName) {
+		ZoneTracker z("Scene::saveSnapshot");
+		// make sure all world matrices are up to date
+		updateBounds();
+		Array<SnapshotResource> resources;
+		Array<RID> rids;
+		Array<char> names;
+		Array<uint32_t> meshRefs;
+		Array<uint32_t> materialRefs;
+		Mesh* lastMesh = 0;
+		uint32_t lastMeshRef = SNAPSHOT_NO_RESOURCE;
+		for (uint32_t i = 0; i < _data.num; ++i) {
+			Mesh* m = _data.meshes[i];
+			if (m != lastMesh) {
+				lastMeshRef = SNAPSHOT_NO_RESOURCE;
+				if (m != 0) {
+					RID rid = res::findMesh(m);
+					if (rid == INVALID_RID) {
+						LOGE << "Cannot save snapshot '" << fileName << "' - entity " << _data.ids[i] << " uses a mesh that is not a resource";
+						return false;
+					}
+					lastMeshRef = addSnapshotResource(rid, ResourceType::MESH, resources, rids, names);
+				}
+				lastMesh = m;
+			}
+			meshRefs.push_back(lastMeshRef);
+			materialRefs.push_back(addSnapshotResource(_data.materials[i], ResourceType::MATERIAL, resources, rids, names));
+		}
+		FILE* f = fopen(fileName, "wb");
+		if (f == 0) {
+			LOGE << "Cannot open snapshot file '" << fileName << "'";
+			return false;
+		}
+		SnapshotHeader header;
+		header.magic = SNAPSHOT_MAGIC;
+		header.version = SNAPSHOT_VERSION;
+		header.numResources = resources.size();
+		header.namesSize = names.size();
+		header.numSlots = _data.current;
+		header.numFree = _data.freeList.size();
+		header.numEntities = _data.num;
+		header.numStaticMeshes = _staticChunks.numMeshes();
+		header.numStaticVertices = _staticChunks.numVertices();
+		fwrite(&header, sizeof(SnapshotHeader), 1, f);
+		fwrite(resources.data(), sizeof(SnapshotResource), resources.size(), f);
+		fwrite(names.data(), 1, names.size(), f);
+		fwrite(_data.indices, sizeof(EntityArrayIndex), header.numSlots, f);
+		fwrite(_data.freeList.data(), sizeof(ID), header.numFree, f);
+		for (uint32_t c = COLUMN_IDS; c <= COLUMN_ACTIVE; ++c) {
+			if (c == COLUMN_MESHES) {
+				fwrite(meshRefs.data(), sizeof(uint32_t), meshRefs.size(), f);
+			}
+			else if (c == COLUMN_MATERIALS) {
+				fwrite(materialRefs.data(), sizeof(uint32_t), materialRefs.size(), f);
+			}
+			else {
+				fwrite(_data.getColumn(c), EntityArray::columnSize(c), _data.num, f);
+			}
+		}
+		fwrite(_staticChunks.getMeshes(), sizeof(StaticMesh), header.numStaticMeshes, f);
+		fwrite(_staticChunks.getVertices(), sizeof(PNTCVertex), header.numStaticVertices, f);
+		fclose(f);
+		LOG << "snapshot '" << fileName << "' saved - entities: " << header.numEntities << " resources: " << header.numResources;
+		return true;
+	}
+
+	// ------------------------------------
+	// load binary snapshot - the file is
+	// read in one go and the columns are
+	// copied as blocks
+	// ------------------------------------
+	bool Scene::loadSnapshot(const char* fileName) {
+		ZoneTracker z("Scene::loadSnapshot");
+		FILE* f = fopen(fileName, "rb");
+		if (f == 0) {
+			LOGE << "Cannot open snapshot file '" << fileName << "'";
+			return false;
+		}
+		fseek(f, 0, SEEK_END);
+		uint32_t fileSize = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		if (fileSize < sizeof(SnapshotHeader)) {
+			LOGE << "Invalid snapshot file '" << fileName << "'";
+			fclose(f);
+			return false;
+		}
+		char* data = (char*)ALLOC(fileSize);
+		uint32_t read = fread(data, 1, fileSize, f);
+		fclose(f);
+		const SnapshotHeader* header = (const SnapshotHeader*)data;
+		bool valid = read == fileSize && header->magic == SNAPSHOT_MAGIC && header->version == SNAPSHOT_VERSION;
+		if (valid) {
+			uint64_t expected = sizeof(SnapshotHeader) + (uint64_t)header->numResources * sizeof(SnapshotResource) + header->namesSize;
+			expected += (uint64_t)header->numSlots * sizeof(EntityArrayIndex) + (uint64_t)header->numFree * sizeof(ID);
+			expected += (uint64_t)header->numEntities * snapshotEntitySize();
+			expected += (uint64_t)header->numStaticMeshes * sizeof(StaticMesh) + (uint64_t)header->numStaticVertices * sizeof(PNTCVertex);
+			valid = expected == fileSize && header->numEntities <= header->numSlots && header->numSlots <= handle::MAX_INDEX;
+		}
+		if (!valid) {
+			LOGE << "Invalid snapshot file '" << fileName << "'";
+			DEALLOC(data);
+			return false;
+		}
+		const char* ptr = data + sizeof(SnapshotHeader);
+		const SnapshotResource* resources = (const SnapshotResource*)ptr;
+		ptr += header->numResources * sizeof(SnapshotResource);
+		const char* names = ptr;
+		ptr += header->namesSize;
+		// resolve all meshes and materials before the scene is touched
+		Array<Mesh*> meshes;
+		Array<RID> materials;
+		for (uint32_t i = 0; i < header->numResources; ++i) {
+			const SnapshotResource& r = resources[i];
+			bool validType = r.type == ResourceType::MESH || r.type == ResourceType::MATERIAL;
+			if (!validType || r.nameOffset >= header->namesSize || names[header->namesSize - 1] != 0) {
+				LOGE << "Invalid snapshot file '" << fileName << "'";
+				DEALLOC(data);
+				return false;
+			}
+			const char* name = names + r.nameOffset;
+			if (!res::contains(SID(name), (ResourceType)r.type)) {
+				LOGE << "Snapshot '" << fileName << "' - cannot find resource: " << name;
+				DEALLOC(data);
+				return false;
+			}
+			RID rid = res::find(name, (ResourceType)r.type);
+			meshes.push_back(r.type == ResourceType::MESH ? res::getMesh(rid) : 0);
+			materials.push_back(rid);
+		}
+		// slots, types, static indices and static meshes are checked before the scene is touched as well
+		const EntityArrayIndex* slots = (const EntityArrayIndex*)ptr;
+		ptr += header->numSlots * sizeof(EntityArrayIndex);
+		const ID* freeSlots = (const ID*)ptr;
+		ptr += header->numFree * sizeof(ID);
+		const ID* ids = (const ID*)snapshotColumn(ptr, header->numEntities, COLUMN_IDS);
+		valid = EntityArray::validSlots(slots, header->numSlots, freeSlots, header->numFree, ids, header->numEntities);
+		const uint16_t* types = (const uint16_t*)snapshotColumn(ptr, header->numEntities, COLUMN_TYPES);
+		const int* staticIndices = (const int*)snapshotColumn(ptr, header->numEntities, COLUMN_STATICINDICES);
+		for (uint32_t i = 0; i < header->numEntities && valid; ++i) {
+			valid = types[i] < MAX_ENTITY_TYPES && (staticIndices[i] == -1 || (staticIndices[i] >= 0 && (uint32_t)staticIndices[i] < header->numStaticMeshes));
+		}
+		const StaticMesh* staticMeshes = (const StaticMesh*)(ptr + header->numEntities * snapshotEntitySize());
+		for (uint32_t i = 0; i < header->numStaticMeshes && valid; ++i) {
+			valid = (uint64_t)staticMeshes[i].index + staticMeshes[i].size <= header->numStaticVertices;
+		}
+		if (!valid) {
+			LOGE << "Invalid snapshot file '" << fileName << "'";
+			DEALLOC(data);
+			return false;
+		}
+		clear();
+		_data.restore(slots, header->numSlots, freeSlots, header->numFree, header->numEntities);
+		uint32_t num = header->numEntities;
+		for (uint32_t c = COLUMN_IDS; c <= COLUMN_ACTIVE; ++c) {
+			if (c == COLUMN_MESHES || c == COLUMN_MATERIALS) {
+				const uint32_t* refs = (const uint32_t*)ptr;
+				for (uint32_t i = 0; i < num; ++i) {
+					uint32_t ref = refs[i] < meshes.size() ? refs[i] : SNAPSHOT_NO_RESOURCE;
+					if (c == COLUMN_MESHES) {
+						_data.meshes[i] = ref != SNAPSHOT_NO_RESOURCE ? meshes[ref] : 0;
+					}
+					else {
+						_data.materials[i] = ref != SNAPSHOT_NO_RESOURCE ? materials[ref] : INVALID_RID;
+					}
+				}
+				ptr += num * sizeof(uint32_t);
+			}
+			else {
+				uint32_t size = num * EntityArray::columnSize(c);
+				memcpy(_data.getColumn(c), ptr, size);
+				ptr += size;
+			}
+		}
+		memset(_data.dirty, 0, num * sizeof(bool));
+		_data.rebuildTypeLists();
+		_data.rebuildBounds();
+		ptr += header->numStaticMeshes * sizeof(StaticMesh);
+		_staticChunks.restore(staticMeshes, header->numStaticMeshes, (const PNTCVertex*)ptr, header->numStaticVertices);
+		for (uint32_t i = 0; i < num; ++i) {
+			if (_data.active[i]) {
+				addProxy(_data.ids[i]);
+			}
+		}
+		LOG << "snapshot '" << fileName << "' loaded - entities: " << num;
+		DEALLOC(data);
+		return true;
+	}
+
 	/*
 	// ------------------------------------
 	// scale to
@@ -355,11 +747,7 @@ namespace ds {
 		if (_renderTarget != INVALID_RID && _rtActive) {
 			graphics::setRenderTarget(_renderTarget);
 		}
-		for (int i = 0; i < _data.num; ++i) {
-			if (_data.active[i]) {
-				sprites->draw(_data.positions[i].xy(), _data.textures[i],_data.rotations[i].z,_data.scales[i].xy(),_data.colors[i], _data.materials[i]);
-			}
-		}
+		sprites->draw(_data);
 		/*
 		for (uint32_t i = 0; i < _particleSystems.numObjects; ++i) {
 			const ParticleArray& array = _particleSystems.objects[i].system->getArray();
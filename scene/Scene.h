@@ -5,6 +5,8 @@
 #include "..\renderer\MeshBuffer.h"
 #include "..\renderer\Camera.h"
 #include "EntityArray.h"
+#include "AABBTree.h"
+#include "StaticChunks.h"
 #include <core\world\ActionEventBuffer.h>
 #include "core\math\tweening.h"
 #include "..\particles\ParticleSystem.h"
@@ -14,13 +16,6 @@ namespace ds {
 
 	//const int MAX_ACTIONS = 32;
 
-	struct StaticMesh {
-		ID id;
-		uint32_t index;
-		uint32_t size;
-		AABBox boundingBox;
-	};
-
 	// ----------------------------------------
 	// Basic scene
 	// ----------------------------------------
@@ -36,10 +31,19 @@ namespace ds {
 		void remove(ID id);
 		virtual void draw();
 		int find(int type, ID* ids, int max);
+		EntityTypeQuery query(int type) const {
+			return _data.query(type);
+		}
+		void setType(ID id, int type);
 		ID intersects(const Ray& ray);
+		uint32_t intersects(const Ray* rays, uint32_t num, ID* ids);
 		uint32_t numEntities() const {
 			return _data.num;
 		}
+		// direct access to the columns for systems - see EntityArray::forEachChunk
+		EntityArray& getEntities() {
+			return _data;
+		}
 		virtual void tick(float dt);
 		void rotate(ID id, const v3& r);
 		void activate(ID id);
@@ -48,6 +52,14 @@ namespace ds {
 		void clear();
 		bool isActive(ID id) const;
 		void setPosition(ID id, const v3& p);
+		void setInstancing(bool instancing);
+		bool isInstancing() const {
+			return _instancing;
+		}
+		// largest error in pixels a LOD level may have on screen
+		void setLODError(float pixels) {
+			_lodError = pixels;
+		}
 
 		// actions
 		bool hasEvents() const {
@@ -63,6 +75,9 @@ namespace ds {
 
 
 		void save(const ReportWriter& writer);
+		// binary snapshot of all entities and the static geometry
+		bool saveSnapshot(const char* fileName);
+		bool loadSnapshot(const char* fileName);
 		const bool isActive() const {
 			return _active;
 		}
@@ -71,20 +86,45 @@ namespace ds {
 		}
 	protected:
 		EntityArray _data;
+		void updateBounds();
 	private:
+		void addProxy(ID id);
+		void removeProxy(ID id);
+		void markReplacedMeshes();
+		void getWorldBounds(int idx, v3* min, v3* max) const;
+		void cull(const culling::Frustum& frustum);
 		bool _active;
-		void updateWorld(int idx);
 
 		SceneDescriptor _descriptor;
 		RID _currentMaterial;
 		
 		MeshBuffer* _meshBuffer;
 		Camera* _camera;
-		Array<PNTCVertex> _staticVertices;
-		Array<StaticMesh> _staticMeshes;
+		StaticChunks _staticChunks;
 		
 		ActionEventBuffer _eventBuffer;
 		bool _depthEnabled;
+		bool _instancing;
+		InstanceBatch _instances;
+
+		// world bounds of all active mesh entities - proxies are indexed by the handle slot
+		AABBTree _bounds;
+		Array<int> _proxies;
+		Array<ID> _moved;
+
+		// frustum culling scratch data
+		Array<bool> _visible;
+		Array<v3> _centers;
+		Array<v3> _extents;
+		Array<uint32_t> _candidates;
+		Array<uint32_t> _visibleIndices;
+		// size of the bounding sphere on screen in pixels - selects the LOD level
+		Array<float> _screenSizes;
+		float _lodError;
+		// loader::generation of the last bounds update
+		uint32_t _meshGeneration;
+		// meshes replaced since then sorted by address
+		Array<const Mesh*> _replaced;
 	};
 
 	// ----------------------------------------
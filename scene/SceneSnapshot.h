@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+namespace ds {
+
+	// ------------------------------------------------------
+	// Binary snapshot of a scene. Layout:
+	//   SnapshotHeader
+	//   SnapshotResource[numResources]
+	//   names (namesSize bytes - zero terminated)
+	//   EntityArrayIndex[numSlots]
+	//   ID[numFree]
+	//   columns COLUMN_IDS..COLUMN_STATICINDICES + COLUMN_ACTIVE
+	//   for numEntities each. Meshes and materials are stored
+	//   as uint32_t index into the resource table.
+	//   StaticMesh[numStaticMeshes]
+	//   PNTCVertex[numStaticVertices]
+	// Textures are stored as they are.
+	// ------------------------------------------------------
+	const uint32_t SNAPSHOT_MAGIC = 0x4E535344; // DSSN
+	const uint32_t SNAPSHOT_VERSION = 1;
+	// resource index of entities without mesh or material
+	const uint32_t SNAPSHOT_NO_RESOURCE = UINT32_MAX;
+
+	struct SnapshotHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numResources;
+		uint32_t namesSize;
+		uint32_t numSlots;
+		uint32_t numFree;
+		uint32_t numEntities;
+		uint32_t numStaticMeshes;
+		uint32_t numStaticVertices;
+	};
+
+	// mesh or material resolved by name when loading
+	struct SnapshotResource {
+		uint32_t type;
+		uint32_t nameOffset;
+	};
+
+}
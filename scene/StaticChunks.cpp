@@ -0,0 +1,328 @@
+#include "StaticChunks.h"
+#include "..\renderer\MeshBuffer.h"
+#include "..\renderer\graphics.h"
+#include "..\renderer\VertexTransform.h"
+#include "..\renderer\VertexPacking.h"
+#include "..\stats\DrawCounter.h"
+#include "core\base\Assert.h"
+#include "core\profiler\Profiler.h"
+#include "core\memory\DefaultAllocator.h"
+#include <math.h>
+
+namespace ds {
+
+	StaticChunks::~StaticChunks() {
+		clear();
+		if (_cells != 0) {
+			DEALLOC(_cells);
+		}
+	}
+
+	static inline uint32_t cellHash(int x, int y, int z) {
+		return ((uint32_t)x * 73856093) ^ ((uint32_t)y * 19349663) ^ ((uint32_t)z * 83492791);
+	}
+
+	// ------------------------------------------------------
+	// clear - releases all buffers
+	// ------------------------------------------------------
+	void StaticChunks::clear() {
+		for (uint32_t i = 0; i < _chunks.size(); ++i) {
+			graphics::releaseVertexBuffer(_chunks[i].buffer);
+		}
+		_chunks.clear();
+		_meshes.clear();
+		_vertices.clear();
+		_removedVertices = 0;
+		for (uint32_t i = 0; i < _cellCapacity; ++i) {
+			_cells[i] = -1;
+		}
+	}
+
+	// ------------------------------------------------------
+	// rebuild the cell hash for all chunks
+	// ------------------------------------------------------
+	void StaticChunks::buildCells() {
+		uint32_t capacity = 64;
+		while (capacity < _chunks.size() * 2) {
+			capacity *= 2;
+		}
+		if (capacity != _cellCapacity) {
+			if (_cells != 0) {
+				DEALLOC(_cells);
+			}
+			_cells = (int*)ALLOC(capacity * sizeof(int));
+			_cellCapacity = capacity;
+		}
+		for (uint32_t i = 0; i < _cellCapacity; ++i) {
+			_cells[i] = -1;
+		}
+		for (uint32_t i = 0; i < _chunks.size(); ++i) {
+			addToCells(i);
+		}
+	}
+
+	void StaticChunks::addToCells(uint32_t chunkIndex) {
+		const StaticChunk& c = _chunks[chunkIndex];
+		uint32_t mask = _cellCapacity - 1;
+		uint32_t slot = cellHash(c.x, c.y, c.z) & mask;
+		while (_cells[slot] != -1) {
+			slot = (slot + 1) & mask;
+		}
+		_cells[slot] = chunkIndex;
+	}
+
+	// ------------------------------------------------------
+	// find or create the chunk of the grid cell
+	// ------------------------------------------------------
+	uint32_t StaticChunks::findChunk(const v3& center) {
+		int x = (int)floor(center.x / STATIC_CHUNK_SIZE);
+		int y = (int)floor(center.y / STATIC_CHUNK_SIZE);
+		int z = (int)floor(center.z / STATIC_CHUNK_SIZE);
+		if (_cells != 0) {
+			uint32_t mask = _cellCapacity - 1;
+			uint32_t slot = cellHash(x, y, z) & mask;
+			while (_cells[slot] != -1) {
+				const StaticChunk& c = _chunks[_cells[slot]];
+				if (c.x == x && c.y == y && c.z == z) {
+					return _cells[slot];
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+		StaticChunk c;
+		c.x = x;
+		c.y = y;
+		c.z = z;
+		c.min = center;
+		c.max = center;
+		c.first = -1;
+		c.numMeshes = 0;
+		c.numVertices = 0;
+		c.capacity = 0;
+		c.buffer = 0;
+		c.dirty = false;
+		_chunks.push_back(c);
+		// keep the load factor below 0.5
+		if (_chunks.size() * 2 > _cellCapacity) {
+			buildCells();
+		}
+		else {
+			addToCells(_chunks.size() - 1);
+		}
+		return _chunks.size() - 1;
+	}
+
+	// ------------------------------------------------------
+	// add - the vertices are transformed once and kept on
+	// the CPU so that a chunk can be rebuilt
+	// ------------------------------------------------------
+	uint32_t StaticChunks::add(Mesh* mesh, const mat4& world) {
+		StaticMesh sm;
+		sm.index = _vertices.size();
+		sm.size = mesh->vertices.size();
+		for (uint32_t i = 0; i < sm.size; ++i) {
+			_vertices.push_back(mesh->vertices[i]);
+		}
+		PNTCVertex* v = _vertices.data() + sm.index;
+		vertex::transform(world, v, v, sm.size);
+		if (sm.size > 0) {
+			vertex::bounds(v, sm.size, &sm.min, &sm.max);
+		}
+		else {
+			sm.min = world * v3(0, 0, 0);
+			sm.max = sm.min;
+		}
+		sm.chunk = findChunk((sm.min + sm.max) * 0.5f);
+		StaticChunk& chunk = _chunks[sm.chunk];
+		sm.next = chunk.first;
+		sm.active = true;
+		sm.removed = false;
+		chunk.first = _meshes.size();
+		chunk.dirty = true;
+		_meshes.push_back(sm);
+		return _meshes.size() - 1;
+	}
+
+	// ------------------------------------------------------
+	// restore - the vertices are already transformed so the
+	// meshes only have to be sorted into the chunks again
+	// ------------------------------------------------------
+	void StaticChunks::restore(const StaticMesh* meshes, uint32_t numMeshes, const PNTCVertex* vertices, uint32_t numVertices) {
+		clear();
+		for (uint32_t i = 0; i < numVertices; ++i) {
+			_vertices.push_back(vertices[i]);
+		}
+		for (uint32_t i = 0; i < numMeshes; ++i) {
+			StaticMesh sm = meshes[i];
+			XASSERT(sm.index + sm.size <= numVertices, "Invalid static mesh %d", i);
+			if (sm.removed) {
+				_removedVertices += sm.size;
+			}
+			sm.chunk = findChunk((sm.min + sm.max) * 0.5f);
+			StaticChunk& chunk = _chunks[sm.chunk];
+			sm.next = chunk.first;
+			chunk.first = _meshes.size();
+			chunk.dirty = true;
+			_meshes.push_back(sm);
+		}
+	}
+
+	// ------------------------------------------------------
+	// remove - the vertices stay until upload compacts them
+	// ------------------------------------------------------
+	void StaticChunks::remove(uint32_t index) {
+		XASSERT(index < _meshes.size(), "Invalid static mesh index %d", index);
+		StaticMesh& sm = _meshes[index];
+		if (!sm.removed) {
+			sm.removed = true;
+			_removedVertices += sm.size;
+			_chunks[sm.chunk].dirty = true;
+		}
+	}
+
+	// ------------------------------------------------------
+	// compact - drops the vertices of all removed meshes.
+	// The static indices stay valid. Removed meshes keep an
+	// empty range.
+	// ------------------------------------------------------
+	void StaticChunks::compact() {
+		ZoneTracker z("StaticChunks::compact");
+		_scratch.clear();
+		for (uint32_t i = 0; i < _meshes.size(); ++i) {
+			StaticMesh& sm = _meshes[i];
+			uint32_t index = _scratch.size();
+			if (!sm.removed) {
+				for (uint32_t j = 0; j < sm.size; ++j) {
+					_scratch.push_back(_vertices[sm.index + j]);
+				}
+			}
+			else {
+				sm.size = 0;
+			}
+			sm.index = index;
+		}
+		_vertices.clear();
+		for (uint32_t i = 0; i < _scratch.size(); ++i) {
+			_vertices.push_back(_scratch[i]);
+		}
+		_removedVertices = 0;
+	}
+
+	void StaticChunks::setActive(uint32_t index, bool active) {
+		XASSERT(index < _meshes.size(), "Invalid static mesh index %d", index);
+		StaticMesh& sm = _meshes[index];
+		if (sm.active != active) {
+			sm.active = active;
+			_chunks[sm.chunk].dirty = true;
+		}
+	}
+
+	// ------------------------------------------------------
+	// rebuild - merges all visible meshes and uploads them.
+	// The buffer is only recreated if it is too small.
+	// ------------------------------------------------------
+	void StaticChunks::rebuild(StaticChunk& chunk) {
+		_scratch.clear();
+		chunk.numMeshes = 0;
+		int previous = -1;
+		int current = chunk.first;
+		while (current != -1) {
+			const StaticMesh& sm = _meshes[current];
+			// removed meshes never come back so they are unlinked
+			if (sm.removed) {
+				if (previous == -1) {
+					chunk.first = sm.next;
+				}
+				else {
+					_meshes[previous].next = sm.next;
+				}
+				current = sm.next;
+				continue;
+			}
+			if (sm.active) {
+				for (uint32_t i = 0; i < sm.size; ++i) {
+					_scratch.push_back(_vertices[sm.index + i]);
+				}
+				if (chunk.numMeshes == 0) {
+					chunk.min = sm.min;
+					chunk.max = sm.max;
+				}
+				else {
+					chunk.min = math::min_val(chunk.min, sm.min);
+					chunk.max = math::max_val(chunk.max, sm.max);
+				}
+				++chunk.numMeshes;
+			}
+			previous = current;
+			current = sm.next;
+		}
+		uint32_t num = _scratch.size();
+		uint32_t stride = vertex::vertexSize(_format);
+		if (num > chunk.capacity) {
+			graphics::releaseVertexBuffer(chunk.buffer);
+			chunk.capacity = num + num / 2;
+			chunk.buffer = graphics::createVertexBuffer(0, chunk.capacity * stride);
+		}
+		if (num > 0 && chunk.buffer != 0) {
+			if (_format == VF_PACKED) {
+				PackedVertex* packed = (PackedVertex*)ALLOC(num * sizeof(PackedVertex));
+				vertex::pack(_scratch.data(), packed, num);
+				graphics::updateVertexBuffer(chunk.buffer, packed, num * stride);
+				DEALLOC(packed);
+			}
+			else {
+				graphics::updateVertexBuffer(chunk.buffer, _scratch.data(), num * stride);
+			}
+		}
+		chunk.numVertices = chunk.buffer != 0 ? num : 0;
+		chunk.dirty = false;
+	}
+
+	// ------------------------------------------------------
+	// upload
+	// ------------------------------------------------------
+	void StaticChunks::upload() {
+		if (_removedVertices > STATIC_COMPACT_VERTICES && _removedVertices * 2 >= _vertices.size()) {
+			compact();
+		}
+		for (uint32_t i = 0; i < _chunks.size(); ++i) {
+			if (_chunks[i].dirty) {
+				ZoneTracker z("StaticChunks::rebuild");
+				rebuild(_chunks[i]);
+			}
+		}
+	}
+
+	// ------------------------------------------------------
+	// draw
+	// ------------------------------------------------------
+	void StaticChunks::draw(MeshBuffer* buffer, const culling::Frustum& frustum) {
+		ZoneTracker z("StaticChunks::draw");
+		// a different format means that all buffers have to be created again
+		VertexFormat format = buffer->getVertexFormat();
+		if (format != _format) {
+			for (uint32_t i = 0; i < _chunks.size(); ++i) {
+				StaticChunk& chunk = _chunks[i];
+				graphics::releaseVertexBuffer(chunk.buffer);
+				chunk.buffer = 0;
+				chunk.capacity = 0;
+				chunk.dirty = true;
+			}
+			_format = format;
+		}
+		upload();
+		for (uint32_t i = 0; i < _chunks.size(); ++i) {
+			const StaticChunk& chunk = _chunks[i];
+			if (chunk.numVertices > 0) {
+				if (culling::isVisible(frustum, (chunk.min + chunk.max) * 0.5f, (chunk.max - chunk.min) * 0.5f)) {
+					buffer->drawStatic(chunk.buffer, chunk.numVertices);
+					gDrawCounter->visibleMeshes += chunk.numMeshes;
+				}
+				else {
+					gDrawCounter->culledMeshes += chunk.numMeshes;
+				}
+			}
+		}
+	}
+
+}
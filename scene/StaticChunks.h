@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+#include <d3d11.h>
+#include "core\math\math_types.h"
+#include "core\math\matrix.h"
+#include "core\lib\collection_types.h"
+#include "..\renderer\VertexTypes.h"
+#include "..\renderer\Culling.h"
+
+namespace ds {
+
+	class MeshBuffer;
+	struct Mesh;
+
+	// edge length of the grid cells static meshes are sorted into
+	const float STATIC_CHUNK_SIZE = 32.0f;
+	// the vertices of removed meshes are compacted once there are more
+	// than this many and they are at least half of all vertices
+	const uint32_t STATIC_COMPACT_VERTICES = 16384;
+
+	struct StaticMesh {
+		uint32_t chunk;
+		// range in the pre-transformed vertices
+		uint32_t index;
+		uint32_t size;
+		v3 min;
+		v3 max;
+		// next mesh of the same chunk or -1
+		int next;
+		bool active;
+		bool removed;
+	};
+
+	// ------------------------------------------------------
+	// all static meshes of one grid cell merged into a single
+	// vertex buffer in video memory
+	// ------------------------------------------------------
+	struct StaticChunk {
+		int x;
+		int y;
+		int z;
+		v3 min;
+		v3 max;
+		int first;
+		uint32_t numMeshes;
+		uint32_t numVertices;
+		// capacity of the buffer in vertices
+		uint32_t capacity;
+		ID3D11Buffer* buffer;
+		bool dirty;
+	};
+
+	// ------------------------------------------------------
+	// Static geometry of a scene. Meshes are transformed once
+	// and sorted into grid cells. A chunk is only uploaded
+	// again when a mesh is added, removed or (de)activated.
+	// ------------------------------------------------------
+	class StaticChunks {
+
+	public:
+		StaticChunks() : _cells(0), _cellCapacity(0), _removedVertices(0), _format(VF_PNTC) {}
+		~StaticChunks();
+		// returns the static index of the mesh
+		uint32_t add(Mesh* mesh, const mat4& world);
+		// the index stays valid - the vertices are released by a later upload
+		void remove(uint32_t index);
+		void setActive(uint32_t index, bool active);
+		void clear();
+		// uploads all changed chunks
+		void upload();
+		// draws all chunks inside the frustum - the chunks use the vertex format of the buffer
+		void draw(MeshBuffer* buffer, const culling::Frustum& frustum);
+		uint32_t numChunks() const {
+			return _chunks.size();
+		}
+		uint32_t numMeshes() const {
+			return _meshes.size();
+		}
+		const StaticMesh* getMeshes() const {
+			return _meshes.data();
+		}
+		uint32_t numVertices() const {
+			return _vertices.size();
+		}
+		const PNTCVertex* getVertices() const {
+			return _vertices.data();
+		}
+		// replaces all meshes with already transformed data - the chunks are rebuilt
+		void restore(const StaticMesh* meshes, uint32_t numMeshes, const PNTCVertex* vertices, uint32_t numVertices);
+	private:
+		uint32_t findChunk(const v3& center);
+		void buildCells();
+		void addToCells(uint32_t chunkIndex);
+		void compact();
+		void rebuild(StaticChunk& chunk);
+		// not copyable - the cell index and the buffers are owned by the chunks
+		StaticChunks(const StaticChunks& other);
+		void operator=(const StaticChunks& other);
+
+		Array<PNTCVertex> _vertices;
+		Array<StaticMesh> _meshes;
+		Array<StaticChunk> _chunks;
+		Array<PNTCVertex> _scratch;
+		// open addressed hash of the grid cells - stores chunk index or -1
+		int* _cells;
+		uint32_t _cellCapacity;
+		// vertices of removed meshes that are still in _vertices
+		uint32_t _removedVertices;
+		// format of the vertex buffers
+		VertexFormat _format;
+	};
+
+}
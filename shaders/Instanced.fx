@@ -0,0 +1,75 @@
+cbuffer cbChangesPerFrame : register( b0 )
+{
+    matrix mvp_;
+    matrix world;
+    float3 camera;
+    float3 light;
+};
+
+
+Texture2D colorMap_ : register( t0 );
+SamplerState colorSampler_ : register( s0 );
+
+
+struct VS_Input
+{
+    float4 pos  : POSITION;
+    float3 normal : NORMAL;
+    float2 tex0 : TEXCOORD0;
+    float4 color : COLOR0;
+    // per instance - rows of the world matrix
+    float4 world0 : WORLD0;
+    float4 world1 : WORLD1;
+    float4 world2 : WORLD2;
+    float4 world3 : WORLD3;
+    float4 instanceColor : INSTANCECOLOR0;
+};
+
+struct PS_Input
+{
+    float4 pos  : SV_POSITION;
+    float2 tex0 : TEXCOORD0;
+    float4 color : COLOR0;
+    float3 normal : NORMAL;
+    float3 lightVec : TEXCOORD1;
+    float3 viewVec : TEXCOORD2;
+};
+
+
+PS_Input VS_Main( VS_Input vertex )
+{
+    PS_Input vsOut = ( PS_Input )0;
+    float4x4 instanceWorld = float4x4(vertex.world0, vertex.world1, vertex.world2, vertex.world3);
+    float4 worldPosition = mul(float4(vertex.pos.xyz, 1.0), instanceWorld);
+    // mvp_ only contains the view projection matrix
+    vsOut.pos = mul( worldPosition, mvp_ );
+    vsOut.tex0 = vertex.tex0;
+    vsOut.color = vertex.color * vertex.instanceColor;
+    vsOut.normal = normalize(mul(vertex.normal,(float3x3)instanceWorld));
+    vsOut.lightVec = normalize(light);
+    vsOut.viewVec = normalize(camera - worldPosition.xyz);
+    return vsOut;
+}
+
+
+float4 PS_Main( PS_Input frag ) : SV_TARGET
+{
+    float4 ambientColor = float4(0.2,0.2,0.2,1.0);
+    float4 textureColor =  colorMap_.Sample( colorSampler_, frag.tex0 ) * frag.color;
+    float4 dc = float4(1,1,1,1);
+    float4 color = float4(0,0,0,0);
+    float3 n = normalize(frag.normal);
+    float3 ln = normalize(frag.lightVec);
+    float lightIntensity = saturate(dot(n,ln));
+    if ( lightIntensity > 0.0f ) {
+         color += (dc * lightIntensity);
+         color.a = frag.color.a;
+    }
+    else {
+        color = ambientColor;
+    }
+    color = color * textureColor;
+    color = saturate(color);
+    return color;
+
+}
@@ -0,0 +1,57 @@
+cbuffer cbChangesPerFrame : register( b0 )
+{
+    matrix mvp_;
+    matrix world;
+    float3 camera;
+    float3 light;
+};
+
+
+Texture2D colorMap_ : register( t0 );
+SamplerState colorSampler_ : register( s0 );
+
+// PackedVertex - the input layout needs
+// HALFPOSITION,OCTNORMAL,UNORMTEXCOORD,UNORMCOLOR
+// and the hardware already converts everything to float
+struct VS_Input
+{
+    float4 pos  : HALFPOSITION;
+    float2 normal : OCTNORMAL;
+    float2 tex0 : UNORMTEXCOORD;
+    float4 color : UNORMCOLOR;
+};
+
+struct PS_Input
+{
+    float4 pos  : SV_POSITION;
+    float2 tex0 : TEXCOORD0;
+    float4 color : COLOR0;
+    float3 normal : NORMAL;
+    float3 lightVec : TEXCOORD1;
+    float3 viewVec : TEXCOORD2;
+};
+
+float3 octDecode(float2 e) {
+    float3 n = float3(e.x, e.y, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
+PS_Input VS_Main( VS_Input vertex ) {
+    PS_Input vsOut = ( PS_Input )0;
+    vsOut.pos = mul( vertex.pos, mvp_ );
+    vsOut.tex0 = vertex.tex0;
+    vsOut.color = vertex.color;
+    vsOut.normal = mul(octDecode(vertex.normal),(float3x3)world);
+    vsOut.normal = normalize(vsOut.normal);
+    float3 worldPosition = mul(vertex.pos,(float3x3)world);
+    vsOut.lightVec = normalize(light);
+    vsOut.viewVec = normalize(camera - worldPosition);
+    return vsOut;
+}
+
+
+float4 PS_Main( PS_Input frag ) : SV_TARGET {
+    return colorMap_.Sample( colorSampler_, frag.tex0 ) * frag.color;    
+}
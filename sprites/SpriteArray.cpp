@@ -8,8 +8,7 @@
 namespace ds {
 
 	bool SpriteArray::verifySID(SID sid) {
-		SpriteArrayIndex &in = indices[sid];
-		if (in.index != USHRT_MAX) {
+		if (contains(sid)) {
 			return true;
 		}
 		LOG << "SID: " << sid << " is NOT valid - no valid index found";
@@ -17,24 +16,27 @@ namespace ds {
 	}
 
 	void SpriteArray::assertSID(SID sid) const {		
-		XASSERT(sid < capacity, "ID %d out of range %d", sid, capacity);
-		SpriteArrayIndex &in = indices[sid];
-		XASSERT(in.index != UINT16_MAX, "Invalid index for %d", sid);
+		XASSERT(handle::index(sid) < capacity, "ID %d out of range %d", sid, capacity);
+		const SpriteArrayIndex &in = indices[handle::index(sid)];
+		XASSERT(in.id == sid, "Stale SID %d - slot is used by %d", sid, in.id);
+		XASSERT(in.index != handle::INVALID_INDEX, "Invalid index for %d", sid);
 	}
 
 	SID SpriteArray::create(const v2& pos, const Texture& r, float rotation, float scaleX, float scaleY, const Color& color, int type, int layer) {
 		if (num + 1 > capacity) {
-			allocate(capacity * 2 + 8);
+			uint32_t size = capacity * 2 + 8;
+			allocate(size < handle::MAX_INDEX ? size : handle::MAX_INDEX);
+			XASSERT(num < capacity, "SpriteArray is full - max %d sprites", handle::MAX_INDEX);
 		}
-		ID id = 0;
+		ID slot = 0;
 		if (freeList.empty()) {
-			id = current++;
+			slot = current++;
 		}
 		else {
-			id = freeList.back();
+			slot = freeList.back();
 			freeList.pop_back();
 		}
-		SpriteArrayIndex &in = indices[id];
+		SpriteArrayIndex &in = indices[slot];
 		in.index = num++;
 		ids[in.index] = in.id;
 		positions[in.index] = pos;
@@ -52,38 +54,38 @@ namespace ds {
 	}
 
 	void SpriteArray::remove(SID id) {
-		SpriteArrayIndex& in = indices[id];
-		XASSERT(in.index != UINT16_MAX,"Remove : Invalid index for %d",id);
-		XASSERT(id < capacity,"Remove : ID %d out of range %d",id,capacity);
-		if (num > 1) {
-			ID lastID = ids[num-1];
-			SpriteArrayIndex& lastIn = indices[lastID];
-			if (lastID != in.index) {
-				ids[in.index] = ids[lastIn.index];
-				positions[in.index] = positions[lastIn.index];
-				scales[in.index] = scales[lastIn.index];
-				rotations[in.index] = rotations[lastIn.index];
-				textures[in.index] = textures[lastIn.index];
-				colors[in.index] = colors[lastIn.index];
-				timers[in.index] = timers[lastIn.index];
-				types[in.index] = types[lastIn.index];
-				layers[in.index] = layers[lastIn.index];
-				previous[in.index] = previous[lastIn.index];
-				extents[in.index] = extents[lastIn.index];
-				shapeTypes[in.index] = shapeTypes[lastIn.index];
-				lastIn.index = in.index;
-			}			
+		assertSID(id);
+		uint32_t slot = handle::index(id);
+		SpriteArrayIndex& in = indices[slot];
+		uint32_t last = num - 1;
+		if (in.index != last) {
+			SpriteArrayIndex& lastIn = indices[handle::index(ids[last])];
+			ids[in.index] = ids[last];
+			positions[in.index] = positions[last];
+			scales[in.index] = scales[last];
+			rotations[in.index] = rotations[last];
+			textures[in.index] = textures[last];
+			colors[in.index] = colors[last];
+			timers[in.index] = timers[last];
+			types[in.index] = types[last];
+			layers[in.index] = layers[last];
+			previous[in.index] = previous[last];
+			extents[in.index] = extents[last];
+			shapeTypes[in.index] = shapeTypes[last];
+			lastIn.index = in.index;
 		}
 		--num;
-		in.index = UINT16_MAX;
-		freeList.push_back(id);
+		in.index = handle::INVALID_INDEX;
+		// invalidate all existing SIDs of this slot
+		in.id = handle::next(in.id);
+		freeList.push_back(slot);
 	}
 
-	void SpriteArray::allocate(uint16_t size) {
+	void SpriteArray::allocate(uint32_t size) {
 		if (size > capacity) {
-			int sz = size * (sizeof(SpriteArrayIndex) + sizeof(SID) + sizeof(v2) + sizeof(v2) + sizeof(float) + sizeof(Texture) + sizeof(Color) + sizeof(float) + sizeof(uint16_t) + sizeof(uint16_t) + 2 * sizeof(v2) + sizeof(SpriteShapeType));
+			XASSERT(size <= handle::MAX_INDEX, "SpriteArray size %d exceeds max %d", size, handle::MAX_INDEX);
+			size_t sz = size * (sizeof(SpriteArrayIndex) + sizeof(SID) + sizeof(v2) + sizeof(v2) + sizeof(float) + sizeof(Texture) + sizeof(Color) + sizeof(float) + sizeof(uint16_t) + sizeof(uint16_t) + 2 * sizeof(v2) + sizeof(SpriteShapeType));
 			char* b = (char*)ALLOC(sz);
-			capacity = size;
 			indices = (SpriteArrayIndex*)b;
 			ids = (SID*)(indices + size);
 			positions = (v2*)(ids + size);
@@ -98,37 +100,39 @@ namespace ds {
 			extents = (v2*)(previous + size);
 			shapeTypes = (SpriteShapeType*)(extents + size);
 			if (buffer != 0) {
-				memcpy(indices, buffer, num * sizeof(SpriteArrayIndex));
-				int index = num * sizeof(SpriteArrayIndex);
+				// all slots must be kept since removed slots keep their generation
+				memcpy(indices, buffer, capacity * sizeof(SpriteArrayIndex));
+				size_t index = capacity * sizeof(SpriteArrayIndex);
 				memcpy(ids, buffer + index, num * sizeof(SID));
-				index += num * sizeof(SID);
+				index += capacity * sizeof(SID);
 				memcpy(positions, buffer + index, num * sizeof(v2));
-				index += num * sizeof(v2);
+				index += capacity * sizeof(v2);
 				memcpy(scales, buffer + index, num * sizeof(v2));
-				index += num * sizeof(v2);
+				index += capacity * sizeof(v2);
 				memcpy(rotations, buffer + index, num * sizeof(float));
-				index += num * sizeof(float);
+				index += capacity * sizeof(float);
 				memcpy(textures, buffer + index, num * sizeof(Texture));
-				index += num * sizeof(Texture);
+				index += capacity * sizeof(Texture);
 				memcpy(colors, buffer + index, num * sizeof(Color));
-				index += num * sizeof(Color);
+				index += capacity * sizeof(Color);
 				memcpy(timers, buffer + index, num * sizeof(float));
-				index += num * sizeof(float);
+				index += capacity * sizeof(float);
 				memcpy(types, buffer + index, num * sizeof(uint16_t));
-				index += num * sizeof(uint16_t);
+				index += capacity * sizeof(uint16_t);
 				memcpy(layers, buffer + index, num * sizeof(uint16_t));
-				index += num * sizeof(uint16_t);
+				index += capacity * sizeof(uint16_t);
 				memcpy(previous, buffer + index, num * sizeof(v2));
-				index += num * sizeof(v2);
+				index += capacity * sizeof(v2);
 				memcpy(extents, buffer + index, num * sizeof(v2));
-				index += num * sizeof(v2);
+				index += capacity * sizeof(v2);
 				memcpy(shapeTypes, buffer + index, num * sizeof(SpriteShapeType));
-				for (int i = num; i < capacity; ++i) {
-					indices[i].id = i;
-					indices[i].index = UINT16_MAX;
-				}
 				DEALLOC(buffer);
 			}
+			for (uint32_t i = capacity; i < size; ++i) {
+				indices[i].id = handle::make(i, 0);
+				indices[i].index = handle::INVALID_INDEX;
+			}
+			capacity = size;
 			buffer = b;
 		}
 	}
@@ -140,7 +144,7 @@ namespace ds {
 	}
 
 	void SpriteArray::debug(SID sid) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		LOG << "id      : " << sid;
 		LOG << "index   : " << in.index;
@@ -156,43 +160,43 @@ namespace ds {
 	}
 	
 	void SpriteArray::setPosition(SID sid, const v2& pos) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		positions[in.index] = pos;
 	}
 
 	const v2& SpriteArray::getPosition(SID sid) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		return positions[in.index];
 	}
 
 	void SpriteArray::setScale(SID sid, float sx, float sy) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		scales[in.index] = v2(sx,sy);
 	}
 
 	void SpriteArray::scale(SID sid, const v2& scale) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		scales[in.index] = scale;
 	}
 
 	void SpriteArray::setColor(SID sid, const Color& clr) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		colors[in.index] = clr;
 	}
 
 	void SpriteArray::setAlpha(SID sid, float alpha) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		colors[in.index].a = alpha;
 	}
 
 	void SpriteArray::rotate(SID sid, float angle) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		if ( angle > TWO_PI ) {
 			angle -= TWO_PI;
@@ -201,13 +205,13 @@ namespace ds {
 	}
 
 	float SpriteArray::getRotation(SID sid) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		return rotations[in.index];
 	}
 
 	bool SpriteArray::get(SID sid,Sprite* ret) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		ret->id = sid;
 		ret->position = positions[in.index];
@@ -221,7 +225,7 @@ namespace ds {
 	}
 
 	void SpriteArray::set(SID sid, const Sprite& sprite) {
-		SpriteArrayIndex &in = indices[sid];
+		SpriteArrayIndex &in = indices[handle::index(sid)];
 		assertSID(sid);
 		ids[in.index] = sid;
 		positions[in.index] = sprite.position;
@@ -5,19 +5,27 @@
 #include "Sprite.h"
 #include "core\lib\collection_types.h"
 #include "core\graphics\Texture.h"
+#include "..\utils\Handle.h"
 #include <stdint.h>
 
 namespace ds {
 
+	// ------------------------------------------------------
+	// maps a slot to the current handle and the data index
+	// ------------------------------------------------------
 	struct SpriteArrayIndex {
 		SID id;
-		uint16_t index;
+		uint32_t index;
 	};
 
+	// ------------------------------------------------------
+	// SoA sprite storage. SIDs are generational handles so
+	// that a SID of a removed sprite never aliases a new one.
+	// ------------------------------------------------------
 	struct SpriteArray {
 
-		uint16_t num;
-		uint16_t capacity;
+		uint32_t num;
+		uint32_t capacity;
 		SpriteArrayIndex* indices;
 		SID* ids;
 		v2* positions;
@@ -44,9 +52,9 @@ namespace ds {
 
 		void clear() {
 			if (buffer != 0) {
-				for (unsigned short i = 0; i < capacity; ++i) {
-					indices[i].id = i;
-					indices[i].index = UINT16_MAX;
+				for (uint32_t i = 0; i < capacity; ++i) {
+					indices[i].id = handle::make(i, handle::generation(indices[i].id) + 1);
+					indices[i].index = handle::INVALID_INDEX;
 				}
 				num = 0;
 				current = 0;
@@ -59,48 +67,53 @@ namespace ds {
 		void assertSID(SID sid) const;
 
 		const int getType(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
-			assert(in.index != USHRT_MAX);
+			SpriteArrayIndex &in = indices[handle::index(sid)];
+			assertSID(sid);
 			return types[in.index];
 		}
 
 		void setType(SID sid,int type) {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			types[in.index] = type;
 		}
 
+		// O(1) check - false for removed and stale SIDs
 		const bool contains(SID sid) const {
-			SpriteArrayIndex& in = indices[sid];
-			return in.index != USHRT_MAX;
+			uint32_t slot = handle::index(sid);
+			if (slot >= capacity) {
+				return false;
+			}
+			const SpriteArrayIndex& in = indices[slot];
+			return in.id == sid && in.index != handle::INVALID_INDEX;
 		}
 
 		const int getIndex(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			return in.index;
 		}
 
 		const v2& getPosition(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			return positions[in.index];
 		}
 
 		const v2& getScale(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			return scales[in.index];
 		}
 
 		const float getRotation(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			return rotations[in.index];
 		}
 
 		const Texture& getTexture(SID sid) const {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			return textures[in.index];
 		}
@@ -108,7 +121,7 @@ namespace ds {
 		SID create(const v2& pos, const Texture& r, float rotation = 0.0f, float scaleX = 1.0f, float scaleY = 1.0f, const Color& color = Color::WHITE, int type = -1, int layer = 0);
 
 		void attachCollider(SID sid, const v2& extent, SpriteShapeType shape = SST_CIRCLE) {
-			SpriteArrayIndex &in = indices[sid];
+			SpriteArrayIndex &in = indices[handle::index(sid)];
 			assertSID(sid);
 			shapeTypes[in.index] = shape;
 			extents[in.index] = extent;
@@ -121,7 +134,7 @@ namespace ds {
 
 		void remove(SID id);
 
-		void allocate(uint16_t size);
+		void allocate(uint32_t size);
 
 		void debug();
 
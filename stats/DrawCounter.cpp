@@ -11,6 +11,10 @@ namespace ds {
 		sprites = 0;
 		spriteFlushes = 0;
 		squares = 0;
+		visibleSprites = 0;
+		culledSprites = 0;
+		visibleMeshes = 0;
+		culledMeshes = 0;
 	}
 
 	void DrawCounter::save(const ReportWriter& writer) {
@@ -37,6 +41,22 @@ namespace ds {
 		writer.addCell("Squares");
 		writer.addCell(squares);
 		writer.endRow();
+		writer.startRow();
+		writer.addCell("Visible sprites");
+		writer.addCell(visibleSprites);
+		writer.endRow();
+		writer.startRow();
+		writer.addCell("Culled sprites");
+		writer.addCell(culledSprites);
+		writer.endRow();
+		writer.startRow();
+		writer.addCell("Visible meshes");
+		writer.addCell(visibleMeshes);
+		writer.endRow();
+		writer.startRow();
+		writer.addCell("Culled meshes");
+		writer.addCell(culledMeshes);
+		writer.endRow();
 		writer.endTable();
 		writer.endBox();
 	}
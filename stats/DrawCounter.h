@@ -12,6 +12,10 @@ namespace ds {
 		uint32_t sprites;
 		uint32_t spriteFlushes;
 		uint32_t squares;
+		uint32_t visibleSprites;
+		uint32_t culledSprites;
+		uint32_t visibleMeshes;
+		uint32_t culledMeshes;
 
 		void reset();
 
@@ -0,0 +1,411 @@
+// ---------------------------------------------------------------------------
+// AtlasBuilder
+//
+// Offline tool that packs all images of a folder into one texture atlas.
+// It writes the atlas as PNG and a SpriteSheet compatible JSON file. With
+// -font the JSON contains a Bitmapfont "characters" block instead and the
+// images must be named by their character code (65.png = 'A').
+//
+// The tool has no dependencies besides the bundled stb_image.h:
+//
+//   make -C tools
+//   g++ -O2 -std=c++11 -o atlas tools/AtlasBuilder.cpp
+//   cl /O2 /EHsc tools\AtlasBuilder.cpp /Fe:atlas.exe
+//
+// Usage: atlas <input dir> <output name> [-size 1024] [-padding 1] [-font]
+// ---------------------------------------------------------------------------
+#define STB_IMAGE_IMPLEMENTATION
+#include "../renderer/stb_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace atlas {
+
+	struct Image {
+		std::string name;
+		int width;
+		int height;
+		unsigned char* pixels;
+		int x;
+		int y;
+		bool placed;
+	};
+
+	struct PackRect {
+		int x;
+		int y;
+		int width;
+		int height;
+
+		PackRect() : x(0), y(0), width(0), height(0) {}
+		PackRect(int xp, int yp, int w, int h) : x(xp), y(yp), width(w), height(h) {}
+
+		bool contains(const PackRect& other) const {
+			return other.x >= x && other.y >= y && other.x + other.width <= x + width && other.y + other.height <= y + height;
+		}
+
+		bool intersects(const PackRect& other) const {
+			return !(other.x >= x + width || other.x + other.width <= x || other.y >= y + height || other.y + other.height <= y);
+		}
+	};
+
+	// -------------------------------------------------------
+	// MaxRects packer using the best short side fit heuristic
+	// -------------------------------------------------------
+	class MaxRectsPacker {
+
+	public:
+		MaxRectsPacker(int width, int height) {
+			_free.push_back(PackRect(0, 0, width, height));
+		}
+
+		bool insert(int width, int height, PackRect* ret) {
+			int bestShort = INT32_MAX;
+			int bestLong = INT32_MAX;
+			int best = -1;
+			for (size_t i = 0; i < _free.size(); ++i) {
+				const PackRect& f = _free[i];
+				if (f.width >= width && f.height >= height) {
+					int dx = f.width - width;
+					int dy = f.height - height;
+					int s = std::min(dx, dy);
+					int l = std::max(dx, dy);
+					if (s < bestShort || (s == bestShort && l < bestLong)) {
+						bestShort = s;
+						bestLong = l;
+						best = i;
+					}
+				}
+			}
+			if (best == -1) {
+				return false;
+			}
+			*ret = PackRect(_free[best].x, _free[best].y, width, height);
+			place(*ret);
+			return true;
+		}
+
+	private:
+		void place(const PackRect& used) {
+			std::vector<PackRect> next;
+			for (size_t i = 0; i < _free.size(); ++i) {
+				const PackRect& f = _free[i];
+				if (!f.intersects(used)) {
+					next.push_back(f);
+					continue;
+				}
+				// split the free rect into up to four maximal rects
+				if (used.x > f.x) {
+					next.push_back(PackRect(f.x, f.y, used.x - f.x, f.height));
+				}
+				if (used.x + used.width < f.x + f.width) {
+					next.push_back(PackRect(used.x + used.width, f.y, f.x + f.width - used.x - used.width, f.height));
+				}
+				if (used.y > f.y) {
+					next.push_back(PackRect(f.x, f.y, f.width, used.y - f.y));
+				}
+				if (used.y + used.height < f.y + f.height) {
+					next.push_back(PackRect(f.x, used.y + used.height, f.width, f.y + f.height - used.y - used.height));
+				}
+			}
+			// remove all free rects that are contained in another one
+			_free.clear();
+			for (size_t i = 0; i < next.size(); ++i) {
+				bool contained = false;
+				for (size_t j = 0; j < next.size() && !contained; ++j) {
+					if (i != j && next[j].contains(next[i])) {
+						// keep the first one of two identical rects
+						contained = !(next[i].contains(next[j]) && i < j);
+					}
+				}
+				if (!contained) {
+					_free.push_back(next[i]);
+				}
+			}
+		}
+
+		std::vector<PackRect> _free;
+	};
+
+	// -------------------------------------------------------
+	// minimal PNG writer using uncompressed deflate blocks
+	// -------------------------------------------------------
+	static uint32_t crcTable[256];
+
+	static void buildCRCTable() {
+		for (uint32_t n = 0; n < 256; ++n) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			crcTable[n] = c;
+		}
+	}
+
+	static uint32_t crc(uint32_t c, const unsigned char* data, size_t len) {
+		for (size_t i = 0; i < len; ++i) {
+			c = crcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+		}
+		return c;
+	}
+
+	static void putU32(std::vector<unsigned char>& out, uint32_t v) {
+		out.push_back((v >> 24) & 0xFF);
+		out.push_back((v >> 16) & 0xFF);
+		out.push_back((v >> 8) & 0xFF);
+		out.push_back(v & 0xFF);
+	}
+
+	static void writeChunk(FILE* f, const char* type, const std::vector<unsigned char>& data) {
+		std::vector<unsigned char> buffer;
+		putU32(buffer, data.size());
+		buffer.insert(buffer.end(), type, type + 4);
+		buffer.insert(buffer.end(), data.begin(), data.end());
+		uint32_t c = crc(0xFFFFFFFFu, &buffer[4], buffer.size() - 4) ^ 0xFFFFFFFFu;
+		putU32(buffer, c);
+		fwrite(&buffer[0], 1, buffer.size(), f);
+	}
+
+	static bool writePNG(const char* fileName, const unsigned char* rgba, int width, int height) {
+		FILE* f = fopen(fileName, "wb");
+		if (!f) {
+			return false;
+		}
+		buildCRCTable();
+		const unsigned char signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+		fwrite(signature, 1, 8, f);
+		std::vector<unsigned char> header;
+		putU32(header, width);
+		putU32(header, height);
+		header.push_back(8);  // bit depth
+		header.push_back(6);  // RGBA
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+		writeChunk(f, "IHDR", header);
+		// raw scanlines with filter type 0
+		std::vector<unsigned char> raw;
+		size_t stride = width * 4;
+		raw.reserve((stride + 1) * height);
+		for (int y = 0; y < height; ++y) {
+			raw.push_back(0);
+			raw.insert(raw.end(), rgba + y * stride, rgba + (y + 1) * stride);
+		}
+		std::vector<unsigned char> z;
+		z.push_back(0x78);
+		z.push_back(0x01);
+		size_t pos = 0;
+		do {
+			size_t len = std::min(raw.size() - pos, (size_t)65535);
+			z.push_back(pos + len == raw.size() ? 1 : 0);
+			z.push_back(len & 0xFF);
+			z.push_back((len >> 8) & 0xFF);
+			z.push_back(~len & 0xFF);
+			z.push_back((~len >> 8) & 0xFF);
+			z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+			pos += len;
+		} while (pos < raw.size());
+		uint32_t a = 1;
+		uint32_t b = 0;
+		for (size_t i = 0; i < raw.size(); ++i) {
+			a = (a + raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		putU32(z, (b << 16) | a);
+		writeChunk(f, "IDAT", z);
+		writeChunk(f, "IEND", std::vector<unsigned char>());
+		fclose(f);
+		return true;
+	}
+
+	// -------------------------------------------------------
+	// list all png/tga/bmp files of a directory
+	// -------------------------------------------------------
+	static bool isImage(const std::string& name) {
+		size_t p = name.find_last_of('.');
+		if (p == std::string::npos) {
+			return false;
+		}
+		std::string ext = name.substr(p + 1);
+		std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+		return ext == "png" || ext == "tga" || ext == "bmp" || ext == "jpg";
+	}
+
+	static void listFiles(const char* dir, std::vector<std::string>& files) {
+#ifdef _WIN32
+		char pattern[MAX_PATH];
+		sprintf_s(pattern, MAX_PATH, "%s\\*", dir);
+		WIN32_FIND_DATAA data;
+		HANDLE h = FindFirstFileA(pattern, &data);
+		if (h != INVALID_HANDLE_VALUE) {
+			do {
+				if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isImage(data.cFileName)) {
+					files.push_back(data.cFileName);
+				}
+			} while (FindNextFileA(h, &data));
+			FindClose(h);
+		}
+#else
+		DIR* d = opendir(dir);
+		if (d != 0) {
+			struct dirent* e;
+			while ((e = readdir(d)) != 0) {
+				if (e->d_name[0] != '.' && isImage(e->d_name)) {
+					files.push_back(e->d_name);
+				}
+			}
+			closedir(d);
+		}
+#endif
+		std::sort(files.begin(), files.end());
+	}
+
+	static std::string baseName(const std::string& file) {
+		size_t p = file.find_last_of('.');
+		return file.substr(0, p);
+	}
+
+	// -------------------------------------------------------
+	// write SpriteSheet or Bitmapfont definition
+	// -------------------------------------------------------
+	static bool writeJSON(const char* fileName, const std::vector<Image>& images, int padding, int size, bool font) {
+		FILE* f = fopen(fileName, "w");
+		if (!f) {
+			return false;
+		}
+		if (font) {
+			fprintf(f, "settings {\n    texture_size : %d\n}\n", size);
+			fprintf(f, "characters {\n");
+			for (size_t i = 0; i < images.size(); ++i) {
+				const Image& img = images[i];
+				fprintf(f, "    C%d : %d,%d,%d,%d\n", atoi(img.name.c_str()), img.y + padding, img.x + padding, img.width, img.height);
+			}
+			fprintf(f, "}\n");
+		}
+		else {
+			for (size_t i = 0; i < images.size(); ++i) {
+				const Image& img = images[i];
+				fprintf(f, "sprite {\n");
+				fprintf(f, "    name : \"%s\"\n", img.name.c_str());
+				fprintf(f, "    rect : %d,%d,%d,%d\n", img.y + padding, img.x + padding, img.width, img.height);
+				fprintf(f, "}\n");
+			}
+		}
+		fclose(f);
+		return true;
+	}
+
+	static bool sortBySize(const Image* a, const Image* b) {
+		int ma = std::max(a->width, a->height);
+		int mb = std::max(b->width, b->height);
+		if (ma != mb) {
+			return ma > mb;
+		}
+		return a->width * a->height > b->width * b->height;
+	}
+
+	int build(const char* inputDir, const char* output, int size, int padding, bool font) {
+		std::vector<std::string> files;
+		listFiles(inputDir, files);
+		if (files.empty()) {
+			printf("No images found in '%s'\n", inputDir);
+			return 1;
+		}
+		std::vector<Image> images;
+		for (size_t i = 0; i < files.size(); ++i) {
+			std::string path = std::string(inputDir) + "/" + files[i];
+			Image img;
+			int n = 0;
+			img.pixels = stbi_load(path.c_str(), &img.width, &img.height, &n, 4);
+			if (img.pixels == 0) {
+				printf("Cannot load '%s' : %s\n", path.c_str(), stbi_failure_reason());
+				continue;
+			}
+			img.name = baseName(files[i]);
+			img.x = 0;
+			img.y = 0;
+			img.placed = false;
+			images.push_back(img);
+		}
+		std::vector<Image*> order;
+		for (size_t i = 0; i < images.size(); ++i) {
+			order.push_back(&images[i]);
+		}
+		std::sort(order.begin(), order.end(), sortBySize);
+		MaxRectsPacker packer(size, size);
+		int failed = 0;
+		int used = 0;
+		for (size_t i = 0; i < order.size(); ++i) {
+			Image* img = order[i];
+			PackRect r;
+			if (packer.insert(img->width + 2 * padding, img->height + 2 * padding, &r)) {
+				img->x = r.x;
+				img->y = r.y;
+				img->placed = true;
+				used += r.width * r.height;
+			}
+			else {
+				printf("No space left for '%s' (%dx%d)\n", img->name.c_str(), img->width, img->height);
+				++failed;
+			}
+		}
+		std::vector<unsigned char> atlas(size * size * 4, 0);
+		std::vector<Image> placed;
+		for (size_t i = 0; i < images.size(); ++i) {
+			const Image& img = images[i];
+			if (img.placed) {
+				for (int y = 0; y < img.height; ++y) {
+					unsigned char* dest = &atlas[((img.y + padding + y) * size + img.x + padding) * 4];
+					memcpy(dest, img.pixels + y * img.width * 4, img.width * 4);
+				}
+				placed.push_back(img);
+			}
+			stbi_image_free(images[i].pixels);
+		}
+		std::string pngName = std::string(output) + ".png";
+		std::string jsonName = std::string(output) + ".json";
+		if (!writePNG(pngName.c_str(), &atlas[0], size, size)) {
+			printf("Cannot write '%s'\n", pngName.c_str());
+			return 1;
+		}
+		if (!writeJSON(jsonName.c_str(), placed, padding, size, font)) {
+			printf("Cannot write '%s'\n", jsonName.c_str());
+			return 1;
+		}
+		printf("Packed %d of %d images into %dx%d - usage %.1f%%\n", (int)placed.size(), (int)images.size(), size, size, 100.0f * used / (size * size));
+		return failed > 0 ? 2 : 0;
+	}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: atlas <input dir> <output name> [-size 1024] [-padding 1] [-font]\n");
+		return 1;
+	}
+	int size = 1024;
+	int padding = 1;
+	bool font = false;
+	for (int i = 3; i < argc; ++i) {
+		if (strcmp(argv[i], "-size") == 0 && i + 1 < argc) {
+			size = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-padding") == 0 && i + 1 < argc) {
+			padding = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-font") == 0) {
+			font = true;
+		}
+	}
+	return atlas::build(argv[1], argv[2], size, padding, font);
+}
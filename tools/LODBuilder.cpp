@@ -0,0 +1,254 @@
+// ---------------------------------------------------------------------------
+// LODBuilder
+//
+// Offline tool that builds the LOD levels of a .mesh file with the quadric
+// error simplifier and shows which level is selected at which distance. It
+// reports triangles, quad vertices and the error of every level. Without a
+// file a noisy terrain grid is used.
+//
+// The tool only depends on renderer/MeshSimplifier.cpp and
+// renderer/VertexCache.cpp:
+//
+//   make -C tools
+//   g++ -O2 -std=c++11 -o lodbuilder tools/LODBuilder.cpp renderer/MeshSimplifier.cpp renderer/VertexCache.cpp
+//   cl /O2 /EHsc tools\LODBuilder.cpp renderer\MeshSimplifier.cpp renderer\VertexCache.cpp /Fe:lodbuilder.exe
+//
+// Usage: lodbuilder [<file.mesh>] [-grid 128] [-flat] [-levels 4] [-ratio 0.5]
+//                   [-fov 60] [-height 1080] [-pixels 1]
+// ---------------------------------------------------------------------------
+#include "../renderer/MeshSimplifier.h"
+#include "../renderer/VertexCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+namespace lodbuilder {
+
+	// same layout as PNTCVertex
+	struct Vertex {
+		float position[3];
+		float normal[3];
+		float uv[2];
+		float color[4];
+	};
+
+	// must match MESH_FILE_MAGIC in renderer/MeshBuffer.h
+	const uint32_t MESH_FILE_MAGIC = 0x484D5344;
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numVertices;
+		uint32_t flags;
+		float min[3];
+		float max[3];
+	};
+
+	const uint32_t MAX_LEVELS = 4;
+
+	static bool load(const char* fileName, std::vector<Vertex>& vertices) {
+		FILE* f = fopen(fileName, "rb");
+		if (f == 0) {
+			printf("Cannot open '%s'\n", fileName);
+			return false;
+		}
+		MeshFileHeader header;
+		uint32_t num = 0;
+		if (fread(&header, sizeof(MeshFileHeader), 1, f) == 1 && header.magic == MESH_FILE_MAGIC) {
+			num = header.numVertices;
+		}
+		else {
+			fseek(f, 0, SEEK_SET);
+			if (fread(&num, sizeof(uint32_t), 1, f) != 1) {
+				num = 0;
+			}
+		}
+		vertices.resize(num);
+		uint32_t read = num > 0 ? (uint32_t)fread(&vertices[0], sizeof(Vertex), num, f) : 0;
+		fclose(f);
+		if (read != num) {
+			printf("'%s' is truncated - expected %u vertices but found %u\n", fileName, num, read);
+			return false;
+		}
+		return true;
+	}
+
+	static float height(float x, float z) {
+		return 2.0f * sinf(x * 0.11f) * cosf(z * 0.07f) + 0.3f * sinf(x * 0.9f + z * 0.5f);
+	}
+
+	// ------------------------------------------------------
+	// terrain made of quads - flat gives every quad its own
+	// vertices and face normal like the mesh generator
+	// ------------------------------------------------------
+	static void buildGrid(uint32_t size, bool flat, std::vector<Vertex>& vertices) {
+		const float px[] = { 0.0f, 1.0f, 1.0f, 0.0f };
+		const float pz[] = { 1.0f, 1.0f, 0.0f, 0.0f };
+		for (uint32_t z = 0; z < size; ++z) {
+			for (uint32_t x = 0; x < size; ++x) {
+				Vertex q[4];
+				for (int k = 0; k < 4; ++k) {
+					Vertex& v = q[k];
+					float vx = x + px[k];
+					float vz = z + pz[k];
+					v.position[0] = vx;
+					v.position[1] = height(vx, vz);
+					v.position[2] = vz;
+					// smooth normal from the height field
+					float nx = height(vx - 0.5f, vz) - height(vx + 0.5f, vz);
+					float nz = height(vx, vz - 0.5f) - height(vx, vz + 0.5f);
+					float l = sqrtf(nx * nx + 1.0f + nz * nz);
+					v.normal[0] = nx / l;
+					v.normal[1] = 1.0f / l;
+					v.normal[2] = nz / l;
+					v.uv[0] = flat ? px[k] : vx / size;
+					v.uv[1] = flat ? pz[k] : vz / size;
+					for (int c = 0; c < 4; ++c) {
+						v.color[c] = 1.0f;
+					}
+				}
+				if (flat) {
+					float e1[3], e2[3], n[3];
+					for (int c = 0; c < 3; ++c) {
+						e1[c] = q[1].position[c] - q[0].position[c];
+						e2[c] = q[3].position[c] - q[0].position[c];
+					}
+					n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+					n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+					n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+					float l = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+					for (int k = 0; k < 4; ++k) {
+						for (int c = 0; c < 3; ++c) {
+							q[k].normal[c] = n[c] / l;
+						}
+					}
+				}
+				for (int k = 0; k < 4; ++k) {
+					vertices.push_back(q[k]);
+				}
+			}
+		}
+	}
+
+	// quads are drawn as (0, 1, 3) and (1, 2, 3)
+	static void buildQuadIndices(const std::vector<uint32_t>& remap, std::vector<uint32_t>& indices) {
+		for (size_t i = 0; i + 3 < remap.size(); i += 4) {
+			const uint32_t tris[] = { 0, 1, 3, 1, 2, 3 };
+			for (int k = 0; k < 6; ++k) {
+				indices.push_back(remap[i + tris[k]]);
+			}
+		}
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const char* fileName = 0;
+	uint32_t gridSize = 128;
+	bool flat = false;
+	uint32_t numLevels = lodbuilder::MAX_LEVELS;
+	float ratio = 0.5f;
+	float fov = 60.0f;
+	float screenHeight = 1080.0f;
+	float pixels = 1.0f;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-grid") == 0 && i + 1 < argc) {
+			gridSize = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-flat") == 0) {
+			flat = true;
+		}
+		else if (strcmp(argv[i], "-levels") == 0 && i + 1 < argc) {
+			numLevels = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-ratio") == 0 && i + 1 < argc) {
+			ratio = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-fov") == 0 && i + 1 < argc) {
+			fov = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-height") == 0 && i + 1 < argc) {
+			screenHeight = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-pixels") == 0 && i + 1 < argc) {
+			pixels = (float)atof(argv[++i]);
+		}
+		else {
+			fileName = argv[i];
+		}
+	}
+	if (numLevels < 1 || numLevels > lodbuilder::MAX_LEVELS) {
+		numLevels = lodbuilder::MAX_LEVELS;
+	}
+	std::vector<lodbuilder::Vertex> vertices;
+	if (fileName != 0) {
+		if (!lodbuilder::load(fileName, vertices)) {
+			return 1;
+		}
+	}
+	else {
+		lodbuilder::buildGrid(gridSize, flat, vertices);
+	}
+	uint32_t num = (uint32_t)vertices.size();
+	if (num < 4) {
+		printf("Mesh has no quads\n");
+		return 1;
+	}
+	// flat shaded meshes have different normals at every corner and are welded by position only
+	std::vector<float> positions(num * 3);
+	for (uint32_t i = 0; i < num; ++i) {
+		memcpy(&positions[i * 3], vertices[i].position, 3 * sizeof(float));
+	}
+	std::vector<uint32_t> remap(num);
+	std::vector<uint32_t> unique(num);
+	uint32_t numPositions = ds::vcache::weldVertices(&positions[0], num, 3 * sizeof(float), &remap[0], &unique[0]);
+	uint32_t numUnique = ds::vcache::weldVertices(&vertices[0], num, sizeof(lodbuilder::Vertex), &remap[0], &unique[0]);
+	bool flatShaded = numUnique > numPositions * 3 / 2;
+	if (flatShaded) {
+		numUnique = ds::vcache::weldVertices(&positions[0], num, 3 * sizeof(float), &remap[0], &unique[0]);
+	}
+	std::vector<lodbuilder::Vertex> welded(numUnique);
+	for (uint32_t i = 0; i < numUnique; ++i) {
+		welded[i] = vertices[unique[i]];
+	}
+	std::vector<uint32_t> indices;
+	lodbuilder::buildQuadIndices(remap, indices);
+	uint32_t numIndices = (uint32_t)indices.size();
+	printf("level 0 : %7u triangles %7u vertices (%s)\n", numIndices / 3, num, flatShaded ? "flat shaded" : "smooth");
+
+	float errors[lodbuilder::MAX_LEVELS] = { 0.0f };
+	std::vector<uint32_t> lod(numIndices);
+	std::vector<uint32_t> quads(numIndices / 3 * 4);
+	uint32_t built = 1;
+	uint32_t target = numIndices;
+	for (uint32_t level = 1; level < numLevels; ++level) {
+		target = (uint32_t)(target / 3 * ratio) * 3;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		float error = 0.0f;
+		uint32_t numLod = ds::simplify::simplify(&lod[0], &indices[0], numIndices, welded[0].position, numUnique, sizeof(lodbuilder::Vertex), target, 1.0f, &error);
+		uint32_t numQuads = ds::simplify::buildQuads(&lod[0], numLod, &quads[0]);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+		printf("level %u : %7u triangles %7u vertices error %.5f (%.1fms)\n", level, numLod / 3, numQuads, error, ms);
+		errors[level] = error;
+		++built;
+	}
+
+	// level selection for a mesh with the radius 1 - the engine uses the same code
+	float projectionScale = screenHeight * 0.5f / tanf(fov * 0.5f * 3.14159265f / 180.0f);
+	printf("\nselection for radius 1 (fov %.0f, height %.0f, max error %.1f pixels)\n", fov, screenHeight, pixels);
+	const float distances[] = { 2.0f, 5.0f, 10.0f, 25.0f, 50.0f, 100.0f, 250.0f, 500.0f, 1000.0f };
+	for (size_t i = 0; i < sizeof(distances) / sizeof(distances[0]); ++i) {
+		float size = ds::simplify::screenSize(1.0f, distances[i], projectionScale);
+		uint32_t level = ds::simplify::selectLevel(errors, built, size, pixels);
+		printf("distance %6.0f : %8.1f pixels level %u errors", distances[i], size, level);
+		for (uint32_t l = 1; l < built; ++l) {
+			printf(" %.2f", errors[l] * size);
+		}
+		printf("\n");
+	}
+	return 0;
+}
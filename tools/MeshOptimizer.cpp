@@ -0,0 +1,170 @@
+// ---------------------------------------------------------------------------
+// MeshOptimizer
+//
+// Offline tool that converts the quads of a .mesh file into an indexed
+// triangle list. Identical vertices are welded and the triangles are
+// reordered for the post transform cache. It reports the vertex count
+// reduction and the average cache miss ratio (ACMR) of every step.
+// Without a file a grid of quads is used.
+//
+// The tool only depends on renderer/VertexCache.cpp:
+//
+//   make -C tools
+//   g++ -O2 -std=c++11 -o meshopt tools/MeshOptimizer.cpp renderer/VertexCache.cpp
+//   cl /O2 /EHsc tools\MeshOptimizer.cpp renderer\VertexCache.cpp /Fe:meshopt.exe
+//
+// Usage: meshopt [<file.mesh>] [-grid 256] [-cache 32]
+// ---------------------------------------------------------------------------
+#include "../renderer/VertexCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+#include <chrono>
+
+namespace meshopt {
+
+	// same layout as PNTCVertex
+	struct Vertex {
+		float position[3];
+		float normal[3];
+		float uv[2];
+		float color[4];
+	};
+
+	// must match MESH_FILE_MAGIC in renderer/MeshBuffer.h
+	const uint32_t MESH_FILE_MAGIC = 0x484D5344;
+
+	struct MeshFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t numVertices;
+		uint32_t flags;
+		float min[3];
+		float max[3];
+	};
+
+	static bool load(const char* fileName, std::vector<Vertex>& vertices) {
+		FILE* f = fopen(fileName, "rb");
+		if (f == 0) {
+			printf("Cannot open '%s'\n", fileName);
+			return false;
+		}
+		MeshFileHeader header;
+		uint32_t num = 0;
+		if (fread(&header, sizeof(MeshFileHeader), 1, f) == 1 && header.magic == MESH_FILE_MAGIC) {
+			num = header.numVertices;
+		}
+		else {
+			fseek(f, 0, SEEK_SET);
+			if (fread(&num, sizeof(uint32_t), 1, f) != 1) {
+				num = 0;
+			}
+		}
+		vertices.resize(num);
+		uint32_t read = num > 0 ? (uint32_t)fread(&vertices[0], sizeof(Vertex), num, f) : 0;
+		fclose(f);
+		if (read != num) {
+			printf("'%s' is truncated - expected %u vertices but found %u\n", fileName, num, read);
+			return false;
+		}
+		return true;
+	}
+
+	// flat quads like the mesh generator writes them - every quad has its own 4 vertices
+	static void buildGrid(uint32_t size, std::vector<Vertex>& vertices) {
+		for (uint32_t y = 0; y < size; ++y) {
+			for (uint32_t x = 0; x < size; ++x) {
+				const float px[] = { 0.0f, 1.0f, 1.0f, 0.0f };
+				const float py[] = { 1.0f, 1.0f, 0.0f, 0.0f };
+				for (int k = 0; k < 4; ++k) {
+					Vertex v;
+					memset(&v, 0, sizeof(Vertex));
+					v.position[0] = x + px[k];
+					v.position[2] = y + py[k];
+					v.normal[1] = 1.0f;
+					v.uv[0] = (x + px[k]) / size;
+					v.uv[1] = (y + py[k]) / size;
+					for (int c = 0; c < 4; ++c) {
+						v.color[c] = 1.0f;
+					}
+					vertices.push_back(v);
+				}
+			}
+		}
+	}
+
+	// same triangles as the quad index buffer
+	static void buildQuadIndices(uint32_t numVertices, std::vector<uint32_t>& indices) {
+		for (uint32_t i = 0; i + 3 < numVertices; i += 4) {
+			indices.push_back(i);
+			indices.push_back(i + 1);
+			indices.push_back(i + 3);
+			indices.push_back(i + 1);
+			indices.push_back(i + 2);
+			indices.push_back(i + 3);
+		}
+	}
+
+}
+
+int main(int argc, char** argv) {
+	const char* fileName = 0;
+	uint32_t gridSize = 256;
+	uint32_t cacheSize = ds::vcache::CACHE_SIZE;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-grid") == 0 && i + 1 < argc) {
+			gridSize = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-cache") == 0 && i + 1 < argc) {
+			cacheSize = atoi(argv[++i]);
+		}
+		else {
+			fileName = argv[i];
+		}
+	}
+	std::vector<meshopt::Vertex> vertices;
+	if (fileName != 0) {
+		if (!meshopt::load(fileName, vertices)) {
+			return 1;
+		}
+	}
+	else {
+		meshopt::buildGrid(gridSize, vertices);
+	}
+	uint32_t num = (uint32_t)vertices.size();
+	if (num < 4) {
+		printf("Mesh has no quads\n");
+		return 1;
+	}
+	std::vector<uint32_t> indices;
+	meshopt::buildQuadIndices(num, indices);
+	uint32_t numIndices = (uint32_t)indices.size();
+	printf("input        : %u vertices %u triangles\n", num, numIndices / 3);
+	printf("flat         : ACMR %.3f\n", ds::vcache::computeACMR(&indices[0], numIndices, cacheSize));
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	std::vector<uint32_t> remap(num);
+	std::vector<uint32_t> unique(num);
+	uint32_t numUnique = ds::vcache::weldVertices(&vertices[0], num, sizeof(meshopt::Vertex), &remap[0], &unique[0]);
+	for (uint32_t i = 0; i < numIndices; ++i) {
+		indices[i] = remap[indices[i]];
+	}
+	auto t1 = std::chrono::high_resolution_clock::now();
+	printf("welded       : %u vertices (%.1f%% less) ACMR %.3f\n", numUnique, 100.0f * (num - numUnique) / num, ds::vcache::computeACMR(&indices[0], numIndices, cacheSize));
+
+	ds::vcache::optimizeVertexCache(&indices[0], numIndices, numUnique);
+	auto t2 = std::chrono::high_resolution_clock::now();
+	printf("cache order  : ACMR %.3f\n", ds::vcache::computeACMR(&indices[0], numIndices, cacheSize));
+
+	std::vector<uint32_t> order(numUnique);
+	uint32_t used = ds::vcache::optimizeVertexFetch(&indices[0], numIndices, numUnique, &order[0]);
+	auto t3 = std::chrono::high_resolution_clock::now();
+	auto ms = [](std::chrono::high_resolution_clock::time_point a, std::chrono::high_resolution_clock::time_point b) {
+		return std::chrono::duration<double, std::milli>(b - a).count();
+	};
+	printf("fetch order  : %u vertices used\n", used);
+	printf("time         : weld %.1fms cache %.1fms fetch %.1fms\n", ms(t0, t1), ms(t1, t2), ms(t2, t3));
+	return 0;
+}
@@ -0,0 +1,182 @@
+#include "Benchmarks.h"
+#include "..\..\scene\AABBTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t PICKING_ENTITIES = 100000;
+		const uint32_t PICKING_RAYS = 1000;
+		// rays parallel to an axis starting on a face of a box
+		const uint32_t PICKING_AXIS_RAYS = 300;
+		const uint32_t PICKING_FRAMES = 100;
+		// percent of the entities that move per frame
+		const uint32_t PICKING_MOVING = 5;
+		const float PICKING_WORLD_SIZE = 1000.0f;
+
+		struct Box {
+			v3 min;
+			v3 max;
+		};
+
+		static float randomFloat(float min, float max) {
+			return min + (max - min) * (float)rand() / (float)RAND_MAX;
+		}
+
+		// ------------------------------------------------------
+		// slab test in double precision - parallel axes only
+		// hit if the origin is inside the slab
+		// ------------------------------------------------------
+		static bool referenceHit(const Ray& ray, const Box& b, double* t) {
+			double tmin = 0.0;
+			double tmax = DBL_MAX;
+			for (int i = 0; i < 3; ++i) {
+				double o = ray.origin.data[i];
+				double d = ray.direction.data[i];
+				if (d == 0.0) {
+					if (o < b.min.data[i] || o > b.max.data[i]) {
+						return false;
+					}
+					continue;
+				}
+				double t1 = (b.min.data[i] - o) / d;
+				double t2 = (b.max.data[i] - o) / d;
+				if (t1 > t2) {
+					double tmp = t1;
+					t1 = t2;
+					t2 = tmp;
+				}
+				tmin = t1 > tmin ? t1 : tmin;
+				tmax = t2 < tmax ? t2 : tmax;
+				if (tmin > tmax) {
+					return false;
+				}
+			}
+			*t = tmin;
+			return true;
+		}
+
+		// ------------------------------------------------------
+		// what Scene::intersects would have done with the box
+		// test enabled - test every entity
+		// ------------------------------------------------------
+		static int bruteForce(const Ray& ray, const std::vector<Box>& boxes, double* best) {
+			int found = -1;
+			*best = DBL_MAX;
+			double t = 0.0;
+			for (size_t i = 0; i < boxes.size(); ++i) {
+				if (referenceHit(ray, boxes[i], &t) && t < *best) {
+					*best = t;
+					found = (int)i;
+				}
+			}
+			return found;
+		}
+
+		void picking() {
+			std::vector<Box> boxes(PICKING_ENTITIES);
+			std::vector<int> proxies(PICKING_ENTITIES);
+			srand(33);
+			for (uint32_t i = 0; i < PICKING_ENTITIES; ++i) {
+				v3 p(randomFloat(0.0f, PICKING_WORLD_SIZE), randomFloat(0.0f, PICKING_WORLD_SIZE), randomFloat(0.0f, PICKING_WORLD_SIZE));
+				v3 e(randomFloat(0.2f, 1.0f), randomFloat(0.2f, 1.0f), randomFloat(0.2f, 1.0f));
+				boxes[i].min = p - e;
+				boxes[i].max = p + e;
+			}
+			AABBTree tree;
+			Timer timer;
+			for (uint32_t i = 0; i < PICKING_ENTITIES; ++i) {
+				proxies[i] = tree.insert(boxes[i].min, boxes[i].max, i);
+			}
+			printf("insert %u entities        : %8.2f ms (height %d)\n", PICKING_ENTITIES, timer.ms(), tree.getHeight());
+
+			// entities drift a little every frame like Scene::updateBounds
+			uint32_t moving = PICKING_ENTITIES * PICKING_MOVING / 100;
+			uint32_t reinserted = 0;
+			timer.reset();
+			for (uint32_t f = 0; f < PICKING_FRAMES; ++f) {
+				for (uint32_t i = 0; i < moving; ++i) {
+					uint32_t idx = ((uint32_t)rand() * RAND_MAX + rand()) % PICKING_ENTITIES;
+					v3 d(randomFloat(-0.05f, 0.05f), randomFloat(-0.05f, 0.05f), randomFloat(-0.05f, 0.05f));
+					boxes[idx].min = boxes[idx].min + d;
+					boxes[idx].max = boxes[idx].max + d;
+					if (tree.move(proxies[idx], boxes[idx].min, boxes[idx].max)) {
+						++reinserted;
+					}
+				}
+			}
+			printf("move %u entities per frame  : %8.3f ms per frame (%u reinserted)\n", moving, timer.ms() / PICKING_FRAMES, reinserted);
+
+			// random rays through the volume and rays along an axis
+			// starting on a face of a box
+			std::vector<Ray> rays;
+			for (uint32_t i = 0; i < PICKING_RAYS; ++i) {
+				v3 o(randomFloat(0.0f, PICKING_WORLD_SIZE), randomFloat(0.0f, PICKING_WORLD_SIZE), -10.0f);
+				v3 target(randomFloat(0.0f, PICKING_WORLD_SIZE), randomFloat(0.0f, PICKING_WORLD_SIZE), PICKING_WORLD_SIZE);
+				rays.push_back(Ray(o, normalize(target - o)));
+			}
+			for (uint32_t i = 0; i < PICKING_AXIS_RAYS; ++i) {
+				const Box& b = boxes[rand() % PICKING_ENTITIES];
+				int axis = i % 3;
+				v3 o = (b.min + b.max) * 0.5f;
+				// on the min plane of the next axis
+				o.data[(axis + 1) % 3] = b.min.data[(axis + 1) % 3];
+				v3 d(0.0f, 0.0f, 0.0f);
+				d.data[axis] = i % 2 == 0 ? 1.0f : -1.0f;
+				o.data[axis] = d.data[axis] > 0.0f ? b.min.data[axis] - 5.0f : b.max.data[axis] + 5.0f;
+				rays.push_back(Ray(o, d));
+			}
+			uint32_t numRays = (uint32_t)rays.size();
+
+			std::vector<int> expected(numRays);
+			std::vector<double> expectedT(numRays);
+			timer.reset();
+			for (uint32_t i = 0; i < numRays; ++i) {
+				expected[i] = bruteForce(rays[i], boxes, &expectedT[i]);
+			}
+			double bruteTime = timer.ms();
+			std::vector<int> hits(numRays);
+			std::vector<float> hitT(numRays);
+			timer.reset();
+			for (uint32_t i = 0; i < numRays; ++i) {
+				uint32_t data = 0;
+				hits[i] = tree.raycast(rays[i], &data, &hitT[i]) ? (int)data : -1;
+			}
+			double treeTime = timer.ms();
+			printf("%u rays (ms)\n", numRays);
+			printf("test every entity             : %8.2f\n", bruteTime);
+			printf("AABBTree::raycast             : %8.2f\n", treeTime);
+
+			// boxes may touch so only the distance has to match
+			uint32_t missed = 0;
+			uint32_t numHits = 0;
+			for (uint32_t i = 0; i < numRays; ++i) {
+				if (expected[i] != -1) {
+					++numHits;
+				}
+				if ((hits[i] == -1) != (expected[i] == -1)) {
+					++missed;
+				}
+				else if (hits[i] != -1 && fabs(hitT[i] - expectedT[i]) > 1e-3 * (1.0 + expectedT[i])) {
+					++missed;
+				}
+			}
+			printf("\n%u of %u rays hit an entity\n", numHits, numRays);
+			check(missed == 0, "%u rays differ from testing every entity", missed);
+			uint32_t axisHits = 0;
+			for (uint32_t i = PICKING_RAYS; i < numRays; ++i) {
+				if (hits[i] != -1) {
+					++axisHits;
+				}
+			}
+			check(axisHits == PICKING_AXIS_RAYS, "only %u of %u rays along an axis hit their box", axisHits, PICKING_AXIS_RAYS);
+		}
+
+	}
+
+}
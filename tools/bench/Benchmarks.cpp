@@ -0,0 +1,149 @@
+// ---------------------------------------------------------------------------
+// Benchmarks
+//
+// Headless benchmarks of engine systems. They link the engine library but
+// never create a window or a device. Every benchmark compares the current
+// code with the code path it replaced and checks the results where that
+// is possible. Build tools\Benchmarks.vcxproj which is part of D11.sln.
+//
+// Usage: bench [-list] [<name> ...]
+//
+// Without a name all benchmarks are run. The program returns 1 if a check
+// failed. See docs/Benchmarks.md.
+// ---------------------------------------------------------------------------
+#include "Benchmarks.h"
+#include "core\log\Log.h"
+#include "core\memory\DefaultAllocator.h"
+#include "core\profiler\Profiler.h"
+#include "..\..\utils\JobSystem.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+namespace ds {
+
+	namespace bench {
+
+		// megabytes of the default allocator
+		const uint32_t MEMORY_SIZE = 512;
+
+		volatile uint32_t sink = 0;
+
+		static uint32_t _failed = 0;
+
+		bool check(bool condition, const char* format, ...) {
+			if (!condition) {
+				va_list args;
+				va_start(args, format);
+				printf("FAILED: ");
+				vprintf(format, args);
+				printf("\n");
+				va_end(args);
+				++_failed;
+			}
+			return condition;
+		}
+
+		void nextFrame() {
+			perf::finalize();
+			perf::reset();
+		}
+
+		struct Benchmark {
+			const char* name;
+			const char* description;
+			void(*function)();
+		};
+
+		static const Benchmark BENCHMARKS[] = {
+			{ "spritesheet", "lookups in a 2k entry SpriteSheet - linear scan and hash index", spriteSheet },
+			{ "sprites", "creates and removes 1M sprites and checks stale SIDs", spriteArray },
+			{ "hierarchy", "50k entities in trees with 5% moving per frame - updateTransforms and matrix products", hierarchy },
+			{ "vertices", "transforms 1M PNTCVertex by a world matrix - scalar loop and SSE", vertexTransform },
+			{ "picking", "ray picking against 100k entities - testing every entity and AABBTree", picking },
+			{ "instancing", "sorts and packs 20k entities with 32 meshes and 8 materials into instance groups", instanceBatch },
+			{ "query", "finds the entities of 32 types in 100k entities - scan and EntityArray::query", entityQuery },
+			{ "growth", "ramps from 0 to 200k entities - growth in create and reserveAhead", entityGrowth },
+			{ "meshload", "loads a 1M vertex mesh - fread per float and one fread", meshLoad },
+			{ "packing", "packs and unpacks 1M random vertices - error bounds and timing", vertexPacking },
+			{ "startup", "loads 500 meshes - Mesh::load before the first frame and the background loader", meshStartup },
+			{ "meshgen", "builds a 1000 x 1000 grid with MeshGen and checks the index against a scan", meshGen }
+		};
+
+		static const uint32_t NUM_BENCHMARKS = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+
+		// ------------------------------------------------------
+		// the parts of BaseApp the engine systems depend on
+		// ------------------------------------------------------
+		static void startup() {
+			init_logger();
+			timer::init_timing();
+			gDefaultMemory = new DefaultAllocator(MEMORY_SIZE * 1024 * 1024);
+			perf::init();
+			jobs::initialize();
+		}
+
+		static void shutdown() {
+			jobs::shutdown();
+			perf::shutdown();
+			delete gDefaultMemory;
+			timer::shutdown_timing();
+			shutdown_logger();
+		}
+
+		static void list() {
+			for (uint32_t i = 0; i < NUM_BENCHMARKS; ++i) {
+				printf("%-12s %s\n", BENCHMARKS[i].name, BENCHMARKS[i].description);
+			}
+		}
+
+		static void run(const Benchmark& b) {
+			printf("\n--- %s : %s\n\n", b.name, b.description);
+			perf::reset();
+			b.function();
+		}
+
+		// ------------------------------------------------------
+		// runs the named benchmarks or all of them
+		// ------------------------------------------------------
+		static int run(int argc, char** argv) {
+			int ret = 0;
+			if (argc < 2) {
+				for (uint32_t i = 0; i < NUM_BENCHMARKS; ++i) {
+					run(BENCHMARKS[i]);
+				}
+			}
+			for (int i = 1; i < argc; ++i) {
+				bool found = false;
+				for (uint32_t j = 0; j < NUM_BENCHMARKS; ++j) {
+					if (strcmp(argv[i], BENCHMARKS[j].name) == 0) {
+						run(BENCHMARKS[j]);
+						found = true;
+					}
+				}
+				if (!found) {
+					printf("Unknown benchmark '%s' - use -list\n", argv[i]);
+					ret = 2;
+				}
+			}
+			if (_failed > 0) {
+				printf("\n%u checks failed\n", _failed);
+				return 1;
+			}
+			return ret;
+		}
+
+	}
+
+}
+
+int main(int argc, char** argv) {
+	if (argc == 2 && strcmp(argv[1], "-list") == 0) {
+		ds::bench::list();
+		return 0;
+	}
+	ds::bench::startup();
+	int ret = ds::bench::run(argc, argv);
+	ds::bench::shutdown();
+	return ret;
+}
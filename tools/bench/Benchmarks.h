@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+
+namespace ds {
+
+	namespace bench {
+
+		// ------------------------------------------------------
+		// wall clock timer in milliseconds
+		// ------------------------------------------------------
+		struct Timer {
+
+			std::chrono::high_resolution_clock::time_point start;
+
+			Timer() : start(std::chrono::high_resolution_clock::now()) {}
+
+			void reset() {
+				start = std::chrono::high_resolution_clock::now();
+			}
+
+			double ms() const {
+				return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			}
+		};
+
+		// ------------------------------------------------------
+		// prints the message if the condition is false. The
+		// program returns 1 if any check failed.
+		// ------------------------------------------------------
+		bool check(bool condition, const char* format, ...);
+
+		// ------------------------------------------------------
+		// marks the end of a simulated frame - resets the
+		// profiler like BaseApp does
+		// ------------------------------------------------------
+		void nextFrame();
+
+		// results are added here so that the measured work is
+		// not optimized away
+		extern volatile uint32_t sink;
+
+		// ------------------------------------------------------
+		// benchmarks
+		// ------------------------------------------------------
+		void spriteSheet();
+
+		void spriteArray();
+
+		void hierarchy();
+
+		void vertexTransform();
+
+		void picking();
+
+		void instanceBatch();
+
+		void entityQuery();
+
+		void entityGrowth();
+
+		void meshLoad();
+
+		void vertexPacking();
+
+		void meshStartup();
+
+		void meshGen();
+
+	}
+
+}
@@ -0,0 +1,91 @@
+#include "Benchmarks.h"
+#include "..\..\scene\EntityArray.h"
+#include <stdio.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t GROWTH_ENTITIES = 200000;
+		const uint32_t GROWTH_PER_FRAME = 100;
+		// a frame slower than this counts as a stall
+		const double GROWTH_FRAME_BUDGET = 2.0;
+
+		struct GrowthResult {
+			double total;
+			double worst;
+			uint32_t worstFrame;
+			uint32_t slowFrames;
+		};
+
+		// ------------------------------------------------------
+		// creates GROWTH_PER_FRAME entities per frame and runs a
+		// system over all of them. The timers count the frames
+		// so that lost writes during a move show up.
+		// ------------------------------------------------------
+		static GrowthResult ramp(EntityArray* data, bool ahead, std::vector<ID>& ids) {
+			GrowthResult r = { 0.0, 0.0, 0, 0 };
+			Timer timer;
+			uint32_t frames = GROWTH_ENTITIES / GROWTH_PER_FRAME;
+			for (uint32_t f = 0; f < frames; ++f) {
+				timer.reset();
+				for (uint32_t i = 0; i < GROWTH_PER_FRAME; ++i) {
+					uint32_t n = f * GROWTH_PER_FRAME + i;
+					ids[n] = data->create(v3((float)n, 0.0f, 0.0f), 0, v3(1.0f, 1.0f, 1.0f), v3(0.0f, 0.0f, 0.0f), 0, Color::WHITE);
+				}
+				float* timers = data->timers;
+				auto tick = [timers](uint32_t start, uint32_t end) {
+					for (uint32_t i = start; i < end; ++i) {
+						timers[i] += 1.0f;
+					}
+				};
+				data->forEachChunk(tick);
+				if (ahead) {
+					data->reserveAhead();
+				}
+				double ms = timer.ms();
+				r.total += ms;
+				if (ms > r.worst) {
+					r.worst = ms;
+					r.worstFrame = f;
+				}
+				if (ms > GROWTH_FRAME_BUDGET) {
+					++r.slowFrames;
+				}
+				nextFrame();
+			}
+			return r;
+		}
+
+		static void verify(const EntityArray* data, const std::vector<ID>& ids, const char* name) {
+			uint32_t frames = GROWTH_ENTITIES / GROWTH_PER_FRAME;
+			uint32_t wrong = 0;
+			for (uint32_t n = 0; n < GROWTH_ENTITIES; ++n) {
+				int idx = data->getIndex(ids[n]);
+				if (idx == -1 || data->positions[idx].x != (float)n || data->timers[idx] != (float)(frames - n / GROWTH_PER_FRAME)) {
+					++wrong;
+				}
+			}
+			check(data->num == GROWTH_ENTITIES, "%s: %u entities - expected %u", name, data->num, GROWTH_ENTITIES);
+			check(wrong == 0, "%s: %u entities lost their data", name, wrong);
+		}
+
+		void entityGrowth() {
+			std::vector<ID> ids(GROWTH_ENTITIES);
+			const char* names[] = { "create grows the columns", "reserveAhead every frame" };
+			printf("0 to %u entities, %u per frame (ms)\n", GROWTH_ENTITIES, GROWTH_PER_FRAME);
+			printf("%-28s : %8s %8s %6s %12s\n", "", "total", "worst", "frame", "over 2 ms");
+			for (int i = 0; i < 2; ++i) {
+				EntityArray* data = new EntityArray;
+				GrowthResult r = ramp(data, i == 1, ids);
+				printf("%-28s : %8.2f %8.3f %6u %12u\n", names[i], r.total, r.worst, r.worstFrame, r.slowFrames);
+				verify(data, ids, names[i]);
+				data->release();
+				delete data;
+			}
+		}
+
+	}
+
+}
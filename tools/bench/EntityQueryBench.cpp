@@ -0,0 +1,102 @@
+#include "Benchmarks.h"
+#include "..\..\scene\EntityArray.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t QUERY_ENTITIES = 100000;
+		const uint32_t QUERY_TYPES = 32;
+		const uint32_t QUERY_FRAMES = 100;
+		// entities changing their type per frame
+		const uint32_t QUERY_RETYPED = 1000;
+
+		// ------------------------------------------------------
+		// the previous Scene::find - scans the types column
+		// ------------------------------------------------------
+		static uint32_t scanType(const EntityArray& data, uint16_t type, ID* ids, uint32_t max) {
+			uint32_t cnt = 0;
+			for (uint32_t i = 0; i < data.num; ++i) {
+				if (data.types[i] == type && cnt < max) {
+					ids[cnt++] = data.ids[i];
+				}
+			}
+			return cnt;
+		}
+
+		static uint32_t queryType(const EntityArray& data, uint16_t type, ID* ids, uint32_t max) {
+			EntityTypeQuery q = data.query(type);
+			uint32_t cnt = q.size() < max ? q.size() : max;
+			for (uint32_t i = 0; i < cnt; ++i) {
+				ids[i] = q.first[i];
+			}
+			return cnt;
+		}
+
+		void entityQuery() {
+			EntityArray* data = new EntityArray;
+			srand(37);
+			for (uint32_t i = 0; i < QUERY_ENTITIES; ++i) {
+				ID id = data->create(v3((float)(i % 1000), 0.0f, (float)(i / 1000)), 0, v3(1.0f, 1.0f, 1.0f), v3(0.0f, 0.0f, 0.0f), 0, Color::WHITE);
+				data->setType(id, rand() % QUERY_TYPES);
+			}
+			std::vector<ID> all(data->num);
+			for (uint32_t i = 0; i < data->num; ++i) {
+				all[i] = data->ids[i];
+			}
+			std::vector<ID> ids(QUERY_ENTITIES);
+			double scanTime = 0.0;
+			double queryTime = 0.0;
+			double retypeTime = 0.0;
+			uint32_t sum = 0;
+			Timer timer;
+			for (uint32_t f = 0; f < QUERY_FRAMES; ++f) {
+				timer.reset();
+				for (uint32_t i = 0; i < QUERY_RETYPED; ++i) {
+					data->setType(all[((uint32_t)rand() * RAND_MAX + rand()) % all.size()], rand() % QUERY_TYPES);
+				}
+				retypeTime += timer.ms();
+				// every type once per frame like systems looking up their entities
+				timer.reset();
+				for (uint16_t t = 0; t < QUERY_TYPES; ++t) {
+					sum += scanType(*data, t, &ids[0], QUERY_ENTITIES);
+				}
+				scanTime += timer.ms();
+				timer.reset();
+				for (uint16_t t = 0; t < QUERY_TYPES; ++t) {
+					sum += queryType(*data, t, &ids[0], QUERY_ENTITIES);
+				}
+				queryTime += timer.ms();
+				nextFrame();
+			}
+			sink += sum;
+			printf("%u entities, %u types, %u type changes per frame (ms per frame)\n", QUERY_ENTITIES, QUERY_TYPES, QUERY_RETYPED);
+			printf("scan of the types column    : %8.3f\n", scanTime / QUERY_FRAMES);
+			printf("EntityArray::query          : %8.3f\n", queryTime / QUERY_FRAMES);
+			printf("EntityArray::setType        : %8.3f\n", retypeTime / QUERY_FRAMES);
+
+			// both must return the same IDs - the order differs
+			std::vector<ID> scanned(QUERY_ENTITIES);
+			uint32_t total = 0;
+			for (uint16_t t = 0; t < QUERY_TYPES; ++t) {
+				uint32_t ns = scanType(*data, t, &scanned[0], QUERY_ENTITIES);
+				uint32_t nq = queryType(*data, t, &ids[0], QUERY_ENTITIES);
+				std::sort(scanned.begin(), scanned.begin() + ns);
+				std::sort(ids.begin(), ids.begin() + nq);
+				total += nq;
+				if (!check(ns == nq && std::equal(scanned.begin(), scanned.begin() + ns, ids.begin()), "query of type %d differs from the scan", t)) {
+					break;
+				}
+			}
+			check(total == data->num, "the type lists hold %u of %u entities", total, data->num);
+			data->release();
+			delete data;
+		}
+
+	}
+
+}
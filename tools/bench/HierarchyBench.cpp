@@ -0,0 +1,140 @@
+#include "Benchmarks.h"
+#include "..\..\scene\EntityArray.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		// 5000 trees of a root with 3 children and 2 grandchildren per child
+		const uint32_t HIERARCHY_TREES = 5000;
+		const uint32_t HIERARCHY_FRAMES = 100;
+		// percent of the entities that move per frame
+		const uint32_t HIERARCHY_MOVING = 5;
+
+		// ------------------------------------------------------
+		// the previous Scene::updateWorld - five matrix products
+		// per entity and one more for the parent
+		// ------------------------------------------------------
+		static mat4 localMatrix(const EntityArray& data, uint32_t idx) {
+			mat4 rotY = matrix::mat4RotationY(data.rotations[idx].y);
+			mat4 rotX = matrix::mat4RotationX(data.rotations[idx].x);
+			mat4 rotZ = matrix::mat4RotationZ(data.rotations[idx].z);
+			mat4 t = matrix::mat4Transform(data.positions[idx]);
+			mat4 s = matrix::mat4Scale(data.scales[idx]);
+			return rotZ * rotY * rotX * s * t;
+		}
+
+		// all entities in parent first order like the old code needed
+		static void rebuildAll(const EntityArray& data, const std::vector<uint32_t>& order, const std::vector<int>& parents, std::vector<mat4>& worlds) {
+			for (size_t i = 0; i < order.size(); ++i) {
+				uint32_t idx = order[i];
+				worlds[idx] = localMatrix(data, idx);
+				if (parents[idx] != -1) {
+					worlds[idx] = worlds[idx] * worlds[parents[idx]];
+				}
+			}
+		}
+
+		static float matrixError(const mat4& a, const mat4& b) {
+			float error = 0.0f;
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					float d = fabs(a.m[r][c] - b.m[r][c]) / (1.0f + fabs(b.m[r][c]));
+					if (d > error) {
+						error = d;
+					}
+				}
+			}
+			return error;
+		}
+
+		void hierarchy() {
+			EntityArray* data = new EntityArray;
+			srand(31);
+			for (uint32_t t = 0; t < HIERARCHY_TREES; ++t) {
+				v3 p((float)(t % 100) * 10.0f, 0.0f, (float)(t / 100) * 10.0f);
+				ID root = data->create(p, 0, v3(1.0f, 1.0f, 1.0f), v3(0.0f, 0.1f * (t % 7), 0.0f), 0, Color::WHITE);
+				for (uint32_t c = 0; c < 3; ++c) {
+					ID child = data->create(v3(2.0f, 0.5f * c, 0.0f), 0, v3(0.5f, 0.5f, 0.5f), v3(0.2f * c, 0.0f, 0.3f), 0, Color::WHITE);
+					data->setParent(child, root);
+					for (uint32_t g = 0; g < 2; ++g) {
+						ID grandChild = data->create(v3(0.0f, 1.0f + g, 0.5f), 0, v3(1.0f, 2.0f, 1.0f), v3(0.0f, 0.5f * g, 0.1f), 0, Color::WHITE);
+						data->setParent(grandChild, child);
+					}
+				}
+			}
+			uint32_t num = data->num;
+			Timer timer;
+			data->updateTransforms();
+			printf("%u entities, first pass with order : %8.3f ms\n", num, timer.ms());
+
+			// data indices of the parents and a parent first order for the old path
+			std::vector<int> parents(num);
+			std::vector<uint32_t> order;
+			order.reserve(num);
+			for (uint32_t i = 0; i < num; ++i) {
+				parents[i] = data->parents[i] != INVALID_ID ? data->getIndex(data->parents[i]) : -1;
+			}
+			for (uint32_t depth = 0; order.size() < num; ++depth) {
+				for (uint32_t i = 0; i < num; ++i) {
+					uint32_t d = 0;
+					for (int p = parents[i]; p != -1; p = parents[p]) {
+						++d;
+					}
+					if (d == depth) {
+						order.push_back(i);
+					}
+				}
+			}
+			std::vector<mat4> reference(num);
+
+			uint32_t moving = num * HIERARCHY_MOVING / 100;
+			double oldTime = 0.0;
+			double newTime = 0.0;
+			for (uint32_t f = 0; f < HIERARCHY_FRAMES; ++f) {
+				for (uint32_t i = 0; i < moving; ++i) {
+					uint32_t idx = ((uint32_t)rand() * RAND_MAX + rand()) % num;
+					data->positions[idx].x += 0.01f;
+					data->rotations[idx].y += 0.02f;
+					data->dirty[idx] = true;
+				}
+				timer.reset();
+				data->updateTransforms();
+				newTime += timer.ms();
+				timer.reset();
+				rebuildAll(*data, order, parents, reference);
+				oldTime += timer.ms();
+				nextFrame();
+			}
+			printf("%u%% moving per frame (ms per frame)\n", HIERARCHY_MOVING);
+			printf("matrix products, all entities       : %8.3f\n", oldTime / HIERARCHY_FRAMES);
+			printf("updateTransforms, dirty subtrees    : %8.3f\n", newTime / HIERARCHY_FRAMES);
+
+			// every entity dirty - the cost of a full pass
+			for (uint32_t i = 0; i < num; ++i) {
+				data->dirty[i] = true;
+			}
+			timer.reset();
+			data->updateTransforms();
+			printf("updateTransforms, all entities      : %8.3f\n", timer.ms());
+
+			float maxError = 0.0f;
+			for (uint32_t i = 0; i < num; ++i) {
+				float e = matrixError(data->worlds[i], reference[i]);
+				if (e > maxError) {
+					maxError = e;
+				}
+			}
+			printf("\nlargest difference to the matrix products : %g\n", maxError);
+			check(maxError < 1e-4f, "world matrices differ from the old path by %g", maxError);
+			data->release();
+			delete data;
+		}
+
+	}
+
+}
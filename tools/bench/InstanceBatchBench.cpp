@@ -0,0 +1,95 @@
+#include "Benchmarks.h"
+#include "..\..\renderer\InstanceBatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t BATCH_ENTITIES = 20000;
+		const uint32_t BATCH_MESHES = 32;
+		const uint32_t BATCH_MATERIALS = 8;
+		const uint32_t BATCH_FRAMES = 100;
+
+		// the batch only compares the mesh pointers
+		static char MESH_KEYS[BATCH_MESHES];
+
+		void instanceBatch() {
+			std::vector<mat4> worlds(BATCH_ENTITIES);
+			std::vector<Color> colors(BATCH_ENTITIES);
+			std::vector<Mesh*> meshes(BATCH_ENTITIES);
+			std::vector<RID> materials(BATCH_ENTITIES);
+			srand(35);
+			for (uint32_t i = 0; i < BATCH_ENTITIES; ++i) {
+				worlds[i] = matrix::mat4Transform(v3((float)(i % 100), 0.0f, (float)(i / 100)));
+				colors[i] = Color((float)(i % 256) / 255.0f, 1.0f, 1.0f, 1.0f);
+				meshes[i] = (Mesh*)(MESH_KEYS + rand() % BATCH_MESHES);
+				materials[i] = rand() % BATCH_MATERIALS;
+			}
+			// the previous path flushed the mesh buffer on every
+			// material change in entity order
+			uint32_t flushes = 1;
+			for (uint32_t i = 1; i < BATCH_ENTITIES; ++i) {
+				if (materials[i] != materials[i - 1]) {
+					++flushes;
+				}
+			}
+
+			InstanceBatch batch;
+			Timer timer;
+			double addTime = 0.0;
+			double buildTime = 0.0;
+			for (uint32_t f = 0; f < BATCH_FRAMES; ++f) {
+				timer.reset();
+				batch.clear();
+				for (uint32_t i = 0; i < BATCH_ENTITIES; ++i) {
+					batch.add(meshes[i], materials[i], i);
+				}
+				addTime += timer.ms();
+				timer.reset();
+				batch.build(&worlds[0], &colors[0]);
+				buildTime += timer.ms();
+				nextFrame();
+			}
+			printf("%u entities, %u meshes, %u materials (ms per frame)\n", BATCH_ENTITIES, BATCH_MESHES, BATCH_MATERIALS);
+			printf("InstanceBatch::add         : %8.3f\n", addTime / BATCH_FRAMES);
+			printf("InstanceBatch::build       : %8.3f\n", buildTime / BATCH_FRAMES);
+			printf("\nflushes in entity order    : %8u\n", flushes);
+			printf("instance groups            : %8u\n", batch.numGroups());
+
+			// every group is a contiguous range of one mesh and material,
+			// no pair appears twice and every entity is packed once
+			check(batch.numInstances() == BATCH_ENTITIES, "%u instances - expected %u", batch.numInstances(), BATCH_ENTITIES);
+			check(batch.numGroups() <= BATCH_MESHES * BATCH_MATERIALS, "%u groups for %u mesh/material pairs", batch.numGroups(), BATCH_MESHES * BATCH_MATERIALS);
+			std::vector<uint32_t> counts(BATCH_MESHES * BATCH_MATERIALS, 0);
+			std::vector<bool> seen(BATCH_MESHES * BATCH_MATERIALS, false);
+			for (uint32_t i = 0; i < BATCH_ENTITIES; ++i) {
+				++counts[materials[i] * BATCH_MESHES + (uint32_t)((char*)meshes[i] - MESH_KEYS)];
+			}
+			const InstanceData* instances = batch.getInstances();
+			uint32_t next = 0;
+			uint32_t wrong = 0;
+			for (uint32_t g = 0; g < batch.numGroups(); ++g) {
+				const InstanceGroup& group = batch.getGroup(g);
+				uint32_t key = group.material * BATCH_MESHES + (uint32_t)((char*)group.mesh - MESH_KEYS);
+				if (!check(group.first == next && !seen[key] && group.num == counts[key], "group %u is not a contiguous range of all its instances", g)) {
+					break;
+				}
+				seen[key] = true;
+				next += group.num;
+				for (uint32_t i = group.first; i < group.first + group.num; ++i) {
+					// the color identifies the entity modulo 256 and the world matrix exactly
+					uint32_t idx = (uint32_t)instances[i].world._41 + (uint32_t)instances[i].world._43 * 100;
+					if (idx >= BATCH_ENTITIES || meshes[idx] != group.mesh || materials[idx] != group.material || !(colors[idx] == instances[i].color)) {
+						++wrong;
+					}
+				}
+			}
+			check(wrong == 0, "%u instances are packed in the wrong group", wrong);
+		}
+
+	}
+
+}
@@ -0,0 +1,57 @@
+#include "Benchmarks.h"
+#include "..\..\gen\MeshGen.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace ds {
+
+	namespace bench {
+
+		// 1M faces need MESHGEN_32BIT_INDICES - see MeshGen.props
+		const int MESHGEN_GRID_STEPS = 1000;
+		const uint32_t MESHGEN_MOVED_FACES = 10000;
+		// vertices compared with a scan of the whole mesh
+		const int MESHGEN_SAMPLES = 100;
+
+		void meshGen() {
+			uint32_t numFaces = MESHGEN_GRID_STEPS * MESHGEN_GRID_STEPS;
+			// every face has 4 edges
+			if (!check((uint64_t)numFaces * 4 <= gen::MAX_GEN_INDEX, "%u faces need 32 bit indices - build with MeshGenIndexBits=32", numFaces)) {
+				return;
+			}
+			gen::MeshGen* gen = new gen::MeshGen;
+			Timer timer;
+			gen->create_grid(v2(1.0f, 1.0f), MESHGEN_GRID_STEPS, MESHGEN_GRID_STEPS);
+			double gridTime = timer.ms();
+			check(gen->num_faces() == (int)numFaces, "create_grid built %d faces - expected %u", gen->num_faces(), numFaces);
+
+			// move_face finds the shared vertices and moves them into new cells
+			srand(50);
+			timer.reset();
+			for (uint32_t i = 0; i < MESHGEN_MOVED_FACES; ++i) {
+				uint32_t face = ((uint32_t)rand() * RAND_MAX + rand()) % numFaces;
+				gen->move_face(face, v3(0.0f, 0.0f, 0.25f));
+			}
+			double moveTime = timer.ms();
+
+			Mesh mesh;
+			timer.reset();
+			gen->build(&mesh);
+			double buildTime = timer.ms();
+
+			timer.reset();
+			int wrong = gen->verify_index(MESHGEN_SAMPLES);
+			double verifyTime = timer.ms();
+			printf("%d x %d grid, %u faces (ms)\n", MESHGEN_GRID_STEPS, MESHGEN_GRID_STEPS, numFaces);
+			printf("MeshGen::create_grid         : %8.2f\n", gridTime);
+			printf("MeshGen::move_face x %-7u : %8.2f\n", MESHGEN_MOVED_FACES, moveTime);
+			printf("MeshGen::build               : %8.2f\n", buildTime);
+			printf("MeshGen::verify_index (%d)  : %8.2f\n", MESHGEN_SAMPLES, verifyTime);
+			check(mesh.vertices.size() == numFaces * 4, "build created %u vertices - expected %u", mesh.vertices.size(), numFaces * 4);
+			check(wrong == 0, "%d lookups differ from a scan of the mesh", wrong);
+			delete gen;
+		}
+
+	}
+
+}
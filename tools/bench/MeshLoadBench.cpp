@@ -0,0 +1,130 @@
+#include "Benchmarks.h"
+#include "..\..\renderer\MeshBuffer.h"
+#include <stdio.h>
+#include <string.h>
+#include <direct.h>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t LOAD_VERTICES = 1000000;
+		const uint32_t LOAD_RUNS = 5;
+
+		// ------------------------------------------------------
+		// the previous Mesh::load - old format, one fread per
+		// float and the bounding box built afterwards
+		// ------------------------------------------------------
+		static void loadPerFloat(Mesh* mesh, const char* fileName) {
+			char buffer[256];
+			sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
+			FILE* f = fopen(buffer, "rb");
+			if (f) {
+				int size = -1;
+				fread(&size, sizeof(uint32_t), 1, f);
+				for (int i = 0; i < size; ++i) {
+					v3 p;
+					for (int k = 0; k < 3; ++k) {
+						fread(&p.data[k], sizeof(float), 1, f);
+					}
+					v3 n;
+					for (int k = 0; k < 3; ++k) {
+						fread(&n.data[k], sizeof(float), 1, f);
+					}
+					v2 uv;
+					for (int k = 0; k < 2; ++k) {
+						fread(&uv.data[k], sizeof(float), 1, f);
+					}
+					Color color;
+					fread(&color.r, sizeof(float), 1, f);
+					fread(&color.g, sizeof(float), 1, f);
+					fread(&color.b, sizeof(float), 1, f);
+					fread(&color.a, sizeof(float), 1, f);
+					mesh->add(p, n, uv, color);
+				}
+				fclose(f);
+				mesh->buildBoundingBox();
+			}
+		}
+
+		// the old format is the vertex count followed by the vertices
+		static void saveOldFormat(const Mesh& mesh, const char* fileName) {
+			char buffer[256];
+			sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
+			FILE* f = fopen(buffer, "wb");
+			if (f) {
+				uint32_t size = mesh.vertices.size();
+				fwrite(&size, sizeof(uint32_t), 1, f);
+				fwrite(mesh.vertices.data(), sizeof(PNTCVertex), size, f);
+				fclose(f);
+			}
+		}
+
+		static void removeMesh(const char* fileName) {
+			char buffer[256];
+			sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", fileName);
+			remove(buffer);
+		}
+
+		static bool sameMesh(const Mesh& a, const Mesh& b) {
+			if (a.vertices.size() != b.vertices.size()) {
+				return false;
+			}
+			return memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(PNTCVertex)) == 0;
+		}
+
+		static float boxError(const AABBox& a, const AABBox& b) {
+			v3 dp = a.position - b.position;
+			v3 de = a.extent - b.extent;
+			return length(dp) + length(de);
+		}
+
+		void meshLoad() {
+			// Mesh::load and Mesh::save use this folder relative to the working directory
+			_mkdir("content");
+			_mkdir("content\\meshes");
+			Mesh source;
+			for (uint32_t i = 0; i < LOAD_VERTICES; ++i) {
+				float x = (float)(i % 1000);
+				float z = (float)(i / 1000);
+				source.add(v3(x, 0.01f * (float)(i % 7), z), v3(0.0f, 1.0f, 0.0f), v2(x / 1000.0f, z / 1000.0f), Color(1.0f, 0.5f, 0.25f, 1.0f));
+			}
+			source.save("bench_1m");
+			saveOldFormat(source, "bench_1m_old");
+			printf("%u vertices, %u KB per file (ms per load)\n", LOAD_VERTICES, (uint32_t)(LOAD_VERTICES * sizeof(PNTCVertex) / 1024));
+
+			double times[3] = { 0.0 };
+			bool same = true;
+			float error = 0.0f;
+			Timer timer;
+			for (uint32_t r = 0; r < LOAD_RUNS; ++r) {
+				Mesh perFloat;
+				timer.reset();
+				loadPerFloat(&perFloat, "bench_1m_old");
+				times[0] += timer.ms();
+				Mesh legacy;
+				timer.reset();
+				legacy.load("bench_1m_old");
+				times[1] += timer.ms();
+				Mesh bulk;
+				timer.reset();
+				bulk.load("bench_1m");
+				times[2] += timer.ms();
+				same = same && sameMesh(source, perFloat) && sameMesh(source, legacy) && sameMesh(source, bulk);
+				float e = boxError(perFloat.boundingBox, bulk.boundingBox) + boxError(perFloat.boundingBox, legacy.boundingBox);
+				if (e > error) {
+					error = e;
+				}
+			}
+			printf("old format, fread per float    : %8.2f\n", times[0] / LOAD_RUNS);
+			printf("old format, Mesh::load         : %8.2f\n", times[1] / LOAD_RUNS);
+			printf("MeshFileHeader, Mesh::load     : %8.2f\n", times[2] / LOAD_RUNS);
+			check(same, "the loaded vertices differ from the saved mesh");
+			check(error < 1e-3f, "the bounding boxes differ by %g", error);
+			removeMesh("bench_1m");
+			removeMesh("bench_1m_old");
+		}
+
+	}
+
+}
@@ -0,0 +1,110 @@
+#include "Benchmarks.h"
+#include "..\..\resources\MeshLoader.h"
+#include <stdio.h>
+#include <string.h>
+#include <direct.h>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t STARTUP_MESHES = 500;
+		// every mesh has 1000 to 2750 vertices
+		const uint32_t STARTUP_VERTICES = 1000;
+
+		static void startupName(char* buffer, uint32_t index) {
+			sprintf_s(buffer, 64, "bench_startup_%u", index);
+		}
+
+		static void fillMesh(Mesh* mesh, uint32_t index) {
+			uint32_t num = STARTUP_VERTICES + (index % 8) * 250;
+			for (uint32_t i = 0; i < num; ++i) {
+				float x = (float)(i % 50);
+				float z = (float)(i / 50);
+				mesh->add(v3(x, (float)index, z), v3(0.0f, 1.0f, 0.0f), v2(x / 50.0f, z / 50.0f), Color(1.0f, (float)(index % 256) / 255.0f, 0.5f, 1.0f));
+			}
+		}
+
+		// counts the meshes that differ from the saved ones
+		static uint32_t verifyMeshes(Mesh* meshes) {
+			uint32_t wrong = 0;
+			for (uint32_t i = 0; i < STARTUP_MESHES; ++i) {
+				Mesh expected;
+				fillMesh(&expected, i);
+				const Mesh& m = meshes[i];
+				if (!loader::isReady(&m) || m.vertices.size() != expected.vertices.size() || memcmp(m.vertices.data(), expected.vertices.data(), m.vertices.size() * sizeof(PNTCVertex)) != 0) {
+					++wrong;
+				}
+			}
+			return wrong;
+		}
+
+		// ------------------------------------------------------
+		// the main thread is blocked until the last mesh is
+		// loaded before the first frame - then the meshes are
+		// queued and loader::update runs once per frame
+		// ------------------------------------------------------
+		void meshStartup() {
+			_mkdir("content");
+			_mkdir("content\\meshes");
+			char name[64];
+			for (uint32_t i = 0; i < STARTUP_MESHES; ++i) {
+				Mesh mesh;
+				fillMesh(&mesh, i);
+				startupName(name, i);
+				mesh.save(name);
+			}
+
+			Mesh* meshes = new Mesh[STARTUP_MESHES];
+			Timer timer;
+			for (uint32_t i = 0; i < STARTUP_MESHES; ++i) {
+				startupName(name, i);
+				meshes[i].load(name);
+			}
+			double syncTime = timer.ms();
+			check(verifyMeshes(meshes) == 0, "Mesh::load - meshes differ from the saved ones");
+			delete[] meshes;
+
+			meshes = new Mesh[STARTUP_MESHES];
+			loader::initialize();
+			timer.reset();
+			for (uint32_t i = 0; i < STARTUP_MESHES; ++i) {
+				startupName(name, i);
+				loader::load(&meshes[i], name);
+			}
+			double queueTime = timer.ms();
+			uint32_t frames = 0;
+			double worst = 0.0;
+			Timer frameTimer;
+			while (loader::numPending() > 0) {
+				frameTimer.reset();
+				if (loader::update() > 0) {
+					double ms = frameTimer.ms();
+					if (ms > worst) {
+						worst = ms;
+					}
+					++frames;
+				}
+				nextFrame();
+			}
+			double asyncTime = timer.ms();
+			loader::shutdown();
+			printf("%u meshes (ms)\n", STARTUP_MESHES);
+			printf("Mesh::load before the first frame  : %8.2f\n", syncTime);
+			printf("loader::load before the first frame: %8.2f\n", queueTime);
+			printf("all meshes loaded in the background: %8.2f\n", asyncTime);
+			printf("worst loader::update               : %8.3f (%u frames applied meshes)\n", worst, frames);
+			check(verifyMeshes(meshes) == 0, "loader::load - meshes differ from the saved ones");
+			delete[] meshes;
+
+			for (uint32_t i = 0; i < STARTUP_MESHES; ++i) {
+				char buffer[256];
+				startupName(name, i);
+				sprintf_s(buffer, 256, "content\\meshes\\%s.mesh", name);
+				remove(buffer);
+			}
+		}
+
+	}
+
+}
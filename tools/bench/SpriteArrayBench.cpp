@@ -0,0 +1,112 @@
+#include "Benchmarks.h"
+#include "..\..\sprites\SpriteArray.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t STRESS_SPRITES = 1000000;
+
+		// ------------------------------------------------------
+		// creates and removes 1M sprites. Removed SIDs must be
+		// rejected even after their slots were reused.
+		// ------------------------------------------------------
+		void spriteArray() {
+			SpriteArray* sprites = new SpriteArray;
+			Texture t(Rect(0.0f, 0.0f, 32.0f, 32.0f));
+			std::vector<SID> ids(STRESS_SPRITES);
+			Timer timer;
+			for (uint32_t i = 0; i < STRESS_SPRITES; ++i) {
+				ids[i] = sprites->create(v2((float)(i % 1024), (float)(i / 1024)), t);
+			}
+			printf("create %u sprites              : %8.2f ms (capacity %u)\n", STRESS_SPRITES, timer.ms(), sprites->capacity);
+
+			// remove every other sprite in random order
+			std::vector<SID> removed;
+			removed.reserve(STRESS_SPRITES / 2);
+			srand(30);
+			for (uint32_t i = 0; i < STRESS_SPRITES; i += 2) {
+				removed.push_back(ids[i]);
+			}
+			for (size_t i = removed.size() - 1; i > 0; --i) {
+				size_t j = ((size_t)rand() * RAND_MAX + rand()) % (i + 1);
+				SID tmp = removed[i];
+				removed[i] = removed[j];
+				removed[j] = tmp;
+			}
+			timer.reset();
+			for (size_t i = 0; i < removed.size(); ++i) {
+				sprites->remove(removed[i]);
+			}
+			printf("remove %u sprites               : %8.2f ms\n", (uint32_t)removed.size(), timer.ms());
+
+			// the new sprites reuse the freed slots
+			std::vector<SID> created(removed.size());
+			timer.reset();
+			for (size_t i = 0; i < created.size(); ++i) {
+				created[i] = sprites->create(v2(-1.0f, (float)i), t);
+			}
+			printf("create %u sprites in free slots : %8.2f ms\n", (uint32_t)created.size(), timer.ms());
+
+			timer.reset();
+			uint32_t stale = 0;
+			for (size_t i = 0; i < removed.size(); ++i) {
+				if (sprites->contains(removed[i])) {
+					++stale;
+				}
+			}
+			uint32_t alive = 0;
+			for (uint32_t i = 1; i < STRESS_SPRITES; i += 2) {
+				if (sprites->contains(ids[i])) {
+					++alive;
+				}
+			}
+			for (size_t i = 0; i < created.size(); ++i) {
+				if (sprites->contains(created[i])) {
+					++alive;
+				}
+			}
+			printf("check %u SIDs                  : %8.2f ms\n", STRESS_SPRITES + (uint32_t)removed.size(), timer.ms());
+			check(stale == 0, "%u removed SIDs are still valid", stale);
+			check(alive == STRESS_SPRITES, "only %u of %u SIDs are valid", alive, STRESS_SPRITES);
+			check(sprites->num == STRESS_SPRITES, "SpriteArray contains %u sprites - expected %u", sprites->num, STRESS_SPRITES);
+			for (uint32_t i = 1; i < STRESS_SPRITES; i += 2) {
+				const v2& p = sprites->getPosition(ids[i]);
+				if (!check(p.x == (float)(i % 1024) && p.y == (float)(i / 1024), "sprite %u moved", i)) {
+					break;
+				}
+			}
+
+			timer.reset();
+			for (uint32_t i = 1; i < STRESS_SPRITES; i += 2) {
+				sprites->remove(ids[i]);
+			}
+			for (size_t i = 0; i < created.size(); ++i) {
+				sprites->remove(created[i]);
+			}
+			printf("remove all                          : %8.2f ms\n", timer.ms());
+			check(sprites->num == 0, "SpriteArray is not empty");
+
+			// the generation has 10 bits - a slot reused 1024 times
+			// gives the first SID again (see utils/Handle.h)
+			SID first = sprites->create(v2(0.0f, 0.0f), t);
+			SID last = first;
+			uint32_t cycles = 0;
+			do {
+				sprites->remove(last);
+				last = sprites->create(v2(0.0f, 0.0f), t);
+				++cycles;
+			} while (last != first && cycles < 4096);
+			printf("\nSID of a slot repeats after %u reuses\n", cycles);
+			check(cycles == handle::GENERATION_MASK + 1, "generation wraps after %u reuses - expected %u", cycles, handle::GENERATION_MASK + 1);
+			sprites->remove(last);
+			DEALLOC(sprites->buffer);
+			delete sprites;
+		}
+
+	}
+
+}
@@ -0,0 +1,98 @@
+#include "Benchmarks.h"
+#include "..\..\renderer\SpriteSheet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <string>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t SHEET_ENTRIES = 2048;
+		const uint32_t SHEET_LOOKUPS = 1000000;
+
+		// ------------------------------------------------------
+		// the previous SpriteSheet::findIndex - walks all
+		// entries comparing the hashes
+		// ------------------------------------------------------
+		static int linearFind(const std::vector<StaticHash>& hashes, const StaticHash& sid) {
+			for (size_t i = 0; i < hashes.size(); ++i) {
+				if (hashes[i] == sid) {
+					return (int)i;
+				}
+			}
+			return -1;
+		}
+
+		void spriteSheet() {
+			std::vector<std::string> names(SHEET_ENTRIES);
+			std::vector<StaticHash> hashes(SHEET_ENTRIES);
+			char buffer[32];
+			for (uint32_t i = 0; i < SHEET_ENTRIES; ++i) {
+				sprintf_s(buffer, 32, "hud_sprite_%u", i);
+				names[i] = buffer;
+				hashes[i] = SID(buffer);
+			}
+			Timer timer;
+			SpriteSheet sheet("bench_sheet");
+			for (uint32_t i = 0; i < SHEET_ENTRIES; ++i) {
+				sheet.add(names[i].c_str(), Rect((float)(i / 32 * 16), (float)(i % 32 * 16), 16.0f, 16.0f));
+			}
+			printf("add %u entries              : %8.3f ms\n", SHEET_ENTRIES, timer.ms());
+
+			// random names like a HUD touching many sprites per frame
+			std::vector<uint32_t> order(SHEET_LOOKUPS);
+			srand(29);
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				order[i] = rand() % SHEET_ENTRIES;
+			}
+			uint32_t sum = 0;
+			timer.reset();
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				sum += linearFind(hashes, SID(names[order[i]].c_str()));
+			}
+			double linearName = timer.ms();
+			timer.reset();
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				sum += linearFind(hashes, hashes[order[i]]);
+			}
+			double linearHash = timer.ms();
+			timer.reset();
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				sum += sheet.findIndex(names[order[i]].c_str());
+			}
+			double indexName = timer.ms();
+			timer.reset();
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				sum += sheet.findIndex(hashes[order[i]]);
+			}
+			double indexHash = timer.ms();
+			// handles are resolved once at load
+			std::vector<int> handles(SHEET_ENTRIES);
+			for (uint32_t i = 0; i < SHEET_ENTRIES; ++i) {
+				handles[i] = sheet.findIndex(hashes[i]);
+			}
+			timer.reset();
+			for (uint32_t i = 0; i < SHEET_LOOKUPS; ++i) {
+				sum += (uint32_t)sheet.get(handles[order[i]]).rect.left;
+			}
+			double handle = timer.ms();
+			sink += sum;
+
+			double scale = 1000000.0 / SHEET_LOOKUPS;
+			printf("%u lookups (ns per lookup)\n", SHEET_LOOKUPS);
+			printf("linear scan by name          : %8.1f\n", linearName * scale);
+			printf("linear scan by hash          : %8.1f\n", linearHash * scale);
+			printf("hash index by name           : %8.1f\n", indexName * scale);
+			printf("hash index by hash           : %8.1f\n", indexHash * scale);
+			printf("handle                       : %8.1f\n", handle * scale);
+
+			for (uint32_t i = 0; i < SHEET_ENTRIES; ++i) {
+				check(sheet.findIndex(hashes[i]) == linearFind(hashes, hashes[i]), "SpriteSheet index of '%s' differs from the linear scan", names[i].c_str());
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,152 @@
+#include "Benchmarks.h"
+#include "..\..\renderer\VertexPacking.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		const uint32_t PACKING_VERTICES = 1000000;
+		const uint32_t PACKING_RUNS = 10;
+		const float PACKING_WORLD_SIZE = 1000.0f;
+
+		// ------------------------------------------------------
+		// error bounds of the packed format
+		//   position : half float - relative 2^-11 plus the
+		//              smallest subnormal step
+		//   normal   : octahedron snorm16 - distance between the
+		//              unit vectors
+		//   texture  : unorm16 - half a step
+		//   color    : RGBA8 - half a step
+		// ------------------------------------------------------
+		const double PACKING_POSITION_RELATIVE = 1.0 / 2048.0;
+		const double PACKING_POSITION_ABSOLUTE = 1.0 / 16777216.0;
+		const double PACKING_NORMAL_ERROR = 1e-4;
+		const double PACKING_TEXTURE_ERROR = 0.5 / 65535.0 + 1e-7;
+		const double PACKING_COLOR_ERROR = 0.5 / 255.0 + 1e-6;
+
+		struct PackingError {
+			double position;
+			double normal;
+			double texture;
+			double color;
+		};
+
+		static float randomFloat(float min, float max) {
+			return min + (max - min) * (float)rand() / (float)RAND_MAX;
+		}
+
+		static v3 randomNormal() {
+			for (;;) {
+				v3 n(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f));
+				float l = length(n);
+				if (l > 0.01f && l <= 1.0f) {
+					return n * (1.0f / l);
+				}
+			}
+		}
+
+		static void createVertices(std::vector<PNTCVertex>& vertices) {
+			// the axes and the diagonals hit the edges of the octahedron
+			const v3 special[] = {
+				v3(1.0f, 0.0f, 0.0f), v3(-1.0f, 0.0f, 0.0f), v3(0.0f, 1.0f, 0.0f), v3(0.0f, -1.0f, 0.0f),
+				v3(0.0f, 0.0f, 1.0f), v3(0.0f, 0.0f, -1.0f), normalize(v3(1.0f, 1.0f, -1.0f)), normalize(v3(-1.0f, -1.0f, -1.0f))
+			};
+			const uint32_t numSpecial = sizeof(special) / sizeof(special[0]);
+			for (uint32_t i = 0; i < PACKING_VERTICES; ++i) {
+				PNTCVertex& v = vertices[i];
+				float scale = i % 4 == 0 ? 0.001f : PACKING_WORLD_SIZE;
+				v.position = v3(randomFloat(-scale, scale), randomFloat(-scale, scale), randomFloat(-scale, scale));
+				v.normal = i < numSpecial ? special[i] : randomNormal();
+				v.texture = v2(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f));
+				v.color = Color(randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f), randomFloat(0.0f, 1.0f));
+			}
+		}
+
+		static void maxError(double* current, double e) {
+			if (e > *current) {
+				*current = e;
+			}
+		}
+
+		// ------------------------------------------------------
+		// the largest errors - the position error is relative
+		// to the bound of every component
+		// ------------------------------------------------------
+		static PackingError measure(const std::vector<PNTCVertex>& src, const std::vector<PNTCVertex>& dest) {
+			PackingError r = { 0.0, 0.0, 0.0, 0.0 };
+			for (size_t i = 0; i < src.size(); ++i) {
+				const PNTCVertex& s = src[i];
+				const PNTCVertex& d = dest[i];
+				double nd = 0.0;
+				for (int k = 0; k < 3; ++k) {
+					double bound = fabs(s.position.data[k]) * PACKING_POSITION_RELATIVE + PACKING_POSITION_ABSOLUTE;
+					maxError(&r.position, fabs((double)s.position.data[k] - d.position.data[k]) / bound);
+					double dn = (double)s.normal.data[k] - d.normal.data[k];
+					nd += dn * dn;
+				}
+				maxError(&r.normal, sqrt(nd));
+				maxError(&r.texture, fabs((double)s.texture.x - d.texture.x));
+				maxError(&r.texture, fabs((double)s.texture.y - d.texture.y));
+				maxError(&r.color, fabs((double)s.color.r - d.color.r));
+				maxError(&r.color, fabs((double)s.color.g - d.color.g));
+				maxError(&r.color, fabs((double)s.color.b - d.color.b));
+				maxError(&r.color, fabs((double)s.color.a - d.color.a));
+			}
+			return r;
+		}
+
+		void vertexPacking() {
+			std::vector<PNTCVertex> vertices(PACKING_VERTICES);
+			std::vector<PNTCVertex> copied(PACKING_VERTICES);
+			std::vector<PNTCVertex> unpacked(PACKING_VERTICES);
+			std::vector<PackedVertex> packed(PACKING_VERTICES);
+			srand(43);
+			createVertices(vertices);
+
+			double times[3] = { 0.0 };
+			Timer timer;
+			for (uint32_t r = 0; r < PACKING_RUNS; ++r) {
+				timer.reset();
+				memcpy(&copied[0], &vertices[0], PACKING_VERTICES * sizeof(PNTCVertex));
+				times[0] += timer.ms();
+				timer.reset();
+				vertex::pack(&vertices[0], &packed[0], PACKING_VERTICES);
+				times[1] += timer.ms();
+				timer.reset();
+				vertex::unpack(&packed[0], &unpacked[0], PACKING_VERTICES);
+				times[2] += timer.ms();
+				sink += packed[r].color + (uint32_t)copied[r].position.x;
+			}
+			printf("%u vertices, %u and %u bytes per vertex (ms)\n", PACKING_VERTICES, (uint32_t)sizeof(PNTCVertex), (uint32_t)sizeof(PackedVertex));
+			printf("memcpy of PNTCVertex         : %8.3f\n", times[0] / PACKING_RUNS);
+			printf("vertex::pack                 : %8.3f\n", times[1] / PACKING_RUNS);
+			printf("vertex::unpack               : %8.3f\n", times[2] / PACKING_RUNS);
+
+			PackingError e = measure(vertices, unpacked);
+			printf("\nlargest error\n");
+			printf("position (of the bound)      : %8.3f\n", e.position);
+			printf("normal                       : %8.6f\n", e.normal);
+			printf("texture                      : %8.6f\n", e.texture);
+			printf("color                        : %8.6f\n", e.color);
+			check(e.position <= 1.0, "the position error is %g times the half float bound", e.position);
+			check(e.normal <= PACKING_NORMAL_ERROR, "the normal error %g is larger than %g", e.normal, PACKING_NORMAL_ERROR);
+			check(e.texture <= PACKING_TEXTURE_ERROR, "the texture error %g is larger than %g", e.texture, PACKING_TEXTURE_ERROR);
+			check(e.color <= PACKING_COLOR_ERROR, "the color error %g is larger than %g", e.color, PACKING_COLOR_ERROR);
+
+			// texture coordinates outside of 0..1 are clamped
+			PNTCVertex outside(v3(0.0f, 0.0f, 0.0f), v3(0.0f, 1.0f, 0.0f), v2(-0.5f, 1.5f), Color(1.0f, 1.0f, 1.0f, 1.0f));
+			PackedVertex p;
+			PNTCVertex back;
+			vertex::pack(&outside, &p, 1);
+			vertex::unpack(&p, &back, 1);
+			check(back.texture.x == 0.0f && back.texture.y == 1.0f, "texture (-0.5, 1.5) is unpacked as (%g, %g)", back.texture.x, back.texture.y);
+		}
+
+	}
+
+}
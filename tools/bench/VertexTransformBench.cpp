@@ -0,0 +1,117 @@
+#include "Benchmarks.h"
+#include "..\..\renderer\VertexTransform.h"
+#include "..\..\renderer\Transform.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+namespace ds {
+
+	namespace bench {
+
+		// 41k cubes of 24 vertices - about 1M vertices
+		const uint32_t TRANSFORM_CUBES = 41667;
+		const uint32_t TRANSFORM_RUNS = 20;
+
+		static void addCube(const v3& center, std::vector<PNTCVertex>& vertices) {
+			const v3 p[] = {
+				v3(-0.5f, 0.5f, 0.5f), v3(0.5f, 0.5f, 0.5f), v3(0.5f, 0.5f, -0.5f), v3(-0.5f, 0.5f, -0.5f),
+				v3(-0.5f, -0.5f, 0.5f), v3(0.5f, -0.5f, 0.5f), v3(0.5f, -0.5f, -0.5f), v3(-0.5f, -0.5f, -0.5f)
+			};
+			const int indices[] = { 3, 2, 6, 7, 2, 1, 5, 6, 1, 0, 4, 5, 0, 3, 7, 4, 0, 1, 2, 3, 5, 4, 7, 6 };
+			const v2 uv[] = { v2(0.0f, 0.0f), v2(1.0f, 0.0f), v2(1.0f, 1.0f), v2(0.0f, 1.0f) };
+			for (int j = 0; j < 6; ++j) {
+				const int* f = indices + j * 4;
+				v3 n = normalize(cross(p[f[1]] - p[f[0]], p[f[2]] - p[f[0]]));
+				for (int i = 0; i < 4; ++i) {
+					vertices.push_back(PNTCVertex(p[f[i]] + center, n, uv[i], Color(0.5f, 0.75f, 1.0f, 1.0f)));
+				}
+			}
+		}
+
+		// ------------------------------------------------------
+		// the previous MeshBuffer::add(Mesh*, const mat4&, ...)
+		// one vertex at a time and a cross product per quad
+		// ------------------------------------------------------
+		static void transformScalar(const mat4& world, const PNTCVertex* src, PNTCVertex* dest, uint32_t num, const Color& color) {
+			uint32_t cnt = num / 4;
+			v3 p[4];
+			for (uint32_t i = 0; i < cnt; ++i) {
+				for (int j = 0; j < 4; ++j) {
+					p[j] = world * src[i * 4 + j].position;
+				}
+				v3 n = normalize(cross(p[1] - p[0], p[2] - p[0]));
+				for (int j = 0; j < 4; ++j) {
+					const PNTCVertex& v = src[i * 4 + j];
+					dest[i * 4 + j] = PNTCVertex(p[j], n, v.texture, v.color * color);
+				}
+			}
+		}
+
+		void vertexTransform() {
+			std::vector<PNTCVertex> vertices;
+			vertices.reserve(TRANSFORM_CUBES * 24);
+			for (uint32_t i = 0; i < TRANSFORM_CUBES; ++i) {
+				addCube(v3((float)(i % 64) * 2.0f, (float)(i / 4096) * 2.0f, (float)(i / 64 % 64) * 2.0f), vertices);
+			}
+			uint32_t num = (uint32_t)vertices.size();
+			// rotation and non uniform scale
+			mat4 world = transform::buildWorld(v3(10.0f, -5.0f, 3.0f), v3(1.0f, 2.5f, 0.5f), v3(0.3f, 1.1f, -0.4f));
+			Color color(1.0f, 0.5f, 0.5f, 1.0f);
+			std::vector<PNTCVertex> scalar(num);
+			std::vector<PNTCVertex> simd(num);
+			std::vector<v3> positions(num);
+			std::vector<v3> transformed(num);
+			for (uint32_t i = 0; i < num; ++i) {
+				positions[i] = vertices[i].position;
+			}
+
+			double times[4] = { 0.0 };
+			Timer timer;
+			for (uint32_t r = 0; r < TRANSFORM_RUNS; ++r) {
+				timer.reset();
+				transformScalar(world, &vertices[0], &scalar[0], num, color);
+				times[0] += timer.ms();
+				timer.reset();
+				vertex::transform(world, &vertices[0], &simd[0], num, &color);
+				times[1] += timer.ms();
+				timer.reset();
+				for (uint32_t i = 0; i < num; ++i) {
+					transformed[i] = world * positions[i];
+				}
+				times[2] += timer.ms();
+				timer.reset();
+				vertex::transformPositions(world, &positions[0], &transformed[0], num);
+				times[3] += timer.ms();
+			}
+			const char* names[] = { "PNTCVertex scalar", "PNTCVertex vertex::transform", "positions scalar", "positions vertex::transformPositions" };
+			printf("%u vertices (ms per run / million vertices per second)\n", num);
+			for (int i = 0; i < 4; ++i) {
+				double ms = times[i] / TRANSFORM_RUNS;
+				printf("%-38s : %8.3f / %7.1f\n", names[i], ms, num / ms / 1000.0);
+			}
+
+			// positions must match and the transformed normals must be
+			// the face normals the old code computed
+			float positionError = 0.0f;
+			float normalError = 0.0f;
+			for (uint32_t i = 0; i < num; ++i) {
+				v3 d = simd[i].position - scalar[i].position;
+				float pe = length(d) / (1.0f + length(scalar[i].position));
+				if (pe > positionError) {
+					positionError = pe;
+				}
+				float ne = 1.0f - dot(simd[i].normal, scalar[i].normal);
+				if (ne > normalError) {
+					normalError = ne;
+				}
+			}
+			printf("\nlargest position error %g - largest normal error (1 - cos) %g\n", positionError, normalError);
+			check(positionError < 1e-5f, "positions differ by %g", positionError);
+			check(normalError < 1e-4f, "normals differ by %g", normalError);
+			check(simd[num - 1].color == scalar[num - 1].color, "vertex colors differ");
+		}
+
+	}
+
+}
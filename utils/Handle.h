@@ -0,0 +1,43 @@
+#pragma once
+#include <stdint.h>
+
+namespace ds {
+
+	// -------------------------------------------------------
+	// 32 bit handle encoding the slot index in the lower bits
+	// and a generation counter in the upper bits. Every time
+	// a slot is freed the generation is increased so that
+	// stale handles can be detected with a single compare.
+	// The generation has only 32 - INDEX_BITS = 10 bits and
+	// wraps around. A handle that is kept while its slot is
+	// reused 1024 times matches the slot again.
+	// -------------------------------------------------------
+	namespace handle {
+
+		const uint32_t INDEX_BITS = 22;
+		const uint32_t MAX_INDEX = (1u << INDEX_BITS) - 1;
+		const uint32_t INDEX_MASK = MAX_INDEX;
+		const uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+		// marks a slot without data
+		const uint32_t INVALID_INDEX = UINT32_MAX;
+
+		inline uint32_t make(uint32_t index, uint32_t generation) {
+			return ((generation & GENERATION_MASK) << INDEX_BITS) | (index & INDEX_MASK);
+		}
+
+		inline uint32_t index(uint32_t h) {
+			return h & INDEX_MASK;
+		}
+
+		inline uint32_t generation(uint32_t h) {
+			return h >> INDEX_BITS;
+		}
+
+		// returns the handle of the same slot with the next generation
+		inline uint32_t next(uint32_t h) {
+			return make(index(h), generation(h) + 1);
+		}
+
+	}
+
+}
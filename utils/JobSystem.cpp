@@ -0,0 +1,177 @@
+#include "JobSystem.h"
+#include "core\log\Log.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+namespace ds {
+
+	namespace jobs {
+
+		const uint32_t MAX_WORKERS = 31;
+
+		struct JobContext {
+			std::vector<std::thread> workers;
+			std::mutex mutex;
+			std::condition_variable wakeUp;
+			std::condition_variable finished;
+			// serializes calls of parallelFor from different threads
+			std::mutex callMutex;
+			RangeFunction fn;
+			void* data;
+			uint32_t num;
+			uint32_t chunkSize;
+			uint32_t numChunks;
+			std::atomic<uint32_t> nextChunk;
+			std::atomic<uint32_t> doneChunks;
+			// increased for every parallelFor so workers can tell a new job
+			uint32_t generation;
+			uint32_t running;
+			bool quit;
+		};
+
+		static JobContext* _jobCtx = 0;
+
+		// set while a thread runs chunks - a nested parallelFor would
+		// wait for callMutex which the outer call holds
+		static thread_local bool _insideJob = false;
+
+		// ------------------------------------------------------
+		// pulls chunks until there are none left
+		// ------------------------------------------------------
+		static void processChunks(JobContext* ctx) {
+			uint32_t done = 0;
+			_insideJob = true;
+			for (;;) {
+				uint32_t chunk = ctx->nextChunk.fetch_add(1);
+				if (chunk >= ctx->numChunks) {
+					break;
+				}
+				uint32_t start = chunk * ctx->chunkSize;
+				uint32_t end = start + ctx->chunkSize;
+				if (end > ctx->num) {
+					end = ctx->num;
+				}
+				ctx->fn(start, end, ctx->data);
+				++done;
+			}
+			_insideJob = false;
+			if (done > 0 && ctx->doneChunks.fetch_add(done) + done == ctx->numChunks) {
+				std::lock_guard<std::mutex> lock(ctx->mutex);
+				ctx->finished.notify_all();
+			}
+		}
+
+		static void workerLoop(JobContext* ctx) {
+			uint32_t seen = 0;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(ctx->mutex);
+					ctx->wakeUp.wait(lock, [ctx, seen] { return ctx->quit || ctx->generation != seen; });
+					if (ctx->quit) {
+						return;
+					}
+					seen = ctx->generation;
+					++ctx->running;
+				}
+				processChunks(ctx);
+				{
+					std::lock_guard<std::mutex> lock(ctx->mutex);
+					--ctx->running;
+					ctx->finished.notify_all();
+				}
+			}
+		}
+
+		void initialize(uint32_t numWorkers) {
+			if (_jobCtx != 0) {
+				return;
+			}
+			if (numWorkers == 0) {
+				uint32_t hw = std::thread::hardware_concurrency();
+				numWorkers = hw > 1 ? hw - 1 : 0;
+			}
+			if (numWorkers > MAX_WORKERS) {
+				numWorkers = MAX_WORKERS;
+			}
+			_jobCtx = new JobContext;
+			_jobCtx->fn = 0;
+			_jobCtx->data = 0;
+			_jobCtx->num = 0;
+			_jobCtx->chunkSize = 0;
+			_jobCtx->numChunks = 0;
+			_jobCtx->nextChunk = 0;
+			_jobCtx->doneChunks = 0;
+			_jobCtx->generation = 0;
+			_jobCtx->running = 0;
+			_jobCtx->quit = false;
+			for (uint32_t i = 0; i < numWorkers; ++i) {
+				_jobCtx->workers.push_back(std::thread(workerLoop, _jobCtx));
+			}
+			LOG << "job system - workers: " << numWorkers;
+		}
+
+		void shutdown() {
+			if (_jobCtx == 0) {
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(_jobCtx->mutex);
+				_jobCtx->quit = true;
+			}
+			_jobCtx->wakeUp.notify_all();
+			for (size_t i = 0; i < _jobCtx->workers.size(); ++i) {
+				_jobCtx->workers[i].join();
+			}
+			delete _jobCtx;
+			_jobCtx = 0;
+		}
+
+		uint32_t numWorkers() {
+			return _jobCtx != 0 ? (uint32_t)_jobCtx->workers.size() : 0;
+		}
+
+		// ------------------------------------------------------
+		// parallel for - small loops and calls from inside a
+		// job run inline
+		// ------------------------------------------------------
+		void parallelFor(uint32_t num, uint32_t chunkSize, RangeFunction fn, void* data) {
+			if (num == 0) {
+				return;
+			}
+			if (chunkSize == 0) {
+				chunkSize = 1;
+			}
+			if (_jobCtx == 0 || _jobCtx->workers.empty() || num <= chunkSize || _insideJob) {
+				for (uint32_t start = 0; start < num; start += chunkSize) {
+					uint32_t end = start + chunkSize;
+					fn(start, end > num ? num : end, data);
+				}
+				return;
+			}
+			JobContext* ctx = _jobCtx;
+			std::lock_guard<std::mutex> call(ctx->callMutex);
+			{
+				std::unique_lock<std::mutex> lock(ctx->mutex);
+				// workers of the previous job may still be leaving processChunks
+				ctx->finished.wait(lock, [ctx] { return ctx->running == 0; });
+				ctx->fn = fn;
+				ctx->data = data;
+				ctx->num = num;
+				ctx->chunkSize = chunkSize;
+				ctx->numChunks = (num + chunkSize - 1) / chunkSize;
+				ctx->nextChunk = 0;
+				ctx->doneChunks = 0;
+				++ctx->generation;
+			}
+			ctx->wakeUp.notify_all();
+			processChunks(ctx);
+			std::unique_lock<std::mutex> lock(ctx->mutex);
+			ctx->finished.wait(lock, [ctx] { return ctx->doneChunks == ctx->numChunks; });
+		}
+
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+
+namespace ds {
+
+	// -------------------------------------------------------
+	// Small worker pool for data parallel loops. The calling
+	// thread takes part in the work and parallelFor returns
+	// once all chunks are done. Without initialize (or with
+	// zero workers) everything runs on the calling thread.
+	// -------------------------------------------------------
+	namespace jobs {
+
+		typedef void(*RangeFunction)(uint32_t start, uint32_t end, void* data);
+
+		// 0 = one worker less than hardware threads
+		void initialize(uint32_t numWorkers = 0);
+
+		void shutdown();
+
+		uint32_t numWorkers();
+
+		// splits [0,num) into chunks of chunkSize and calls fn for every chunk.
+		// A parallelFor called from inside fn runs on the calling thread.
+		void parallelFor(uint32_t num, uint32_t chunkSize, RangeFunction fn, void* data);
+
+		template<class F>
+		void invokeRange(uint32_t start, uint32_t end, void* data) {
+			(*(F*)data)(start, end);
+		}
+
+		// fn(start, end) - lambdas may capture by reference since the call blocks
+		template<class F>
+		void parallelFor(uint32_t num, uint32_t chunkSize, F& fn) {
+			parallelFor(num, chunkSize, invokeRange<F>, &fn);
+		}
+
+	}
+
+}
@@ -1,317 +1,664 @@
 #include "ObjLoader.h"
-#include <fstream>
+#include <string.h>
+#include <math.h>
 #include <vector>
-#include "core\log\Log.h"
-#include "core\io\json.h"
 #include <map>
+#include <sys\types.h>
+#include <sys\stat.h>
+#include "core\log\Log.h"
+#include "core\profiler\Profiler.h"
 #include "..\renderer\VertexTypes.h"
 #include "core\string\StaticHash.h"
+#include "JobSystem.h"
 
 namespace ds {
-	
-	namespace obj {
-
-		struct VertexDefinition {
 
-			int vertexIndex;
-			int normalIndex;
-			int uvIndex;
-			Color color;
-
-			VertexDefinition() : vertexIndex(-1), normalIndex(-1), uvIndex(-1), color(Color::WHITE) {}
-		};
+	namespace obj {
 
 		struct Material {
 			float specularPower;
 			Color ambient;
 			Color diffuse;
 			Color specular;
-			int index;
+
+			Material() : specularPower(0.0f), ambient(Color::WHITE), diffuse(Color::WHITE), specular(Color::WHITE) {}
 		};
 
 		typedef std::map<StaticHash, Material> Materials;
-		typedef Array<Vector3f> VectorCache;
-		typedef Array<VertexDefinition> Faces;
-		typedef Array<Vector2f> UVCache;
 
-		int get(Tokenizer& tokenizer, int current, v2* ret) {
-			int cnt = current;
-			++cnt;
-			Token& t = tokenizer.get(cnt);
-			ret->x = t.value;
-			++cnt;
-			t = tokenizer.get(cnt);
-			while (t.type != Token::NUMBER) {
-				++cnt;
-				t = tokenizer.get(cnt);
-			}
-			ret->y = t.value;
-			return cnt;
+		// ------------------------------------------------------
+		// one corner of a face - 0 based indices for position,
+		// uv and normal. Relative (negative) indices are stored
+		// as index into the data of the chunk.
+		// ------------------------------------------------------
+		struct Corner {
+			int index[3];
+			// bit 0 - 2 = present / bit 3 - 5 = relative to the chunk
+			uint32_t flags;
+		};
+
+		struct MaterialRun {
+			uint32_t firstFace;
+			StaticHash hash;
+			const Material* material;
+		};
+
+		// ------------------------------------------------------
+		// A range of whole lines. The chunks are parsed in
+		// parallel and use std::vector since the allocator of
+		// the engine is not thread safe.
+		// ------------------------------------------------------
+		struct ObjChunk {
+			const char* start;
+			const char* end;
+			std::vector<v3> positions;
+			std::vector<v3> normals;
+			std::vector<v2> uvs;
+			std::vector<Corner> corners;
+			// first corner of every face
+			std::vector<uint32_t> faces;
+			std::vector<MaterialRun> materials;
+			uint32_t numQuads;
+			char materialFile[128];
+			// filled in after parsing
+			uint32_t base[3];
+			uint32_t firstVertex;
+			const Material* inherited;
+			uint32_t invalid;
+		};
+
+		// ------------------------------------------------------
+		// 64 bit hash of the file content - one xxhash round
+		// per 8 bytes
+		// ------------------------------------------------------
+		static uint64_t rotl(uint64_t v, int r) {
+			return (v << r) | (v >> (64 - r));
+		}
+
+		static uint64_t hashData(const char* data, uint64_t size) {
+			const uint64_t P1 = 11400714785074694791ULL;
+			const uint64_t P2 = 14029467366897019727ULL;
+			uint64_t h = size * P1;
+			uint64_t i = 0;
+			for (; i + 8 <= size; i += 8) {
+				uint64_t w;
+				memcpy(&w, data + i, 8);
+				h = rotl(h + w * P2, 31) * P1;
+			}
+			for (; i < size; ++i) {
+				h = rotl(h ^ ((uint8_t)data[i] * P1), 11) * P2;
+			}
+			h ^= h >> 33;
+			h *= P2;
+			h ^= h >> 29;
+			return h;
+		}
+
+		static bool getFileInfo(const char* fileName, uint64_t* time, uint64_t* size) {
+			struct _stat64 st;
+			if (_stat64(fileName, &st) != 0) {
+				return false;
+			}
+			*time = (uint64_t)st.st_mtime;
+			*size = (uint64_t)st.st_size;
+			return true;
 		}
 
-		int get(Tokenizer& tokenizer, int current, v3* ret) {
-			int cnt = current;
-			++cnt;
-			Token& t = tokenizer.get(cnt);
-			ret->x = t.value;
-			++cnt;
-			t = tokenizer.get(cnt);
-			while (t.type != Token::NUMBER) {
-				++cnt;
-				t = tokenizer.get(cnt);
-			}
-			ret->y = t.value;
-			++cnt;
-			t = tokenizer.get(cnt);
-			while (t.type != Token::NUMBER) {
-				++cnt;
-				t = tokenizer.get(cnt);
-			}
-			ret->z = t.value;
-			return cnt;
+		// ------------------------------------------------------
+		// reads the entire file - the buffer is 0 terminated
+		// ------------------------------------------------------
+		static char* readFile(const char* fileName, uint32_t* size) {
+			FILE* fp = fopen(fileName, "rb");
+			if (fp == 0) {
+				return 0;
+			}
+			fseek(fp, 0, SEEK_END);
+			uint32_t sz = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+			char* buffer = new char[sz + 1];
+			*size = fread(buffer, 1, sz, fp);
+			buffer[*size] = '\0';
+			fclose(fp);
+			return buffer;
 		}
 
-		void readColor(const std::string& line, Color* color) {
-			std::string dummy;
-			std::istringstream iss(line);
-			iss >> dummy >> color->r >> color->g >> color->b;
-			color->a = 1.0f;
+		static bool hashFile(const char* fileName, uint64_t* hash) {
+			uint32_t size = 0;
+			char* buffer = readFile(fileName, &size);
+			if (buffer == 0) {
+				return false;
+			}
+			*hash = hashData(buffer, size);
+			delete[] buffer;
+			return true;
+		}
+
+		// ------------------------------------------------------
+		// scanning - every function stops at the end of the line
+		// ------------------------------------------------------
+		static const char* skipSpaces(const char* p) {
+			while (*p == ' ' || *p == '\t') {
+				++p;
+			}
+			return p;
+		}
+
+		static const char* nextLine(const char* p) {
+			while (*p != '\n' && *p != '\0') {
+				++p;
+			}
+			return *p == '\n' ? p + 1 : p;
 		}
 
-		int readInt(const std::string& line) {
-			std::string dummy;
-			std::istringstream iss(line);
+		// keyword followed by a space or tab
+		static bool isKeyword(const char* p, const char* keyword, int len) {
+			return strncmp(p, keyword, len) == 0 && (p[len] == ' ' || p[len] == '\t');
+		}
+
+		static const double POW10[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		// ------------------------------------------------------
+		// parse float - up to 19 significant digits are used
+		// ------------------------------------------------------
+		static const char* parseFloat(const char* p, float* ret) {
+			p = skipSpaces(p);
+			bool negative = false;
+			if (*p == '-') {
+				negative = true;
+				++p;
+			}
+			else if (*p == '+') {
+				++p;
+			}
+			uint64_t mantissa = 0;
+			int digits = 0;
+			int exponent = 0;
+			while (*p >= '0' && *p <= '9') {
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (*p - '0');
+					digits += mantissa != 0;
+				}
+				else {
+					++exponent;
+				}
+				++p;
+			}
+			if (*p == '.') {
+				++p;
+				while (*p >= '0' && *p <= '9') {
+					if (digits < 19) {
+						mantissa = mantissa * 10 + (*p - '0');
+						digits += mantissa != 0;
+						--exponent;
+					}
+					++p;
+				}
+			}
+			if (*p == 'e' || *p == 'E') {
+				++p;
+				bool negativeExp = false;
+				if (*p == '-') {
+					negativeExp = true;
+					++p;
+				}
+				else if (*p == '+') {
+					++p;
+				}
+				int e = 0;
+				while (*p >= '0' && *p <= '9') {
+					if (e < 1000) {
+						e = e * 10 + (*p - '0');
+					}
+					++p;
+				}
+				exponent += negativeExp ? -e : e;
+			}
+			double v = (double)mantissa;
+			if (mantissa != 0) {
+				while (exponent > 22) {
+					v *= 1e22;
+					exponent -= 22;
+				}
+				while (exponent < -22) {
+					v /= 1e22;
+					exponent += 22;
+				}
+				v = exponent < 0 ? v / POW10[-exponent] : v * POW10[exponent];
+			}
+			*ret = (float)(negative ? -v : v);
+			return p;
+		}
+
+		static const char* parseInt(const char* p, int* ret) {
+			bool negative = false;
+			if (*p == '-') {
+				negative = true;
+				++p;
+			}
 			int v = 0;
-			iss >> dummy >> v;
-			return v;
+			while (*p >= '0' && *p <= '9') {
+				v = v * 10 + (*p - '0');
+				++p;
+			}
+			*ret = negative ? -v : v;
+			return p;
 		}
 
-		float readFloat(const std::string& line) {
-			std::string dummy;
-			std::istringstream iss(line);
-			float v = 0.0f;
-			iss >> dummy >> v;
-			return v;
+		// copies the next word
+		static void readName(const char* p, char* dest, int max) {
+			p = skipSpaces(p);
+			int len = 0;
+			while (len < max - 1 && *p != '\0' && *p != '\n' && *p != '\r' && *p != ' ' && *p != '\t') {
+				dest[len++] = *p++;
+			}
+			dest[len] = '\0';
 		}
 
-		std::string readString(const std::string& line) {
-			std::string dummy;
-			std::istringstream iss(line);
-			iss >> dummy >> dummy;
-			return dummy;
+		static const char* readColor(const char* p, Color* color) {
+			p = parseFloat(p, &color->r);
+			p = parseFloat(p, &color->g);
+			p = parseFloat(p, &color->b);
+			color->a = 1.0f;
+			return p;
 		}
 
-		void readMaterials(const char* mtlFileName, Materials& m_Materials) {
-			std::ifstream InFile(mtlFileName);
+		// ------------------------------------------------------
+		// read materials
+		// ------------------------------------------------------
+		static void readMaterials(const char* mtlFileName, Materials& materials) {
+			uint32_t size = 0;
+			char* buffer = readFile(mtlFileName, &size);
+			if (buffer == 0) {
+				LOGE << "Cannot read material file '" << mtlFileName << "'";
+				return;
+			}
 			LOG << "reading material file: " << mtlFileName;
-			std::string line;
 			Material* m = 0;
-			while (std::getline(InFile, line)) {
-				if (line.find("newmtl") != std::string::npos) {
-					std::istringstream iss(line);
-					std::string name;
-					iss >> name >> name;
-					LOG << "new mtl: " << name;
-					Material mtl;
-					StaticHash hash(name.c_str());
-					m_Materials[hash] = mtl;
-					m = &m_Materials[hash];
+			const char* p = buffer;
+			while (*p != '\0') {
+				p = skipSpaces(p);
+				if (isKeyword(p, "newmtl", 6)) {
+					char name[128];
+					readName(p + 6, name, 128);
+					m = &materials[StaticHash(name)];
+					*m = Material();
+				}
+				else if (m != 0) {
+					if (isKeyword(p, "Ka", 2)) {
+						readColor(p + 2, &m->ambient);
+					}
+					else if (isKeyword(p, "Kd", 2)) {
+						readColor(p + 2, &m->diffuse);
+					}
+					else if (isKeyword(p, "Ks", 2)) {
+						readColor(p + 2, &m->specular);
+					}
+					else if (isKeyword(p, "Ns", 2)) {
+						parseFloat(p + 2, &m->specularPower);
+					}
+				}
+				p = nextLine(p);
+			}
+			delete[] buffer;
+			LOG << "number of materials: " << materials.size();
+		}
+
+		// ------------------------------------------------------
+		// parse face - "v", "v/t", "v//n" or "v/t/n" per corner
+		// ------------------------------------------------------
+		static void parseFace(ObjChunk& chunk, const char* p) {
+			uint32_t first = chunk.corners.size();
+			int counts[3] = { (int)chunk.positions.size(), (int)chunk.uvs.size(), (int)chunk.normals.size() };
+			for (;;) {
+				p = skipSpaces(p);
+				if (!(*p == '-' || (*p >= '0' && *p <= '9'))) {
+					break;
+				}
+				int values[3] = { 0, 0, 0 };
+				p = parseInt(p, &values[0]);
+				if (*p == '/') {
+					++p;
+					if (*p != '/') {
+						p = parseInt(p, &values[1]);
+					}
+					if (*p == '/') {
+						++p;
+						p = parseInt(p, &values[2]);
+					}
+				}
+				Corner c;
+				c.flags = 0;
+				for (int k = 0; k < 3; ++k) {
+					c.index[k] = 0;
+					if (values[k] > 0) {
+						c.index[k] = values[k] - 1;
+						c.flags |= 1 << k;
+					}
+					else if (values[k] < 0) {
+						c.index[k] = counts[k] + values[k];
+						c.flags |= (1 << k) | (8 << k);
+					}
+				}
+				chunk.corners.push_back(c);
+			}
+			uint32_t num = chunk.corners.size() - first;
+			if (num < 3) {
+				chunk.corners.resize(first);
+				return;
+			}
+			chunk.faces.push_back(first);
+			// triangles are stored as quads with the last corner twice
+			chunk.numQuads += (num - 1) / 2;
+		}
+
+		// ------------------------------------------------------
+		// parse chunk - single pass over all lines
+		// ------------------------------------------------------
+		static void parseChunk(ObjChunk& chunk) {
+			const char* p = chunk.start;
+			while (p < chunk.end) {
+				p = skipSpaces(p);
+				if (*p == '\0') {
+					break;
 				}
-				else if (line.find("Ka") != std::string::npos) {
-					readColor(line, &m->ambient);
+				if (p[0] == 'v') {
+					if (p[1] == ' ' || p[1] == '\t') {
+						v3 v;
+						const char* c = parseFloat(p + 1, &v.x);
+						c = parseFloat(c, &v.y);
+						parseFloat(c, &v.z);
+						chunk.positions.push_back(v);
+					}
+					else if (p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+						v3 n;
+						const char* c = parseFloat(p + 2, &n.x);
+						c = parseFloat(c, &n.y);
+						parseFloat(c, &n.z);
+						chunk.normals.push_back(n);
+					}
+					else if (p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+						v2 t;
+						const char* c = parseFloat(p + 2, &t.x);
+						parseFloat(c, &t.y);
+						chunk.uvs.push_back(t);
+					}
 				}
-				else if (line.find("Kd") != std::string::npos) {
-					readColor(line, &m->diffuse);
-					LOG << "diffuse: " << m->diffuse;
+				else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+					parseFace(chunk, p + 1);
 				}
-				else if (line.find("Ks") != std::string::npos) {
-					readColor(line, &m->specular);
+				else if (isKeyword(p, "usemtl", 6)) {
+					char name[128];
+					readName(p + 6, name, 128);
+					MaterialRun run;
+					run.firstFace = chunk.faces.size();
+					run.hash = StaticHash(name);
+					run.material = 0;
+					chunk.materials.push_back(run);
 				}
-				else if (line.find("Ns") != std::string::npos) {
-					m->specularPower = readFloat(line);
+				else if (isKeyword(p, "mtllib", 6) && chunk.materialFile[0] == '\0') {
+					readName(p + 6, chunk.materialFile, 128);
 				}
+				p = nextLine(p);
 			}
-			LOG << "number of materials: " << m_Materials.size();
 		}
 
-		bool parse(const char* fileName, Mesh* mesh, const v3& offset, const v3& scale, const v3& rotation) {
-			int fileSize = -1;
-			char fullName[256];
-			sprintf_s(fullName, 256, "content\\objects\\%s", fileName);
-			FILE *fp = fopen(fullName, "rb");
-			if (fp) {
-				Materials m_Materials;
-				VectorCache m_Vertices;
-				VectorCache m_Normals;
-				UVCache m_UVCache;
-				Faces m_Faces;
-				LOG << "Loading '" << fileName << "'";
-				fseek(fp, 0, SEEK_END);
-				int sz = ftell(fp);
-				fseek(fp, 0, SEEK_SET);
-				LOG << "size: " << sz;
-				char* buffer = new char[sz + 1];
-				fread(buffer, 1, sz, fp);
-				buffer[sz] = '\0';
-				fclose(fp);
-				char name[128];
-				Tokenizer tokenizer;
-				tokenizer.parse(buffer, false);
-				LOG << "tokens: " << tokenizer.size();
-				int n = 0;
-				Material* m = 0;
-				bool hasNormals = false;
-				bool hasUV = false;
-				int x, y, z;
-				while (n < tokenizer.size()) {
-					Token& t = tokenizer.get(n);
-					if (t.type == Token::NAME) {
-						strncpy(name, buffer + t.index, t.size);
-						name[t.size] = '\0';
-						if (strcmp(name, "mtllib") == 0) {
-							++n;
-							t = tokenizer.get(n);
-							strncpy(name, buffer + t.index, t.size);
-							name[t.size] = '\0';
-							LOG << "material: " << name;
-							char full[256];
-							sprintf_s(full, "content\\objects\\%s.mtl", name);
-							readMaterials(full, m_Materials);
-						}
-						else if (strcmp(name, "usemtl") == 0) {
-							++n;
-							t = tokenizer.get(n);
-							strncpy(name, buffer + t.index, t.size);
-							name[t.size] = '\0';
-							StaticHash hash(name);
-							m = &m_Materials[hash];
-							LOG << "using material: " << name;
+		// ------------------------------------------------------
+		// resolve the index of a corner - returns -1 if it is
+		// missing or out of range
+		// ------------------------------------------------------
+		static int resolve(const ObjChunk& chunk, const Corner& c, int k, uint32_t total) {
+			if ((c.flags & (1 << k)) == 0) {
+				return -1;
+			}
+			int index = c.index[k];
+			if (c.flags & (8 << k)) {
+				index += (int)chunk.base[k];
+			}
+			return (index >= 0 && (uint32_t)index < total) ? index : -1;
+		}
+
+		struct ObjData {
+			std::vector<v3> positions;
+			std::vector<v3> normals;
+			std::vector<v2> uvs;
+		};
+
+		// ------------------------------------------------------
+		// build vertices - every face is split into quads
+		// (0, 1, 2, 3), (0, 3, 4, 5) ... and written in reverse
+		// order since z is flipped
+		// ------------------------------------------------------
+		static void buildVertices(ObjChunk& chunk, const ObjData& data, PNTCVertex* vertices) {
+			PNTCVertex* dest = vertices + chunk.firstVertex;
+			const Material* material = chunk.inherited;
+			uint32_t run = 0;
+			chunk.invalid = 0;
+			uint32_t sizes[3] = { (uint32_t)data.positions.size(), (uint32_t)data.uvs.size(), (uint32_t)data.normals.size() };
+			for (uint32_t f = 0; f < chunk.faces.size(); ++f) {
+				while (run < chunk.materials.size() && chunk.materials[run].firstFace <= f) {
+					material = chunk.materials[run].material;
+					++run;
+				}
+				Color color = material != 0 ? material->diffuse : Color::WHITE;
+				uint32_t first = chunk.faces[f];
+				uint32_t end = f + 1 < chunk.faces.size() ? chunk.faces[f + 1] : chunk.corners.size();
+				uint32_t num = end - first;
+				const Corner* corners = &chunk.corners[first];
+				PNTCVertex face[4];
+				int idx[4];
+				for (uint32_t q = 0; q < (num - 1) / 2; ++q) {
+					uint32_t last = 3 + q * 2;
+					uint32_t ci[4] = { 0, 1 + q * 2, 2 + q * 2, last < num ? last : num - 1 };
+					bool hasNormals = true;
+					for (int j = 0; j < 4; ++j) {
+						const Corner& c = corners[ci[j]];
+						PNTCVertex& v = face[j];
+						idx[j] = resolve(chunk, c, 0, sizes[0]);
+						if (idx[j] == -1) {
+							++chunk.invalid;
+							v.position = v3(0, 0, 0);
 						}
-						else if (strcmp(name, "vt") == 0) {
-							v2 vt;
-							++n;
-							t = tokenizer.get(n);
-							vt.x = t.value;
-							++n;
-							t = tokenizer.get(n);
-							vt.y = t.value;
-							m_UVCache.push_back(vt);
-							hasUV = true;
+						else {
+							v.position = data.positions[idx[j]];
 						}
-						else if (strcmp(name, "vn") == 0) {
-							v3 vn;
-							n = get(tokenizer, n, &vn);
-							m_Normals.push_back(vn);
-							hasNormals = true;
+						int t = resolve(chunk, c, 1, sizes[1]);
+						v.texture = t != -1 ? data.uvs[t] : v2(0, 0);
+						int n = resolve(chunk, c, 2, sizes[2]);
+						if (n != -1) {
+							v.normal = data.normals[n];
 						}
-						else if (strcmp(name, "v") == 0) {
-							v3 v;
-							++n;
-							t = tokenizer.get(n);
-							v.x = t.value;
-							++n;
-							t = tokenizer.get(n);
-							v.y = t.value;
-							++n;
-							t = tokenizer.get(n);
-							v.z = t.value;
-							m_Vertices.push_back(v);
+						else {
+							hasNormals = false;
 						}
-						else if (strcmp(name, "f") == 0) {
-							for (int i = 0; i < 4; ++i) {
-								x = -1;
-								y = -1;
-								z = -1;
-								if (hasNormals && hasUV) {
-									v3 tmp(-1, -1, -1);
-									n = get(tokenizer, n, &tmp);
-									x = tmp.x;
-									y = tmp.y;
-									z = tmp.z;
-								}
-								else if (hasNormals && !hasUV) {
-									v2 tmp(-1, -1);
-									n = get(tokenizer, n, &tmp);
-									x = tmp.x;
-									z = tmp.y;
-								}
-								else if (!hasNormals && hasUV) {
-									++n;
-									t = tokenizer.get(n);
-									x = t.value;
-									++n;
-									t = tokenizer.get(n);
-									z = t.value;
-								}
-								else {
-									++n;
-									t = tokenizer.get(n);
-									x = t.value;
-								}
-								VertexDefinition f;
-								f.vertexIndex = x;
-								f.normalIndex = z;
-								f.uvIndex = y;
-								//LOG << "f: " << x << " " << y << " " << z;
-								if (m != 0) {
-									f.color = m->diffuse;
-								}
-								else {
-									f.color = Color::WHITE;
-								}
-								m_Faces.push_back(f);
-							}
+						v.color = color;
+					}
+					if (!hasNormals) {
+						v3 n = cross(face[1].position - face[0].position, face[3].position - face[0].position);
+						float l = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+						n = l > 0.0f ? n * (1.0f / l) : v3(0, 1, 0);
+						for (int j = 0; j < 4; ++j) {
+							face[j].normal = n;
 						}
 					}
-					++n;
-					t = tokenizer.get(n);
-				}
-				delete[] buffer;
-				LOG << "vertex cache  : " << m_Vertices.size();
-				LOG << "normals cache : " << m_Normals.size();
-				LOG << "uv cache      : " << m_UVCache.size();
-				LOG << "faces         : " << m_Faces.size();
-				PNTCVertex b[4];
-				int count = m_Faces.size() / 4;
-				for (int i = 0; i < count; ++i) {
-					//LOG << "----------------------------------------";
 					for (int j = 0; j < 4; ++j) {
-						VertexDefinition& current = m_Faces[i * 4 + j];
-						if (current.vertexIndex != -1) {
-							PNTCVertex& v = b[j];
-							v.position = m_Vertices[current.vertexIndex - 1];
-							v.position.z *= -1.0f;
-							if (current.uvIndex != -1) {
-								v.texture = m_UVCache[current.uvIndex - 1];
-								v.texture.y = 1.0f - v.texture.y;
-							}
-							else {
-								v.texture = Vector2f(0, 0);
-							}
-							if (hasNormals) {
-								v.normal = m_Normals[current.normalIndex - 1];
-								v.normal.z *= -1.0f;
-							}
-							//if (m != 0) {
-							v.color = m_Faces[i * 4 + j].color;
-							//}		
-							//LOG << "vertex: " << DBG_V3(v.position) << " normal: " << DBG_V3(v.normal) << " color: " << DBG_CLR(v.color);
-						}
+						PNTCVertex& v = face[j];
+						v.position.z *= -1.0f;
+						v.normal.z *= -1.0f;
+						v.texture.y = 1.0f - v.texture.y;
+						dest[3 - j] = v;
 					}
-					mesh->vertices.push_back(b[3]);
-					mesh->vertices.push_back(b[2]);
-					mesh->vertices.push_back(b[1]);
-					mesh->vertices.push_back(b[0]);
+					dest += 4;
+				}
+			}
+		}
 
+		// ------------------------------------------------------
+		// load cache
+		// ------------------------------------------------------
+		static bool loadCache(const char* cacheName, const char* sourceName, uint64_t size, Mesh* mesh) {
+			FILE* fp = fopen(cacheName, "rb");
+			if (fp == 0) {
+				return false;
+			}
+			ObjCacheHeader header;
+			bool valid = fread(&header, sizeof(ObjCacheHeader), 1, fp) == 1 && header.magic == OBJ_CACHE_MAGIC && header.version == OBJ_CACHE_VERSION && header.sourceSize == size;
+			// the modification time only has a resolution of one second
+			// so an edit within the same second is only found by the hash
+			uint64_t hash = 0;
+			valid = valid && hashFile(sourceName, &hash) && hash == header.sourceHash;
+			if (valid && header.materialFile[0] != '\0') {
+				char mtlName[256];
+				sprintf_s(mtlName, 256, "content\\objects\\%s", header.materialFile);
+				valid = hashFile(mtlName, &hash) && hash == header.materialHash;
+			}
+			if (valid && header.numVertices > 0) {
+				uint32_t first = mesh->vertices.size();
+				PNTCVertex* v = mesh->append(header.numVertices);
+				valid = fread(v, sizeof(PNTCVertex), header.numVertices, fp) == header.numVertices;
+				if (!valid) {
+					mesh->vertices.resize(first);
 				}
-				LOG << "Vertices: " << mesh->vertices.size();
+			}
+			fclose(fp);
+			return valid;
+		}
+
+		// ------------------------------------------------------
+		// save cache
+		// ------------------------------------------------------
+		static void saveCache(const char* cacheName, ObjCacheHeader& header, const PNTCVertex* vertices) {
+			FILE* fp = fopen(cacheName, "wb");
+			if (fp == 0) {
+				LOGE << "Cannot write cache '" << cacheName << "'";
+				return;
+			}
+			fwrite(&header, sizeof(ObjCacheHeader), 1, fp);
+			if (header.numVertices > 0) {
+				fwrite(vertices, sizeof(PNTCVertex), header.numVertices, fp);
+			}
+			fclose(fp);
+		}
+
+		// ------------------------------------------------------
+		// parse - the file is split into chunks of whole lines
+		// which are parsed in parallel. Afterwards the indices
+		// of every chunk are resolved and the vertices are
+		// built in parallel as well.
+		// ------------------------------------------------------
+		bool parse(const char* fileName, Mesh* mesh, const v3& offset, const v3& scale, const v3& rotation) {
+			ZoneTracker z("obj::parse");
+			char fullName[256];
+			sprintf_s(fullName, 256, "content\\objects\\%s", fileName);
+			char cacheName[256];
+			sprintf_s(cacheName, 256, "content\\objects\\%s.cache", fileName);
+			uint64_t time = 0;
+			uint64_t size = 0;
+			if (!getFileInfo(fullName, &time, &size)) {
+				LOGE << "Cannot load '" << fileName << "'";
+				return false;
+			}
+			uint32_t start = mesh->vertices.size();
+			if (loadCache(cacheName, fullName, size, mesh)) {
+				LOG << "Loaded '" << fileName << "' from cache - vertices: " << mesh->vertices.size() - start;
 				return true;
 			}
-			else {
+			uint32_t sz = 0;
+			char* buffer = readFile(fullName, &sz);
+			if (buffer == 0) {
 				LOGE << "Cannot load '" << fileName << "'";
 				return false;
 			}
+			LOG << "Loading '" << fileName << "' size: " << sz;
+			// split at line ends
+			uint32_t numChunks = sz / OBJ_CHUNK_SIZE + 1;
+			ObjChunk* chunks = new ObjChunk[numChunks];
+			const char* current = buffer;
+			const char* end = buffer + sz;
+			for (uint32_t i = 0; i < numChunks; ++i) {
+				ObjChunk& chunk = chunks[i];
+				chunk.start = current;
+				chunk.end = i + 1 < numChunks ? nextLine(buffer + (uint64_t)sz * (i + 1) / numChunks) : end;
+				if (chunk.end < current) {
+					chunk.end = current;
+				}
+				current = chunk.end;
+				chunk.numQuads = 0;
+				chunk.materialFile[0] = '\0';
+				chunk.inherited = 0;
+				chunk.invalid = 0;
+			}
+			auto parseChunks = [&](uint32_t first, uint32_t last) {
+				for (uint32_t i = first; i < last; ++i) {
+					parseChunk(chunks[i]);
+				}
+			};
+			jobs::parallelFor(numChunks, 1, parseChunks);
+			// merge
+			ObjData data;
+			ObjCacheHeader header;
+			memset(&header, 0, sizeof(ObjCacheHeader));
+			uint32_t numVertices = 0;
+			const Material* material = 0;
+			Materials materials;
+			for (uint32_t i = 0; i < numChunks; ++i) {
+				ObjChunk& chunk = chunks[i];
+				if (chunk.materialFile[0] != '\0' && header.materialFile[0] == '\0') {
+					strcpy_s(header.materialFile, 128, chunk.materialFile);
+					char mtlName[256];
+					sprintf_s(mtlName, 256, "content\\objects\\%s", chunk.materialFile);
+					hashFile(mtlName, &header.materialHash);
+					readMaterials(mtlName, materials);
+				}
+				chunk.base[0] = data.positions.size();
+				chunk.base[1] = data.uvs.size();
+				chunk.base[2] = data.normals.size();
+				data.positions.insert(data.positions.end(), chunk.positions.begin(), chunk.positions.end());
+				data.uvs.insert(data.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+				data.normals.insert(data.normals.end(), chunk.normals.begin(), chunk.normals.end());
+				chunk.firstVertex = numVertices;
+				numVertices += chunk.numQuads * 4;
+				// usemtl is valid until the next one - even across chunks
+				chunk.inherited = material;
+				for (size_t j = 0; j < chunk.materials.size(); ++j) {
+					MaterialRun& run = chunk.materials[j];
+					Materials::const_iterator it = materials.find(run.hash);
+					run.material = it != materials.end() ? &it->second : 0;
+					material = run.material;
+				}
+			}
+			header.magic = OBJ_CACHE_MAGIC;
+			header.version = OBJ_CACHE_VERSION;
+			header.sourceTime = time;
+			header.sourceSize = size;
+			header.sourceHash = hashData(buffer, sz);
+			header.numVertices = numVertices;
+			delete[] buffer;
+			// the chunks write straight into the mesh
+			PNTCVertex* vertices = mesh->append(numVertices);
+			auto buildChunks = [&](uint32_t first, uint32_t last) {
+				for (uint32_t i = first; i < last; ++i) {
+					buildVertices(chunks[i], data, vertices);
+				}
+			};
+			jobs::parallelFor(numChunks, 1, buildChunks);
+			uint32_t invalid = 0;
+			for (uint32_t i = 0; i < numChunks; ++i) {
+				invalid += chunks[i].invalid;
+			}
+			if (invalid > 0) {
+				LOGE << "'" << fileName << "' has " << invalid << " invalid vertex indices";
+			}
+			LOG << "vertex cache  : " << data.positions.size();
+			LOG << "normals cache : " << data.normals.size();
+			LOG << "uv cache      : " << data.uvs.size();
+			saveCache(cacheName, header, vertices);
+			delete[] chunks;
+			LOG << "Vertices: " << mesh->vertices.size() - start;
+			return true;
 		}
 	}
-	
-}
\ No newline at end of file
+
+}
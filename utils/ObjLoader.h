@@ -5,7 +5,36 @@ namespace ds {
 
 	namespace obj {
 
+		// ------------------------------------------------------
+		// Binary cache written next to the source file
+		// (content\objects\<name>.cache)
+		//   ObjCacheHeader
+		//   PNTCVertex[numVertices]
+		// The cache is used if the size of the OBJ is unchanged
+		// and the hashes of the OBJ and its material file match.
+		// Modification times are not used since they only have
+		// a resolution of one second.
+		// ------------------------------------------------------
+		const uint32_t OBJ_CACHE_MAGIC = 0x434F5344; // DSOC
+		const uint32_t OBJ_CACHE_VERSION = 2;
+
+		struct ObjCacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceTime;
+			uint64_t sourceSize;
+			uint64_t sourceHash;
+			uint64_t materialHash;
+			uint32_t numVertices;
+			uint32_t reserved;
+			// empty if the OBJ has no mtllib
+			char materialFile[128];
+		};
+
+		// files larger than this are split and parsed in parallel
+		const uint32_t OBJ_CHUNK_SIZE = 1024 * 1024;
+
 		bool parse(const char* fileName, Mesh* mesh,const v3& offset = v3(0,0,0), const v3& scale = v3(1,1,1), const v3& rotation = v3(0,0,0));
 
 	}
-}
\ No newline at end of file
+}
@@ -5,27 +5,233 @@
 namespace ds {
 
 	namespace font {
-	
+
+		const int TEXT_CACHE_SIZE = 256;
+		const int TEXT_CACHE_BUCKETS = 512;
+		const int MAX_CACHED_TEXT = 128;
+
+		struct TextCacheEntry {
+			RID font;
+			uint32_t hash;
+			int padding;
+			float scaleX;
+			float scaleY;
+			int length;
+			char text[MAX_CACHED_TEXT];
+			TextRun run;
+			// LRU list
+			int prev;
+			int next;
+			// next entry in the same bucket
+			int chain;
+		};
+
 		// -------------------------------------------------------
-		// Calculate size of text
+		// LRU cache of text runs. Entries are found by a hashed
+		// bucket list and kept in a double linked list ordered by
+		// last access. Texts longer than MAX_CACHED_TEXT are not
+		// cached and use the shared uncached run.
 		// -------------------------------------------------------
-		v2 calculateSize(RID bitmapFont, const char* text, int padding, float scaleX, float scaleY) {
-			float cPadding = 0.0f;
-			v2 ret(0.0f, 0.0f);
-			int len = strlen(text);
+		struct TextCache {
+			TextCacheEntry entries[TEXT_CACHE_SIZE];
+			int buckets[TEXT_CACHE_BUCKETS];
+			int head;
+			int tail;
+			int num;
+			TextRun uncached;
+			TextCacheStats stats;
+
+			TextCache() : head(-1), tail(-1), num(0) {
+				for (int i = 0; i < TEXT_CACHE_BUCKETS; ++i) {
+					buckets[i] = -1;
+				}
+				stats.hits = 0;
+				stats.misses = 0;
+				stats.evictions = 0;
+				stats.entries = 0;
+			}
+		};
+
+		static TextCache* _textCache = 0;
+
+		// -------------------------------------------------------
+		// FNV-1a hash of the text combined with the parameters
+		// -------------------------------------------------------
+		static uint32_t hashText(RID bitmapFont, const char* text, int len, int padding, float scaleX, float scaleY) {
+			uint32_t h = 2166136261u;
+			for (int i = 0; i < len; ++i) {
+				h ^= (uint8_t)text[i];
+				h *= 16777619u;
+			}
+			uint32_t params[4];
+			params[0] = bitmapFont;
+			params[1] = padding;
+			memcpy(&params[2], &scaleX, sizeof(float));
+			memcpy(&params[3], &scaleY, sizeof(float));
+			for (int i = 0; i < 4; ++i) {
+				h ^= params[i];
+				h *= 16777619u;
+			}
+			return h;
+		}
+
+		// -------------------------------------------------------
+		// layout text - matches SpriteBuffer::drawText
+		// -------------------------------------------------------
+		static void buildTextRun(RID bitmapFont, const char* text, int len, int padding, float scaleX, float scaleY, TextRun& run) {
+			run.glyphs.clear();
+			run.size = v2(0.0f, 0.0f);
 			Bitmapfont* font = res::getFont(bitmapFont);
+			int x = 0;
 			for (int cnt = 0; cnt < len; ++cnt) {
-				char c = text[cnt];
-				const Texture& t = font->get(c);
-				cPadding = (t.rect.width() + padding)  * scaleX;
-				float dimX = t.rect.width() * scaleX;
-				ret.x += dimX + padding;
-				float h = t.rect.height() * scaleY;
-				if (h > ret.y) {
-					ret.y = h;
+				const Texture& t = font->get(text[cnt]);
+				float dimX = t.dim.x * scaleX;
+				float dimY = t.dim.y * scaleY;
+				Glyph g;
+				g.offset = v2(x + dimX * 0.5f, dimY * 0.5f);
+				g.texture = t;
+				run.glyphs.push_back(g);
+				x += dimX + padding;
+				run.size.x += dimX + padding;
+				if (dimY > run.size.y) {
+					run.size.y = dimY;
 				}
 			}
-			return ret;
+		}
+
+		static void unlinkEntry(TextCache* cache, int idx) {
+			TextCacheEntry& e = cache->entries[idx];
+			if (e.prev != -1) {
+				cache->entries[e.prev].next = e.next;
+			}
+			else {
+				cache->head = e.next;
+			}
+			if (e.next != -1) {
+				cache->entries[e.next].prev = e.prev;
+			}
+			else {
+				cache->tail = e.prev;
+			}
+			e.prev = -1;
+			e.next = -1;
+		}
+
+		static void pushFront(TextCache* cache, int idx) {
+			TextCacheEntry& e = cache->entries[idx];
+			e.prev = -1;
+			e.next = cache->head;
+			if (cache->head != -1) {
+				cache->entries[cache->head].prev = idx;
+			}
+			cache->head = idx;
+			if (cache->tail == -1) {
+				cache->tail = idx;
+			}
+		}
+
+		static void removeFromBucket(TextCache* cache, int idx) {
+			TextCacheEntry& e = cache->entries[idx];
+			int* current = &cache->buckets[e.hash & (TEXT_CACHE_BUCKETS - 1)];
+			while (*current != -1) {
+				if (*current == idx) {
+					*current = e.chain;
+					break;
+				}
+				current = &cache->entries[*current].chain;
+			}
+			e.chain = -1;
+		}
+
+		// -------------------------------------------------------
+		// get text run
+		// -------------------------------------------------------
+		const TextRun& getTextRun(RID bitmapFont, const char* text, int padding, float scaleX, float scaleY) {
+			if (_textCache == 0) {
+				_textCache = new TextCache;
+			}
+			TextCache* cache = _textCache;
+			int len = strlen(text);
+			if (len >= MAX_CACHED_TEXT) {
+				++cache->stats.misses;
+				buildTextRun(bitmapFont, text, len, padding, scaleX, scaleY, cache->uncached);
+				return cache->uncached;
+			}
+			uint32_t hash = hashText(bitmapFont, text, len, padding, scaleX, scaleY);
+			int bucket = hash & (TEXT_CACHE_BUCKETS - 1);
+			int idx = cache->buckets[bucket];
+			while (idx != -1) {
+				const TextCacheEntry& e = cache->entries[idx];
+				if (e.hash == hash && e.length == len && e.font == bitmapFont && e.padding == padding && e.scaleX == scaleX && e.scaleY == scaleY && strncmp(e.text, text, len) == 0) {
+					++cache->stats.hits;
+					if (cache->head != idx) {
+						unlinkEntry(cache, idx);
+						pushFront(cache, idx);
+					}
+					return e.run;
+				}
+				idx = e.chain;
+			}
+			++cache->stats.misses;
+			if (cache->num < TEXT_CACHE_SIZE) {
+				idx = cache->num++;
+			}
+			else {
+				// evict least recently used entry
+				idx = cache->tail;
+				unlinkEntry(cache, idx);
+				removeFromBucket(cache, idx);
+				++cache->stats.evictions;
+			}
+			TextCacheEntry& e = cache->entries[idx];
+			e.font = bitmapFont;
+			e.hash = hash;
+			e.padding = padding;
+			e.scaleX = scaleX;
+			e.scaleY = scaleY;
+			e.length = len;
+			memcpy(e.text, text, len + 1);
+			buildTextRun(bitmapFont, text, len, padding, scaleX, scaleY, e.run);
+			e.chain = cache->buckets[bucket];
+			cache->buckets[bucket] = idx;
+			pushFront(cache, idx);
+			cache->stats.entries = cache->num;
+			return e.run;
+		}
+
+		// -------------------------------------------------------
+		// clear text cache - called by FontParser::loadFont and
+		// res::shutdown since fonts are identified by their RID
+		// -------------------------------------------------------
+		void clearTextCache() {
+			if (_textCache != 0) {
+				TextCacheStats stats = _textCache->stats;
+				delete _textCache;
+				_textCache = new TextCache;
+				_textCache->stats = stats;
+				_textCache->stats.entries = 0;
+			}
+		}
+
+		const TextCacheStats& getTextCacheStats() {
+			if (_textCache == 0) {
+				_textCache = new TextCache;
+			}
+			return _textCache->stats;
+		}
+
+		void shutdownTextCache() {
+			if (_textCache != 0) {
+				delete _textCache;
+				_textCache = 0;
+			}
+		}
+	
+		// -------------------------------------------------------
+		// Calculate size of text
+		// -------------------------------------------------------
+		v2 calculateSize(RID bitmapFont, const char* text, int padding, float scaleX, float scaleY) {
+			return getTextRun(bitmapFont, text, padding, scaleX, scaleY).size;
 		}
 
 		// -------------------------------------------------------
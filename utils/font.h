@@ -8,6 +8,42 @@ namespace ds {
 
 	namespace font {
 
+		// -------------------------------------------------------
+		// single character of a text run - the offset is relative
+		// to the start position and points to the glyph center
+		// -------------------------------------------------------
+		struct Glyph {
+			v2 offset;
+			Texture texture;
+		};
+
+		// -------------------------------------------------------
+		// measured and laid out text
+		// -------------------------------------------------------
+		struct TextRun {
+			v2 size;
+			Array<Glyph> glyphs;
+		};
+
+		struct TextCacheStats {
+			uint32_t hits;
+			uint32_t misses;
+			uint32_t evictions;
+			uint32_t entries;
+		};
+
+		// -------------------------------------------------------
+		// returns the cached text run or builds it. The returned
+		// reference stays valid until the next call.
+		// -------------------------------------------------------
+		const TextRun& getTextRun(RID bitmapFont, const char* text, int padding = 4, float scaleX = 1.0f, float scaleY = 1.0f);
+
+		void clearTextCache();
+
+		const TextCacheStats& getTextCacheStats();
+
+		void shutdownTextCache();
+
 		v2 calculateSize(RID bitmapFont, const char* text, int padding = 4, float scaleX = 1.0f, float scaleY = 1.0f);
 
 		v2 calculateLimitedSize(RID bitmapFont, const char* text, int chars, int padding = 4, float scaleX = 1.0f, float scaleY = 1.0f);